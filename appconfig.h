@@ -28,7 +28,10 @@ private:
     // Constructor and Destructor
     AppConfig() : sourceDirectory(""), outputDirectory(""), invalidFileMetaDirectory(""),
         duplicatesDirectory(""), duplicatesFoundSelection(""), photosOutputFolderStructureSelection(""),
-        moveInvalidFileMeta(false), includeSubDirectories(false) {
+        moveInvalidFileMeta(false), includeSubDirectories(false), photosReplaceDashesWithUnderscores(false),
+        scanWorkerThreadCount(0),
+        transfersPerDevice(2), verifyMovedFiles(true), verifyCopiedFiles(false),
+        writeChecksumManifests(false) {
         duplicatesFoundOptions = {
             "Add 'Copy##' and Move/Copy",
             "Do Not Move or Copy",
@@ -60,9 +63,17 @@ private:
 
     //Options - Photo Specific
     std::string photosOutputFolderStructureSelection;
+    std::string photosFileNameTemplate; // Empty = keep the file names
     std::string photosDuplicateIdentitiySetting;
     bool photosReplaceDashesWithUnderscores;
 
+    //Options - Performance
+    int scanWorkerThreadCount; // 0 = one worker per available core
+    int transfersPerDevice; // Copies in flight per source/target device pair
+    bool verifyMovedFiles; // Compare files moved between devices before removing the source
+    bool verifyCopiedFiles; // Compare copies with their source too
+    bool writeChecksumManifests; // Keep a checksums.xxh64 in each target directory
+
     // Vector to store options for handling duplicates
     std::vector<std::string> duplicatesFoundOptions;
     // Vector to store options for handling media folder stucture config
@@ -109,6 +120,9 @@ public:
     std::string getPhotosOutputFolderStructureSelection() const { return photosOutputFolderStructureSelection; }
     void setPhotosOutputFolderStructureSelection(std::string &value) { photosOutputFolderStructureSelection = value; }
 
+    std::string getPhotosFileNameTemplate() const { return photosFileNameTemplate; }
+    void setPhotosFileNameTemplate(const std::string &value) { photosFileNameTemplate = value; }
+
     std::string getPhotosDuplicateIdentitySetting() const { return photosDuplicateIdentitiySetting; }
     void setPhotosDuplicateIdentitySetting(std::string &value) { photosDuplicateIdentitiySetting = value; }
 
@@ -121,6 +135,19 @@ public:
     bool getPhotosReplaceDashesWithUnderscores() const { return photosReplaceDashesWithUnderscores; }
     void setPhotosReplaceDashesWithUnderscores(bool value) { photosReplaceDashesWithUnderscores = value; }
 
+    int getScanWorkerThreadCount() const { return scanWorkerThreadCount; }
+    void setScanWorkerThreadCount(int value) { scanWorkerThreadCount = value; }
+
+    int getTransfersPerDevice() const { return transfersPerDevice; }
+    void setTransfersPerDevice(int value) { transfersPerDevice = value; }
+
+    bool getVerifyMovedFiles() const { return verifyMovedFiles; }
+    void setVerifyMovedFiles(bool value) { verifyMovedFiles = value; }
+    bool getVerifyCopiedFiles() const { return verifyCopiedFiles; }
+    void setVerifyCopiedFiles(bool value) { verifyCopiedFiles = value; }
+    bool getWriteChecksumManifests() const { return writeChecksumManifests; }
+    void setWriteChecksumManifests(bool value) { writeChecksumManifests = value; }
+
     const std::vector<std::string>& getDuplicatesFoundOptions() const { return duplicatesFoundOptions; }
     const std::vector<std::string>& getMediaOutputFolderStructureOptions() const { return mediaOutputFolderStructureOptions; }
 };
@@ -18,8 +18,8 @@
 #include <string>
 #include <cstddef>
 #include <QDir>
-#include <QMessageBox>
 #include "appconfigmanager.h"
+#include "errorreporter.h"
 
 // Windows-specific includes should come after C++ standard library includes
 #ifdef _WIN32
@@ -58,10 +58,7 @@ bool AppConfigManager::checkDirectoryExists(bool showMessage,
         if(showMessage){
             std::string errorMessage = "Directory does not exist. Please correct this.";
             if (directoryType != "") errorMessage = directoryType + " Directory does not exist. Please correct this.";
-            QMessageBox::critical(nullptr,
-                                  "Error",
-                                  QString::fromStdString(errorMessage),
-                                  QMessageBox::Ok);
+            ErrorReporter::showError(errorMessage);
         }
         return false;
     }
@@ -89,6 +86,14 @@ std::string AppConfigManager::getDefaultConfigPath() {
     return getExecutablePath() + "/config.dat"; // default config file name
 }
 
+std::string AppConfigManager::getDefaultScanCachePath() {
+    return getExecutablePath() + "/scancache.dat"; // kept next to config.dat
+}
+
+std::string AppConfigManager::getDefaultTransferJournalPath() {
+    return getExecutablePath() + "/transfer.journal"; // kept next to config.dat
+}
+
 // Saves the current configuration to the specified file path
 void AppConfigManager::save(const std::string& filePath) {
     std::ofstream outFile(filePath);
@@ -104,6 +109,12 @@ void AppConfigManager::save(const std::string& filePath) {
         outFile << config.getMoveInvalidFileMeta() << std::endl;
         outFile << config.getIncludeSubDirectories() << std::endl;
         outFile << config.getPhotosReplaceDashesWithUnderscores() << std::endl;
+        outFile << config.getScanWorkerThreadCount() << std::endl;
+        outFile << config.getTransfersPerDevice() << std::endl;
+        outFile << config.getPhotosFileNameTemplate() << std::endl;
+        outFile << config.getVerifyMovedFiles() << std::endl;
+        outFile << config.getVerifyCopiedFiles() << std::endl;
+        outFile << config.getWriteChecksumManifests() << std::endl;
         outFile.close();
         std::clog << "Configuration saved to: " << filePath << std::endl;
     } else {
@@ -119,6 +130,8 @@ bool AppConfigManager::load(const std::string& filePath) {
         std::string sourceDir, outputDir, invalidMetaDir, duplicatesDir,
             duplicatesSelection, folderStructureSelection, photoDuplicateIdentitySetting;
         bool moveInvalidMeta, includeSubDirs, photosReplaceDashesWithUnderscores;
+        int scanWorkerThreadCount = 0;
+        int transfersPerDevice = 2;
 
         getline(inFile, sourceDir);
         getline(inFile, outputDir);
@@ -130,6 +143,17 @@ bool AppConfigManager::load(const std::string& filePath) {
         inFile >> moveInvalidMeta;
         inFile >> includeSubDirs;
         inFile >> photosReplaceDashesWithUnderscores;
+        // Settings added later are missing from older config files
+        if (!(inFile >> scanWorkerThreadCount)) scanWorkerThreadCount = 0;
+        if (!(inFile >> transfersPerDevice)) transfersPerDevice = 2;
+        std::string fileNameTemplate;
+        inFile.ignore(std::numeric_limits<std::streamsize>::max(), '\n');
+        getline(inFile, fileNameTemplate);
+        bool verifyMovedFiles = true;
+        if (!(inFile >> verifyMovedFiles)) verifyMovedFiles = true;
+        bool verifyCopiedFiles = false, writeChecksumManifests = false;
+        if (!(inFile >> verifyCopiedFiles)) verifyCopiedFiles = false;
+        if (!(inFile >> writeChecksumManifests)) writeChecksumManifests = false;
 
         config.setSourceDirectory(sourceDir);
         config.setOutputDirectory(outputDir);
@@ -141,6 +165,12 @@ bool AppConfigManager::load(const std::string& filePath) {
         config.setPhotosOutputFolderStructureSelection(folderStructureSelection);
         config.setPhotosDuplicateIdentitySetting(photoDuplicateIdentitySetting);
         config.setPhotosReplaceDashesWithUnderscores(photosReplaceDashesWithUnderscores);
+        config.setScanWorkerThreadCount(scanWorkerThreadCount);
+        config.setTransfersPerDevice(transfersPerDevice);
+        config.setPhotosFileNameTemplate(fileNameTemplate);
+        config.setVerifyMovedFiles(verifyMovedFiles);
+        config.setVerifyCopiedFiles(verifyCopiedFiles);
+        config.setWriteChecksumManifests(writeChecksumManifests);
 
         std::clog << "Configuration loaded from to: " << filePath << std::endl;
 
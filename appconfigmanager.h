@@ -28,6 +28,8 @@ public:
     bool checkDirectoryExists(bool showMessage, std::string directoryPath, std::string directoryType = "");
     static std::string getExecutablePath();
     static std::string getDefaultConfigPath();
+    static std::string getDefaultScanCachePath();
+    static std::string getDefaultTransferJournalPath();
     void save(const std::string& filePath = getDefaultConfigPath());
     bool load(const std::string& filePath = getDefaultConfigPath());
 };
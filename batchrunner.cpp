@@ -0,0 +1,391 @@
+/***********************************************************************
+ * File Name: batchrunner.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the BatchRunner class. The scan and
+ *              transfer code logs every file to std::cout, so in batch mode
+ *              std::cout is redirected to stderr and stdout only carries the
+ *              JSON events, e.g.
+ *                {"event":"scan","filesFound":120,"photoFiles":110,
+ *                 "videoFiles":8}
+ *                {"event":"transfer","percent":42,"bytesCompleted":...}
+ *                {"event":"finished","exitCode":0,"filesFailed":0}
+ *              With --pipeline the transfer starts with the scan, photos
+ *              being handed over through a bounded queue as they are found.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <QCommandLineOption>
+#include <QCommandLineParser>
+#include <QString>
+#include <algorithm>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include "batchrunner.h"
+#include "errorreporter.h"
+#include "pathtemplate.h"
+#include "tracer.h"
+#include "transferjournal.h"
+
+namespace {
+
+const char* BatchFlag = "--batch";
+// Photos scanned ahead of the transfer; the Scanner waits when it is full
+const size_t PipelineQueueCapacity = 256;
+
+// Checks 'value' against the options offered in the GUI
+bool isValidOption(const std::string& value, const std::vector<std::string>& options) {
+    return std::find(options.begin(), options.end(), value) != options.end();
+}
+
+std::string joinOptions(const std::vector<std::string>& options) {
+    std::string joined;
+    for (const auto& option : options) {
+        if (!joined.empty()) joined += ", ";
+        joined += "'" + option + "'";
+    }
+    return joined;
+}
+
+}
+
+BatchRunner::BatchRunner(Scanner* scanner, TransferManager* transferManager, QObject* parent)
+    : QObject(parent),
+    scanner(scanner),
+    transferManager(transferManager),
+    appConfigManager(AppConfig::get()),
+    progressTimer(new QTimer(this)),
+    eventOut(std::cout.rdbuf()),
+    coutBuffer(std::cout.rdbuf(std::cerr.rdbuf())),
+    pipelineQueue(PipelineQueueCapacity)
+{
+    qRegisterMetaType<std::string>("std::string");
+    qRegisterMetaType<PhotoFileHandlerVector*>("PhotoFileHandlerVector*");
+    qRegisterMetaType<PhotoPipelineQueue*>("PhotoPipelineQueue*");
+    connect(progressTimer, &QTimer::timeout, this, &BatchRunner::printProgress);
+    connect(this, &BatchRunner::startScan, scanner, &Scanner::scan);
+    connect(scanner, &Scanner::scanCompleted, this, &BatchRunner::onScanCompleted, Qt::QueuedConnection);
+    connect(this, &BatchRunner::startTransfer, transferManager, &TransferManager::processPhotoFiles);
+    connect(this, &BatchRunner::startPipelinedTransfer, transferManager, &TransferManager::processPipelinedPhotoFiles);
+    connect(this, &BatchRunner::startResume, transferManager, &TransferManager::resumeInterruptedTransfer);
+    connect(transferManager, &TransferManager::transferComplete, this, &BatchRunner::onTransferComplete, Qt::QueuedConnection);
+}
+
+BatchRunner::~BatchRunner() {
+    eventOut.flush();
+    std::cout.rdbuf(coutBuffer);
+}
+
+bool BatchRunner::isBatchMode(int argc, char* argv[]) {
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], BatchFlag) == 0) return true;
+    }
+    return false;
+}
+
+bool BatchRunner::configure(const QCoreApplication& application) {
+    AppConfig& config = appConfigManager.config;
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Sorts photos into folders by their EXIF metadata.");
+    parser.addHelpOption();
+    QCommandLineOption batchOption("batch", "Run without the GUI, printing JSON progress events to stdout.");
+    QCommandLineOption configOption("config", "Start from the settings in <file> instead of the defaults.", "file");
+    QCommandLineOption sourceOption("source", "Directory to scan.", "directory");
+    QCommandLineOption outputOption("output", "Directory to transfer the photos to.", "directory");
+    QCommandLineOption includeSubdirectoriesOption("include-subdirs", "Also scan the subdirectories of the source.");
+    QCommandLineOption moveOption("move", "Move the files instead of copying them.");
+    QCommandLineOption noVerifyMovesOption("no-verify-moves",
+        "Do not compare files moved between devices with their source before removing it.");
+    QCommandLineOption verifyCopiesOption("verify-copies",
+        "Compare every copy with its source, reading the copy back from the target device.");
+    QCommandLineOption checksumManifestOption("checksum-manifest",
+        "Keep the hash of every file copied in a checksums.xxh64 file in its target directory.");
+    QCommandLineOption folderStructureOption("folder-structure",
+        QString::fromStdString("Output folder structure, one of " +
+                               joinOptions(config.getMediaOutputFolderStructureOptions()) +
+                               ", or a pattern such as '{Year}/{Month:2}' using " + PathTemplate::tokenList() + "."),
+        "structure");
+    QCommandLineOption fileNameTemplateOption("file-name-template",
+        "Rename the photos by <pattern> (same tokens as --folder-structure, extension kept).", "pattern");
+    QCommandLineOption duplicateIdentityOption("duplicate-identity",
+        "How duplicates are identified: 'filename' or 'exif' (all EXIF and exact file contents).", "mode");
+    QCommandLineOption duplicatesOption("duplicates",
+        QString::fromStdString("What to do with duplicates, one of " +
+                               joinOptions(config.getDuplicatesFoundOptions()) + "."), "action");
+    QCommandLineOption duplicatesDirectoryOption("duplicates-dir", "Directory for 'Move To Folder' duplicates.", "directory");
+    QCommandLineOption invalidMetaDirectoryOption("invalid-meta-dir",
+        "Transfer photos without usable EXIF data to <directory>.", "directory");
+    QCommandLineOption replaceDashesOption("replace-dashes", "Replace dashes in file names with underscores.");
+    QCommandLineOption scanThreadsOption("scan-threads", "Scan worker threads (0 = one per core).", "count");
+    QCommandLineOption transfersPerDeviceOption("transfers-per-device", "Transfers in flight per device pair.", "count");
+    QCommandLineOption pipelineOption("pipeline",
+        "Start transferring photos while the scan is still running. Of two duplicates, the first found is kept.");
+    QCommandLineOption resumeOption("resume",
+        "Finish the transfer interrupted last time (from its journal), without scanning. Other settings are ignored.");
+    QCommandLineOption progressIntervalOption("progress-interval", "Milliseconds between progress events (default 1000).", "ms");
+    QCommandLineOption traceOption("trace",
+        "Write a Chrome trace (chrome://tracing, ui.perfetto.dev) of the scan and transfer stages to <file>.", "file");
+    for (const auto& option : {batchOption, configOption, sourceOption, outputOption, includeSubdirectoriesOption,
+                               moveOption, noVerifyMovesOption, verifyCopiesOption, checksumManifestOption,
+                               folderStructureOption, fileNameTemplateOption,
+                               duplicateIdentityOption, duplicatesOption,
+                               duplicatesDirectoryOption, invalidMetaDirectoryOption, replaceDashesOption,
+                               scanThreadsOption, transfersPerDeviceOption, pipelineOption, resumeOption,
+                               progressIntervalOption, traceOption}) {
+        parser.addOption(option);
+    }
+    // Exits the process for --help and unknown options
+    parser.process(application);
+
+    // Batch runs start from fixed defaults rather than whatever the GUI
+    // saved last, unless a config file is given
+    if (parser.isSet(configOption)) {
+        std::string configPath = parser.value(configOption).toStdString();
+        if (!appConfigManager.load(configPath)) {
+            ErrorReporter::showError("Unable to load config file: " + configPath);
+            return false;
+        }
+    }
+    if (config.getDuplicatesFoundSelection().empty()) {
+        std::string defaultSelection = config.getDuplicatesFoundOptions().front();
+        config.setDuplicatesFoundSelection(defaultSelection);
+    }
+    if (config.getPhotosOutputFolderStructureSelection().empty()) {
+        std::string defaultStructure = "Year, Month";
+        config.setPhotosOutputFolderStructureSelection(defaultStructure);
+    }
+    if (config.getPhotosDuplicateIdentitySetting().empty()) {
+        std::string defaultIdentity = "File Names Match";
+        config.setPhotosDuplicateIdentitySetting(defaultIdentity);
+    }
+
+    if (parser.isSet(sourceOption)) config.setSourceDirectory(parser.value(sourceOption).toStdString());
+    if (parser.isSet(outputOption)) config.setOutputDirectory(parser.value(outputOption).toStdString());
+    if (parser.isSet(includeSubdirectoriesOption)) config.setIncludeSubDirectories(true);
+    if (parser.isSet(replaceDashesOption)) config.setPhotosReplaceDashesWithUnderscores(true);
+    if (parser.isSet(noVerifyMovesOption)) config.setVerifyMovedFiles(false);
+    if (parser.isSet(verifyCopiesOption)) config.setVerifyCopiedFiles(true);
+    if (parser.isSet(checksumManifestOption)) config.setWriteChecksumManifests(true);
+    if (parser.isSet(duplicatesDirectoryOption)) {
+        config.setDuplicatesDirectory(parser.value(duplicatesDirectoryOption).toStdString());
+    }
+    if (parser.isSet(invalidMetaDirectoryOption)) {
+        config.setMoveInvalidFileMeta(true);
+        config.setInvalidFileMetaDirectory(parser.value(invalidMetaDirectoryOption).toStdString());
+    }
+    if (parser.isSet(folderStructureOption)) {
+        std::string structure = parser.value(folderStructureOption).toStdString();
+        PathTemplate folderTemplate;
+        std::string error;
+        if (structure.find('{') != std::string::npos) {
+            if (!folderTemplate.compile(structure, PathTemplate::Kind::Folder, error)) {
+                ErrorReporter::showError("Invalid folder structure: " + error);
+                return false;
+            }
+        } else if (!isValidOption(structure, config.getMediaOutputFolderStructureOptions())) {
+            ErrorReporter::showError("Unknown folder structure: " + structure);
+            return false;
+        }
+        config.setPhotosOutputFolderStructureSelection(structure);
+    }
+    if (parser.isSet(fileNameTemplateOption)) {
+        std::string pattern = parser.value(fileNameTemplateOption).toStdString();
+        PathTemplate fileNameTemplate;
+        std::string error;
+        if (!fileNameTemplate.compile(pattern, PathTemplate::Kind::FileName, error)) {
+            ErrorReporter::showError("Invalid file name template: " + error);
+            return false;
+        }
+        config.setPhotosFileNameTemplate(pattern);
+    }
+    if (parser.isSet(duplicatesOption)) {
+        std::string selection = parser.value(duplicatesOption).toStdString();
+        if (!isValidOption(selection, config.getDuplicatesFoundOptions())) {
+            ErrorReporter::showError("Unknown duplicates action: " + selection);
+            return false;
+        }
+        config.setDuplicatesFoundSelection(selection);
+    }
+    if (parser.isSet(duplicateIdentityOption)) {
+        std::string mode = parser.value(duplicateIdentityOption).toStdString();
+        std::string identity;
+        if (mode == "filename") {
+            identity = "File Names Match";
+        } else if (mode == "exif") {
+            identity = "All EXIF and Exact File Contents Match";
+        } else {
+            ErrorReporter::showError("Unknown duplicate identity: " + mode);
+            return false;
+        }
+        config.setPhotosDuplicateIdentitySetting(identity);
+    }
+
+    bool ok = true;
+    if (parser.isSet(scanThreadsOption)) {
+        int count = parser.value(scanThreadsOption).toInt(&ok);
+        if (!ok || count < 0) {
+            ErrorReporter::showError("Invalid --scan-threads value.");
+            return false;
+        }
+        config.setScanWorkerThreadCount(count);
+    }
+    if (parser.isSet(transfersPerDeviceOption)) {
+        int count = parser.value(transfersPerDeviceOption).toInt(&ok);
+        if (!ok || count <= 0) {
+            ErrorReporter::showError("Invalid --transfers-per-device value.");
+            return false;
+        }
+        config.setTransfersPerDevice(count);
+    }
+    int progressInterval = 1000;
+    if (parser.isSet(progressIntervalOption)) {
+        progressInterval = parser.value(progressIntervalOption).toInt(&ok);
+        if (!ok || progressInterval <= 0) {
+            ErrorReporter::showError("Invalid --progress-interval value.");
+            return false;
+        }
+    }
+    progressTimer->setInterval(progressInterval);
+    moveFiles = parser.isSet(moveOption);
+    pipelined = parser.isSet(pipelineOption);
+    resume = parser.isSet(resumeOption);
+    if (parser.isSet(traceOption)) {
+        Tracer::start(parser.value(traceOption).toStdString());
+    }
+    return true;
+}
+
+void BatchRunner::start() {
+    AppConfig& config = appConfigManager.config;
+    if (resume) {
+        if (!TransferJournal::exists(AppConfigManager::getDefaultTransferJournalPath())) {
+            ErrorReporter::showError("No interrupted transfer to resume.");
+            finish(ExitNoFilesFound);
+            return;
+        }
+        printEvent("started", "\"resume\":true");
+        progressTimer->start();
+        transferStarted = true;
+        emit startResume();
+        return;
+    }
+    if (config.getOutputDirectory().empty()) {
+        ErrorReporter::showError("No output directory given (--output).");
+        finish(ExitInvalidConfiguration);
+        return;
+    }
+    if (!appConfigManager.scanConfigurationValid(true) || !appConfigManager.copyConfigurationValid(true)) {
+        finish(ExitInvalidConfiguration);
+        return;
+    }
+    printEvent("started", "\"source\":" + jsonString(config.getSourceDirectory()) +
+                          ",\"output\":" + jsonString(config.getOutputDirectory()) +
+                          ",\"move\":" + (moveFiles ? "true" : "false"));
+    progressTimer->start();
+    if (pipelined) {
+        // The transfer waits on the queue until the Scanner fills or closes it
+        pipelineQueue.reset();
+        scanner->setPipelineQueue(&pipelineQueue);
+        transferStarted = true;
+        emit startPipelinedTransfer(&pipelineQueue, moveFiles);
+    }
+    emit startScan(config.getSourceDirectory(), config.getIncludeSubDirectories());
+}
+
+void BatchRunner::onScanCompleted() {
+    printScanEvent();
+    if (pipelined) {
+        return; // The transfer finishes once it has drained the queue
+    }
+    if (!scanner->checkScanResults(true)) {
+        finish(ExitNoFilesFound);
+        return;
+    }
+    transferStarted = true;
+    emit startTransfer(&scanner->getPhotoFileHandlers(), &scanner->getInvalidPhotoFileHandlers(), moveFiles);
+}
+
+void BatchRunner::onTransferComplete() {
+    if (pipelined) {
+        scanner->setPipelineQueue(nullptr);
+        if (scanner->getTotalFilesFound() == 0) {
+            finish(ExitNoFilesFound);
+            return;
+        }
+    }
+    TransferMetricsSnapshot metrics = transferManager->getTransferMetrics();
+    finish(metrics.filesFailed > 0 ? ExitTransferErrors : ExitSuccess);
+}
+
+void BatchRunner::printScanEvent() {
+    std::ostringstream fields;
+    fields << "\"filesFound\":" << scanner->getTotalFilesFound()
+           << ",\"photoFiles\":" << scanner->getTotalPhotoFilesFound()
+           << ",\"videoFiles\":" << scanner->getVideoFilesFound()
+           << ",\"photosWithEXIFData\":" << scanner->getPhotoFilesFoundContainingEXIFData()
+           << ",\"photosWithDate\":" << scanner->getPhotoFilesFoundContainingValidCreationDate();
+    printEvent("scan", fields.str());
+}
+
+void BatchRunner::printProgress() {
+    if (!transferStarted) {
+        printScanEvent();
+        return;
+    }
+    std::ostringstream fields;
+    TransferMetricsSnapshot metrics = transferManager->getTransferMetrics();
+    fields << std::fixed << std::setprecision(1)
+           << "\"percent\":" << transferManager->getTransferProgress()
+           << ",\"bytesCompleted\":" << metrics.bytesCompleted
+           << ",\"totalBytes\":" << metrics.totalBytes
+           << ",\"filesCompleted\":" << metrics.filesCompleted
+           << ",\"totalFiles\":" << metrics.totalFiles
+           << ",\"filesFailed\":" << metrics.filesFailed
+           << ",\"bytesPerSecond\":" << metrics.bytesPerSecond
+           << ",\"etaSeconds\":" << metrics.etaSeconds;
+    printEvent("transfer", fields.str());
+}
+
+void BatchRunner::finish(ExitCode exitCode) {
+    progressTimer->stop();
+    std::ostringstream fields;
+    fields << "\"exitCode\":" << exitCode;
+    if (transferStarted) {
+        TransferMetricsSnapshot metrics = transferManager->getTransferMetrics();
+        fields << ",\"filesTransferred\":" << (metrics.filesCompleted - metrics.filesFailed)
+               << ",\"filesFailed\":" << metrics.filesFailed
+               << ",\"bytesCompleted\":" << metrics.bytesCompleted;
+    }
+    printEvent("finished", fields.str());
+    QCoreApplication::exit(exitCode);
+}
+
+void BatchRunner::printEvent(const std::string& event, const std::string& fields) {
+    eventOut << "{\"event\":" << jsonString(event);
+    if (!fields.empty()) eventOut << "," << fields;
+    eventOut << "}" << std::endl;
+}
+
+std::string BatchRunner::jsonString(const std::string& value) {
+    std::ostringstream escaped;
+    escaped << '"';
+    for (unsigned char c : value) {
+        switch (c) {
+        case '"': escaped << "\\\""; break;
+        case '\\': escaped << "\\\\"; break;
+        case '\n': escaped << "\\n"; break;
+        case '\r': escaped << "\\r"; break;
+        case '\t': escaped << "\\t"; break;
+        default:
+            if (c < 0x20) {
+                escaped << "\\u" << std::hex << std::setw(4) << std::setfill('0') << static_cast<int>(c) << std::dec;
+            } else {
+                escaped << c;
+            }
+        }
+    }
+    escaped << '"';
+    return escaped.str();
+}
@@ -0,0 +1,86 @@
+#ifndef BATCHRUNNER_H
+#define BATCHRUNNER_H
+
+/***********************************************************************
+ * File Name: batchrunner.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the BatchRunner class, which runs a scan and
+ *              transfer without the GUI (MetaMover --batch). Settings are
+ *              taken from command line flags (optionally on top of a config
+ *              file), the Scanner and TransferManager are driven through the
+ *              same signals the main window uses, progress is printed to
+ *              stdout as one JSON object per line and the process exit code
+ *              reports the outcome, so MetaMover can run from cron or an
+ *              ingest script on a machine without a display.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <QCoreApplication>
+#include <QObject>
+#include <QTimer>
+#include <ostream>
+#include <string>
+#include "scanner.h"
+#include "transfermanager.h"
+
+class BatchRunner : public QObject
+{
+    Q_OBJECT
+
+public:
+    enum ExitCode {
+        ExitSuccess = 0,
+        ExitInvalidArguments = 1,
+        ExitInvalidConfiguration = 2,
+        ExitNoFilesFound = 3,
+        ExitTransferErrors = 4   // Some files could not be transferred
+    };
+
+    BatchRunner(Scanner* scanner, TransferManager* transferManager, QObject* parent = nullptr);
+    ~BatchRunner();
+
+    // True if the command line asks for batch mode (checked before any
+    // QCoreApplication exists)
+    static bool isBatchMode(int argc, char* argv[]);
+    // Parses the command line into AppConfig. Prints the problem and returns
+    // false if the arguments are invalid.
+    bool configure(const QCoreApplication& application);
+
+public slots:
+    // Starts the scan; the application exits with an ExitCode when done
+    void start();
+
+signals:
+    void startScan(const std::string& directoryPath, bool includeSubdirectories);
+    void startTransfer(PhotoFileHandlerVector* photoFileHandlers,
+                       PhotoFileHandlerVector* invalidPhotoFileHandlers,
+                       bool moveFiles);
+    void startPipelinedTransfer(PhotoPipelineQueue* pipelineQueue, bool moveFiles);
+    void startResume();
+
+private slots:
+    void onScanCompleted();
+    void onTransferComplete();
+    void printProgress();
+
+private:
+    void printScanEvent();
+    void finish(ExitCode exitCode);
+    void printEvent(const std::string& event, const std::string& fields);
+    static std::string jsonString(const std::string& value);
+
+    Scanner* scanner;
+    TransferManager* transferManager;
+    AppConfigManager appConfigManager;
+    QTimer* progressTimer;
+    std::ostream eventOut;       // The real stdout, reserved for JSON events
+    std::streambuf* coutBuffer;  // Restored on destruction
+    PhotoPipelineQueue pipelineQueue;  // Scanned photos waiting to be transferred (--pipeline)
+    bool moveFiles = false;
+    bool pipelined = false;
+    bool resume = false;
+    bool transferStarted = false;
+};
+
+#endif // BATCHRUNNER_H
@@ -0,0 +1,115 @@
+/***********************************************************************
+ * File Name: benchmarkharness.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the BenchmarkHarness class and of the
+ *              counting global operator new and delete it relies on.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include "benchmarkharness.h"
+
+namespace {
+
+std::atomic<uint64_t> allocationCount{0};
+std::atomic<uint64_t> allocatedBytes{0};
+
+void* countedAllocation(std::size_t size) {
+    allocationCount.fetch_add(1, std::memory_order_relaxed);
+    allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+    void* memory = std::malloc(size ? size : 1);
+    if (!memory) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+}
+
+// The aligned and nothrow forms are left to the library, which implements
+// the nothrow ones on top of these
+void* operator new(std::size_t size) { return countedAllocation(size); }
+void* operator new[](std::size_t size) { return countedAllocation(size); }
+void operator delete(void* memory) noexcept { std::free(memory); }
+void operator delete[](void* memory) noexcept { std::free(memory); }
+void operator delete(void* memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void* memory, std::size_t) noexcept { std::free(memory); }
+
+AllocationCounts getAllocationCounts() {
+    AllocationCounts counts;
+    counts.allocations = allocationCount.load(std::memory_order_relaxed);
+    counts.bytes = allocatedBytes.load(std::memory_order_relaxed);
+    return counts;
+}
+
+void BenchmarkHarness::setFilter(const std::string& nameFilter) {
+    filter = nameFilter;
+}
+
+void BenchmarkHarness::setMinimumTime(std::chrono::milliseconds time) {
+    minimumTime = time;
+}
+
+bool BenchmarkHarness::isSelected(const std::string& name) const {
+    return filter.empty() || name.find(filter) != std::string::npos;
+}
+
+void BenchmarkHarness::printHeader() const {
+    std::printf("%-48s %14s %12s %12s %12s\n", "benchmark", "ns/op", "allocs/op", "bytes/op", "ops");
+}
+
+void BenchmarkHarness::record(const std::string& name, uint64_t operations, std::chrono::nanoseconds elapsed,
+                              const AllocationCounts& counts) {
+    Result result;
+    result.name = name;
+    result.operations = operations;
+    double divisor = operations > 0 ? static_cast<double>(operations) : 1.0;
+    result.nanosecondsPerOperation = static_cast<double>(elapsed.count()) / divisor;
+    result.allocationsPerOperation = static_cast<double>(counts.allocations) / divisor;
+    result.bytesPerOperation = static_cast<double>(counts.bytes) / divisor;
+    results.push_back(result);
+    std::printf("%-48s %14.1f %12.2f %12.1f %12llu\n", name.c_str(), result.nanosecondsPerOperation,
+                result.allocationsPerOperation, result.bytesPerOperation,
+                static_cast<unsigned long long>(operations));
+    std::fflush(stdout);
+}
+
+const std::vector<BenchmarkHarness::Result>& BenchmarkHarness::getResults() const {
+    return results;
+}
+
+bool BenchmarkHarness::writeJson(const std::string& filePath) const {
+    std::ofstream out(filePath, std::ios::trunc);
+    out << "[\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const Result& result = results[i];
+        out << "  {\"name\":" << jsonString(result.name)
+            << ",\"operations\":" << result.operations
+            << ",\"nsPerOp\":" << result.nanosecondsPerOperation
+            << ",\"allocationsPerOp\":" << result.allocationsPerOperation
+            << ",\"bytesPerOp\":" << result.bytesPerOperation << "}"
+            << (i + 1 < results.size() ? ",\n" : "\n");
+    }
+    out << "]\n";
+    out.close();
+    if (out.fail()) {
+        std::cerr << "Unable to write benchmark results to: " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
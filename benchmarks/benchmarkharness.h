@@ -0,0 +1,107 @@
+#ifndef BENCHMARKHARNESS_H
+#define BENCHMARKHARNESS_H
+
+/***********************************************************************
+ * File Name: benchmarkharness.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the BenchmarkHarness class, a small timing
+ *              loop for the benchmark executables. Each benchmark is called
+ *              until a minimum time has been spent and is reported in
+ *              nanoseconds and heap allocations per operation. Allocations
+ *              are counted by replacing the global operator new, so they
+ *              include those made on other threads while a call runs.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+};
+
+// Totals since the program started
+AllocationCounts getAllocationCounts();
+
+// Keeps the compiler from dropping a computation whose result is unused
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static const void* volatile sink;
+    sink = &value;
+#endif
+}
+
+class BenchmarkHarness
+{
+public:
+    struct Result {
+        std::string name;
+        uint64_t operations = 0;
+        double nanosecondsPerOperation = 0;
+        double allocationsPerOperation = 0;
+        double bytesPerOperation = 0;
+    };
+
+    // Only benchmarks whose name contains 'filter' are run
+    void setFilter(const std::string& filter);
+    void setMinimumTime(std::chrono::milliseconds minimumTime);
+    bool isSelected(const std::string& name) const;
+
+    // Calls 'body', which performs 'operationsPerCall' operations, until the
+    // minimum time is spent
+    template <typename Body>
+    void run(const std::string& name, uint64_t operationsPerCall, Body&& body) {
+        runWithSetup(name, operationsPerCall, []() {}, body);
+    }
+
+    // For operations that consume their input: 'setup' runs before every
+    // call of 'body' and is neither timed nor counted
+    template <typename Setup, typename Body>
+    void runWithSetup(const std::string& name, uint64_t operationsPerCall, Setup&& setup, Body&& body) {
+        if (!isSelected(name)) {
+            return;
+        }
+        setup();
+        body(); // Warm-up
+        std::chrono::nanoseconds elapsed(0);
+        AllocationCounts counted;
+        uint64_t calls = 0;
+        while (calls < minimumCalls || elapsed < minimumTime) {
+            setup();
+            AllocationCounts before = getAllocationCounts();
+            auto start = std::chrono::steady_clock::now();
+            body();
+            auto end = std::chrono::steady_clock::now();
+            AllocationCounts after = getAllocationCounts();
+            elapsed += end - start;
+            counted.allocations += after.allocations - before.allocations;
+            counted.bytes += after.bytes - before.bytes;
+            ++calls;
+        }
+        record(name, calls * operationsPerCall, elapsed, counted);
+    }
+
+    void printHeader() const;
+    const std::vector<Result>& getResults() const;
+    // Writes the results as a JSON array. Returns false if the file could
+    // not be written.
+    bool writeJson(const std::string& filePath) const;
+
+private:
+    void record(const std::string& name, uint64_t operations, std::chrono::nanoseconds elapsed,
+                const AllocationCounts& counts);
+
+    static constexpr uint64_t minimumCalls = 3;
+    std::string filter;
+    std::chrono::nanoseconds minimumTime = std::chrono::milliseconds(500);
+    std::vector<Result> results;
+};
+
+#endif // BENCHMARKHARNESS_H
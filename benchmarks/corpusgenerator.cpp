@@ -0,0 +1,562 @@
+/***********************************************************************
+ * File Name: corpusgenerator.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: MetaMoverCorpusGenerator, which writes a tree of synthetic
+ *              photos for load testing scans and transfers. Photos come in
+ *              shoots: a DCIM folder holding one camera's photos, taken
+ *              seconds apart. Each camera numbers its files the way it does
+ *              on a card (wrapping at 9999, so names repeat across folders)
+ *              and writes its own byte order and formats: JPEG, TIFF-based
+ *              raw (CR2, NEF, ORF) or HEIC. The rates ask for duplicates of
+ *              earlier photos, '_CopyNN' names, photos without dates and
+ *              photos with a damaged EXIF block. Files are sparse unless
+ *              --dense is given: only the metadata is written and the image
+ *              data is a hole of the requested size. The same seed always
+ *              gives the same tree.
+ *              Usage: MetaMoverCorpusGenerator --output <directory> [options]
+ * License: MIT License
+ ***********************************************************************/
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "exifbuilder.h"
+#include "exifdatetime.h"
+
+namespace {
+
+enum class PhotoFormat { JPEG, Raw, HEIC };
+
+struct CameraProfile {
+    const char* make;
+    const char* model;
+    const char* lensModel;
+    const char* folderSuffix;  // DCIM folder name after the number, e.g. "100CANON"
+    const char* filePrefix;
+    const char* rawExtension;  // nullptr if the camera's raw files are not photo types MetaMover reads
+    bool motorola;
+    bool heic;                 // Writes HEIC instead of JPEG
+    unsigned weight;           // Share of shoots
+};
+
+const CameraProfile Cameras[] = {
+    {"Canon", "Canon EOS R5", "RF24-105mm F4 L IS USM", "CANON", "IMG_", ".CR2", false, false, 20},
+    {"Canon", "Canon EOS 5D Mark IV", "EF24-70mm f/2.8L II USM", "CANON", "IMG_", ".CR2", false, false, 10},
+    {"NIKON CORPORATION", "NIKON Z 6_2", "NIKKOR Z 24-70mm f/4 S", "NIKON", "DSC_", ".NEF", true, false, 15},
+    {"NIKON CORPORATION", "NIKON D750", "AF-S NIKKOR 50mm f/1.8G", "NIKON", "DSC_", ".NEF", true, false, 5},
+    {"SONY", "ILCE-7M4", "FE 35mm F1.8", "MSDCF", "DSC0", nullptr, false, false, 15},
+    {"FUJIFILM", "X-T5", "XF16-55mmF2.8 R LM WR", "_FUJI", "DSCF", nullptr, false, false, 10},
+    {"OM Digital Solutions", "OM-1", "M.Zuiko Digital ED 12-40mm F2.8 PRO", "OMSYS", "P101", ".ORF", false, false, 5},
+    {"Apple", "iPhone 15 Pro", "iPhone 15 Pro back triple camera 6.86mm f/1.78", "APPLE", "IMG_", nullptr, true, true, 20}
+};
+const size_t CameraCount = sizeof(Cameras) / sizeof(Cameras[0]);
+
+const char* const TimeZoneOffsets[] = {"-08:00", "-05:00", "+00:00", "+01:00", "+02:00", "+05:30", "+09:00"};
+
+const ExifCorruption Corruptions[] = {
+    ExifCorruption::Truncated, ExifCorruption::BadByteOrder, ExifCorruption::IFDOffsetOutside,
+    ExifCorruption::HugeEntryCount, ExifCorruption::SubIFDLoop
+};
+
+struct SizeRange {
+    uint64_t minimum;
+    uint64_t maximum;
+};
+
+struct CorpusOptions {
+    std::filesystem::path output;
+    uint64_t count = 100000;
+    uint64_t seed = 1;
+    unsigned photosPerFolder = 500;
+    unsigned foldersPerCard = 900;      // DCIM folders run from 100 to 999
+    double duplicateRate = 0.05;
+    double copyNameRate = 0.02;
+    double corruptRate = 0.01;
+    double noDateRate = 0.02;
+    double rawRate = 0.25;              // Of the photos of cameras with a raw format
+    unsigned fromYear = 2008;
+    unsigned toYear = 2025;
+    SizeRange jpegSize = {2 << 20, 12 << 20};
+    SizeRange rawSize = {20 << 20, 60 << 20};
+    SizeRange heicSize = {1 << 20, 5 << 20};
+    bool dense = false;
+};
+
+// SplitMix64: small, fast, and the same sequence on every platform
+class Random
+{
+public:
+    explicit Random(uint64_t seed) : state(seed) {}
+    uint64_t next() {
+        uint64_t z = (state += 0x9E3779B97F4A7C15ull);
+        z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+        z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+        return z ^ (z >> 31);
+    }
+    uint64_t below(uint64_t bound) {
+        return bound == 0 ? 0 : next() % bound;
+    }
+    double unit() {
+        return static_cast<double>(next() >> 11) / 9007199254740992.0;
+    }
+    bool chance(double rate) {
+        return unit() < rate;
+    }
+    // Log-uniform, so small and large files are both common
+    uint64_t size(const SizeRange& range) {
+        if (range.maximum <= range.minimum) return range.minimum;
+        double low = std::log(static_cast<double>(std::max<uint64_t>(range.minimum, 1)));
+        double high = std::log(static_cast<double>(range.maximum));
+        return static_cast<uint64_t>(std::exp(low + unit() * (high - low)));
+    }
+private:
+    uint64_t state;
+};
+
+// Everything a photo's bytes are made from, so a duplicate can be written
+// again byte for byte
+struct PhotoSpec {
+    size_t camera = 0;
+    PhotoFormat format = PhotoFormat::JPEG;
+    SyntheticExif exif;
+    ExifCorruption corruption = ExifCorruption::None;
+    uint64_t fileSize = 0;
+    uint64_t dataSeed = 0;
+    std::string fileName;
+};
+
+struct CorpusCounts {
+    uint64_t photos = 0;
+    uint64_t folders = 0;
+    uint64_t jpeg = 0;
+    uint64_t raw = 0;
+    uint64_t heic = 0;
+    uint64_t duplicates = 0;
+    uint64_t copyNames = 0;
+    uint64_t corrupt = 0;
+    uint64_t noDate = 0;
+    uint64_t motorola = 0;
+    uint64_t bytes = 0;
+};
+
+// Moves 'dateTime' on by 'seconds' (less than a day)
+void advance(EXIFDateTime& dateTime, unsigned seconds) {
+    unsigned total = dateTime.second + seconds;
+    dateTime.second = static_cast<uint8_t>(total % 60);
+    total = dateTime.minute + total / 60;
+    dateTime.minute = static_cast<uint8_t>(total % 60);
+    total = dateTime.hour + total / 60;
+    dateTime.hour = static_cast<uint8_t>(total % 24);
+    if (total < 24) return;
+    if (++dateTime.day > EXIFDateTime::daysInMonth(dateTime.year, dateTime.month)) {
+        dateTime.day = 1;
+        if (++dateTime.month > 12) {
+            dateTime.month = 1;
+            ++dateTime.year;
+        }
+    }
+}
+
+std::string formatDateTime(const EXIFDateTime& dateTime) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%04u:%02u:%02u %02u:%02u:%02u",
+                  static_cast<unsigned>(dateTime.year), static_cast<unsigned>(dateTime.month),
+                  static_cast<unsigned>(dateTime.day), static_cast<unsigned>(dateTime.hour),
+                  static_cast<unsigned>(dateTime.minute), static_cast<unsigned>(dateTime.second));
+    return text;
+}
+
+const char* extensionFor(const PhotoSpec& spec) {
+    switch (spec.format) {
+    case PhotoFormat::Raw:
+        return Cameras[spec.camera].rawExtension;
+    case PhotoFormat::HEIC:
+        return ".HEIC";
+    case PhotoFormat::JPEG:
+        break;
+    }
+    return ".JPG";
+}
+
+std::string makeFileName(const CameraProfile& camera, unsigned fileNumber, const char* extension) {
+    char text[64];
+    std::snprintf(text, sizeof(text), "%s%04u%s", camera.filePrefix, fileNumber, extension);
+    return text;
+}
+
+// "IMG_0001.JPG" becomes "IMG_0001_Copy03.JPG"
+std::string makeCopyName(const std::string& fileName, unsigned copyNumber) {
+    size_t dot = fileName.rfind('.');
+    char suffix[16];
+    std::snprintf(suffix, sizeof(suffix), "_Copy%02u", copyNumber);
+    return fileName.substr(0, dot) + suffix + fileName.substr(dot);
+}
+
+bool writeImageData(std::ofstream& file, uint64_t size, uint64_t dataSeed) {
+    Random random(dataSeed);
+    std::vector<uint64_t> block(1 << 17); // 1 MiB
+    while (size > 0) {
+        for (uint64_t& word : block) word = random.next();
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(size, block.size() * sizeof(uint64_t)));
+        file.write(reinterpret_cast<const char*>(block.data()), static_cast<std::streamsize>(chunk));
+        size -= chunk;
+    }
+    return static_cast<bool>(file);
+}
+
+// The metadata, then the image data (a hole when sparse), then for JPEG the
+// EOI marker at the very end
+bool writePhoto(const std::filesystem::path& filePath, const PhotoSpec& spec, bool dense) {
+    std::vector<uint8_t> tiff = ExifBuilder::buildTiff(spec.exif);
+    ExifBuilder::corrupt(tiff, spec.corruption, spec.exif.motorola);
+    std::vector<uint8_t> trailer;
+    std::vector<uint8_t> header;
+    switch (spec.format) {
+    case PhotoFormat::JPEG:
+        header = ExifBuilder::buildJpegHeader(tiff);
+        trailer = {0xFF, 0xD9};
+        break;
+    case PhotoFormat::Raw:
+        header = tiff;
+        break;
+    case PhotoFormat::HEIC: {
+        // The mdat header's size depends on the image data's size
+        size_t headerSize = ExifBuilder::buildHeifHeader(tiff, 0).size();
+        uint64_t imageSize = spec.fileSize > headerSize ? spec.fileSize - headerSize : 0;
+        if (imageSize + 8 > UINT32_MAX) {
+            imageSize = imageSize > 8 ? imageSize - 8 : 0; // Room for the 64-bit mdat size
+        }
+        header = ExifBuilder::buildHeifHeader(tiff, imageSize);
+        break;
+    }
+    }
+    uint64_t fileSize = std::max<uint64_t>(spec.fileSize, header.size() + trailer.size());
+    uint64_t imageSize = fileSize - header.size() - trailer.size();
+
+    std::ofstream file(filePath, std::ios::binary | std::ios::trunc);
+    if (!file) {
+        std::cerr << "Unable to create " << filePath.string() << std::endl;
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(header.data()), static_cast<std::streamsize>(header.size()));
+    if (dense) {
+        writeImageData(file, imageSize, spec.dataSeed);
+    } else if (trailer.empty()) {
+        // Ends the hole with a written byte, so the file has its full size
+        if (imageSize > 0) {
+            file.seekp(static_cast<std::streamoff>(fileSize - 1));
+            file.put(0);
+        }
+    } else {
+        file.seekp(static_cast<std::streamoff>(fileSize - trailer.size()));
+    }
+    file.write(reinterpret_cast<const char*>(trailer.data()), static_cast<std::streamsize>(trailer.size()));
+    if (!file.flush()) {
+        std::cerr << "Unable to write " << filePath.string() << std::endl;
+        return false;
+    }
+    return true;
+}
+
+class CorpusGenerator
+{
+public:
+    explicit CorpusGenerator(const CorpusOptions& options) : options(options), random(options.seed) {
+        fileNumbers.assign(CameraCount, 0);
+        for (size_t i = 0; i < CameraCount; ++i) {
+            fileNumbers[i] = static_cast<unsigned>(1 + random.below(9999));
+            totalWeight += Cameras[i].weight;
+        }
+    }
+
+    bool run() {
+        uint64_t folderIndex = 0;
+        while (counts.photos < options.count) {
+            if (!writeShoot(folderIndex++)) {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    const CorpusCounts& getCounts() const {
+        return counts;
+    }
+
+private:
+    size_t pickCamera() {
+        uint64_t ticket = random.below(totalWeight);
+        for (size_t i = 0; i < CameraCount; ++i) {
+            if (ticket < Cameras[i].weight) return i;
+            ticket -= Cameras[i].weight;
+        }
+        return 0;
+    }
+
+    EXIFDateTime pickShootStart() {
+        EXIFDateTime start;
+        start.year = static_cast<uint16_t>(options.fromYear + random.below(options.toYear - options.fromYear + 1));
+        start.month = static_cast<uint8_t>(1 + random.below(12));
+        start.day = static_cast<uint8_t>(1 + random.below(EXIFDateTime::daysInMonth(start.year, start.month)));
+        start.hour = static_cast<uint8_t>(7 + random.below(12));
+        start.minute = static_cast<uint8_t>(random.below(60));
+        start.second = static_cast<uint8_t>(random.below(60));
+        return start;
+    }
+
+    // Card NN holds DCIM folders 100 to 999, as a camera numbers them
+    std::filesystem::path folderPath(uint64_t folderIndex, const CameraProfile& camera) const {
+        char card[16], folder[16];
+        std::snprintf(card, sizeof(card), "Card%03u", static_cast<unsigned>(folderIndex / options.foldersPerCard));
+        std::snprintf(folder, sizeof(folder), "%03u%s",
+                      static_cast<unsigned>(100 + folderIndex % options.foldersPerCard), camera.folderSuffix);
+        return options.output / card / "DCIM" / folder;
+    }
+
+    bool writeShoot(uint64_t folderIndex) {
+        size_t camera = pickCamera();
+        const CameraProfile& profile = Cameras[camera];
+        std::filesystem::path folder = folderPath(folderIndex, profile);
+        std::error_code ec;
+        std::filesystem::create_directories(folder, ec);
+        if (ec) {
+            std::cerr << "Unable to create " << folder.string() << ": " << ec.message() << std::endl;
+            return false;
+        }
+        ++counts.folders;
+
+        EXIFDateTime clock = pickShootStart();
+        const char* offset = TimeZoneOffsets[random.below(sizeof(TimeZoneOffsets) / sizeof(TimeZoneOffsets[0]))];
+        // Phones always record the offset, cameras only sometimes
+        bool writesOffset = profile.heic || random.chance(0.5);
+        std::vector<std::string> folderNames;
+
+        uint64_t photosInShoot = std::min<uint64_t>(options.photosPerFolder, options.count - counts.photos);
+        for (uint64_t i = 0; i < photosInShoot; ++i) {
+            advance(clock, static_cast<unsigned>(1 + random.below(random.chance(0.8) ? 10 : 600)));
+            PhotoSpec spec;
+            bool duplicate = !earlierPhotos.empty() && random.chance(options.duplicateRate);
+            if (duplicate) {
+                spec = earlierPhotos[random.below(earlierPhotos.size())];
+                ++counts.duplicates;
+            } else {
+                spec = makePhoto(camera, clock, writesOffset ? offset : nullptr);
+                rememberPhoto(spec);
+            }
+            // A copy name reuses a name from this folder, or the photo's own
+            if (random.chance(options.copyNameRate)) {
+                const std::string& baseName = folderNames.empty() ? spec.fileName
+                                                                  : folderNames[random.below(folderNames.size())];
+                spec.fileName = makeCopyName(baseName, static_cast<unsigned>(1 + random.below(20)));
+                ++counts.copyNames;
+            }
+            // A name already used in this folder (after the file numbers
+            // wrapped) would overwrite a photo
+            if (std::find(folderNames.begin(), folderNames.end(), spec.fileName) != folderNames.end()) {
+                spec.fileName = makeCopyName(spec.fileName, static_cast<unsigned>(21 + i % 79));
+            }
+            folderNames.push_back(spec.fileName);
+            if (!writePhoto(folder / spec.fileName, spec, options.dense)) {
+                return false;
+            }
+            count(spec);
+        }
+        return true;
+    }
+
+    PhotoSpec makePhoto(size_t camera, const EXIFDateTime& clock, const char* offset) {
+        const CameraProfile& profile = Cameras[camera];
+        PhotoSpec spec;
+        spec.camera = camera;
+        if (profile.heic) {
+            spec.format = PhotoFormat::HEIC;
+        } else if (profile.rawExtension && random.chance(options.rawRate)) {
+            spec.format = PhotoFormat::Raw;
+        }
+        spec.exif.make = profile.make;
+        spec.exif.model = profile.model;
+        spec.exif.lensModel = profile.lensModel;
+        spec.exif.motorola = profile.motorola;
+        if (!random.chance(options.noDateRate)) {
+            spec.exif.dateTimeOriginal = formatDateTime(clock);
+            if (offset) spec.exif.offsetTimeOriginal = offset;
+        }
+        spec.exif.orientation = random.chance(0.15) ? 6 : 1;
+        spec.exif.isoSpeed = static_cast<uint16_t>(100 << random.below(6));
+        spec.exif.exposureDenominator = static_cast<uint32_t>(30 << random.below(6));
+        spec.exif.fNumberTenths = static_cast<uint32_t>(14 + random.below(100));
+        spec.exif.focalLength = static_cast<uint32_t>(14 + random.below(186));
+        if (random.chance(options.corruptRate)) {
+            spec.corruption = Corruptions[random.below(sizeof(Corruptions) / sizeof(Corruptions[0]))];
+        }
+        switch (spec.format) {
+        case PhotoFormat::JPEG:
+            spec.fileSize = random.size(options.jpegSize);
+            break;
+        case PhotoFormat::Raw:
+            spec.fileSize = random.size(options.rawSize);
+            break;
+        case PhotoFormat::HEIC:
+            spec.fileSize = random.size(options.heicSize);
+            break;
+        }
+        spec.dataSeed = random.next();
+
+        unsigned& fileNumber = fileNumbers[camera];
+        spec.fileName = makeFileName(profile, fileNumber, extensionFor(spec));
+        fileNumber = fileNumber % 9999 + 1;
+        return spec;
+    }
+
+    // Duplicates are drawn from a sample of the photos so far, which keeps
+    // memory flat for a million photos
+    void rememberPhoto(const PhotoSpec& spec) {
+        const size_t sampleSize = 4096;
+        if (earlierPhotos.size() < sampleSize) {
+            earlierPhotos.push_back(spec);
+        } else {
+            earlierPhotos[random.below(sampleSize)] = spec;
+        }
+    }
+
+    void count(const PhotoSpec& spec) {
+        ++counts.photos;
+        switch (spec.format) {
+        case PhotoFormat::JPEG: ++counts.jpeg; break;
+        case PhotoFormat::Raw: ++counts.raw; break;
+        case PhotoFormat::HEIC: ++counts.heic; break;
+        }
+        if (spec.corruption != ExifCorruption::None) ++counts.corrupt;
+        if (spec.exif.dateTimeOriginal.empty()) ++counts.noDate;
+        if (spec.exif.motorola) ++counts.motorola;
+        counts.bytes += spec.fileSize;
+    }
+
+    const CorpusOptions& options;
+    Random random;
+    uint64_t totalWeight = 0;
+    std::vector<unsigned> fileNumbers;
+    std::vector<PhotoSpec> earlierPhotos;
+    CorpusCounts counts;
+};
+
+// "12M", "1.5G", "800K" or a byte count
+bool parseSize(const std::string& text, uint64_t& size) {
+    char* end = nullptr;
+    double value = std::strtod(text.c_str(), &end);
+    if (end == text.c_str() || value < 0) return false;
+    std::string unit(end);
+    if (unit == "K" || unit == "k") value *= 1024;
+    else if (unit == "M" || unit == "m") value *= 1024 * 1024;
+    else if (unit == "G" || unit == "g") value *= 1024.0 * 1024 * 1024;
+    else if (!unit.empty()) return false;
+    size = static_cast<uint64_t>(value);
+    return true;
+}
+
+// "2M-12M"
+bool parseSizeRange(const std::string& text, SizeRange& range) {
+    size_t dash = text.find('-');
+    if (dash == std::string::npos) {
+        if (!parseSize(text, range.minimum)) return false;
+        range.maximum = range.minimum;
+        return true;
+    }
+    return parseSize(text.substr(0, dash), range.minimum) &&
+           parseSize(text.substr(dash + 1), range.maximum) && range.minimum <= range.maximum;
+}
+
+bool parseRate(const char* text, double& rate) {
+    char* end = nullptr;
+    rate = std::strtod(text, &end);
+    return end != text && *end == '\0' && rate >= 0 && rate <= 1;
+}
+
+void printUsage(const char* program) {
+    std::cerr << "Usage: " << program << " --output <directory> [--count <photos>] [--seed <number>]\n"
+              << "       [--photos-per-folder <n>] [--duplicate-rate <0-1>] [--copy-name-rate <0-1>]\n"
+              << "       [--corrupt-rate <0-1>] [--no-date-rate <0-1>] [--raw-rate <0-1>]\n"
+              << "       [--from-year <year>] [--to-year <year>] [--jpeg-size <min-max>]\n"
+              << "       [--raw-size <min-max>] [--heic-size <min-max>] [--dense]\n"
+              << "Sizes take K, M and G suffixes, e.g. --jpeg-size 2M-12M." << std::endl;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    CorpusOptions options;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        bool valid = true;
+        if (argument == "--dense") {
+            options.dense = true;
+        } else if (!hasValue) {
+            valid = false;
+        } else if (argument == "--output") {
+            options.output = argv[++i];
+        } else if (argument == "--count") {
+            options.count = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--seed") {
+            options.seed = std::strtoull(argv[++i], nullptr, 10);
+        } else if (argument == "--photos-per-folder") {
+            options.photosPerFolder = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+            valid = options.photosPerFolder > 0;
+        } else if (argument == "--duplicate-rate") {
+            valid = parseRate(argv[++i], options.duplicateRate);
+        } else if (argument == "--copy-name-rate") {
+            valid = parseRate(argv[++i], options.copyNameRate);
+        } else if (argument == "--corrupt-rate") {
+            valid = parseRate(argv[++i], options.corruptRate);
+        } else if (argument == "--no-date-rate") {
+            valid = parseRate(argv[++i], options.noDateRate);
+        } else if (argument == "--raw-rate") {
+            valid = parseRate(argv[++i], options.rawRate);
+        } else if (argument == "--from-year") {
+            options.fromYear = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--to-year") {
+            options.toYear = static_cast<unsigned>(std::strtoul(argv[++i], nullptr, 10));
+        } else if (argument == "--jpeg-size") {
+            valid = parseSizeRange(argv[++i], options.jpegSize);
+        } else if (argument == "--raw-size") {
+            valid = parseSizeRange(argv[++i], options.rawSize);
+        } else if (argument == "--heic-size") {
+            valid = parseSizeRange(argv[++i], options.heicSize);
+        } else {
+            valid = false;
+        }
+        if (!valid) {
+            std::cerr << "Invalid argument: " << argument << std::endl;
+            printUsage(argv[0]);
+            return 2;
+        }
+    }
+    if (options.output.empty() || options.fromYear < 1970 || options.toYear > 9999 ||
+        options.fromYear > options.toYear) {
+        printUsage(argv[0]);
+        return 2;
+    }
+
+    CorpusGenerator generator(options);
+    bool written = generator.run();
+    const CorpusCounts& counts = generator.getCounts();
+    std::cout << "Photos:       " << counts.photos << " in " << counts.folders << " folders\n"
+              << "JPEG:         " << counts.jpeg << "\n"
+              << "Raw:          " << counts.raw << "\n"
+              << "HEIC:         " << counts.heic << "\n"
+              << "Big-endian:   " << counts.motorola << "\n"
+              << "Duplicates:   " << counts.duplicates << "\n"
+              << "Copy names:   " << counts.copyNames << "\n"
+              << "No date:      " << counts.noDate << "\n"
+              << "Corrupt EXIF: " << counts.corrupt << "\n"
+              << "Total size:   " << counts.bytes / (1024 * 1024) << " MiB"
+              << (options.dense ? "" : " (sparse)") << std::endl;
+    return written ? 0 : 1;
+}
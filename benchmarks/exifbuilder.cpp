@@ -0,0 +1,286 @@
+/***********************************************************************
+ * File Name: exifbuilder.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the ExifBuilder class. Each IFD is written
+ *              as its entries followed by the values that do not fit in an
+ *              entry, the layout cameras use.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <algorithm>
+#include "exifbuilder.h"
+
+namespace {
+
+class ByteWriter
+{
+public:
+    ByteWriter(std::vector<uint8_t>& out, bool bigEndian) : out(out), bigEndian(bigEndian) {}
+    void u16(uint16_t value) {
+        if (bigEndian) {
+            out.push_back(static_cast<uint8_t>(value >> 8));
+            out.push_back(static_cast<uint8_t>(value));
+        } else {
+            out.push_back(static_cast<uint8_t>(value));
+            out.push_back(static_cast<uint8_t>(value >> 8));
+        }
+    }
+    void u32(uint32_t value) {
+        if (bigEndian) {
+            u16(static_cast<uint16_t>(value >> 16));
+            u16(static_cast<uint16_t>(value));
+        } else {
+            u16(static_cast<uint16_t>(value));
+            u16(static_cast<uint16_t>(value >> 16));
+        }
+    }
+    void bytes(const std::vector<uint8_t>& data) {
+        out.insert(out.end(), data.begin(), data.end());
+    }
+private:
+    std::vector<uint8_t>& out;
+    bool bigEndian;
+};
+
+// One IFD; entries must be added in tag order
+class IFDBuilder
+{
+public:
+    explicit IFDBuilder(bool bigEndian) : bigEndian(bigEndian) {}
+
+    void ascii(uint16_t tag, const std::string& text) {
+        std::vector<uint8_t> value(text.begin(), text.end());
+        value.push_back(0);
+        entries.push_back({tag, 2, static_cast<uint32_t>(value.size()), value});
+    }
+    void shortValue(uint16_t tag, uint16_t number) {
+        std::vector<uint8_t> value;
+        ByteWriter(value, bigEndian).u16(number);
+        entries.push_back({tag, 3, 1, value});
+    }
+    void longValue(uint16_t tag, uint32_t number) {
+        std::vector<uint8_t> value;
+        ByteWriter(value, bigEndian).u32(number);
+        entries.push_back({tag, 4, 1, value});
+    }
+    void rational(uint16_t tag, uint32_t numerator, uint32_t denominator) {
+        std::vector<uint8_t> value;
+        ByteWriter writer(value, bigEndian);
+        writer.u32(numerator);
+        writer.u32(denominator);
+        entries.push_back({tag, 5, 1, value});
+    }
+
+    // Bytes the IFD takes with its values, once 'extraEntries' more are added
+    size_t size(size_t extraEntries = 0) const {
+        size_t total = 2 + 12 * (entries.size() + extraEntries) + 4;
+        for (const Entry& entry : entries) {
+            if (entry.value.size() > 4) total += (entry.value.size() + 1) & ~size_t(1);
+        }
+        return total;
+    }
+
+    void write(std::vector<uint8_t>& tiff) const {
+        ByteWriter writer(tiff, bigEndian);
+        uint32_t valueOffset = static_cast<uint32_t>(tiff.size() + 2 + 12 * entries.size() + 4);
+        writer.u16(static_cast<uint16_t>(entries.size()));
+        for (const Entry& entry : entries) {
+            writer.u16(entry.tag);
+            writer.u16(entry.type);
+            writer.u32(entry.count);
+            if (entry.value.size() <= 4) {
+                std::vector<uint8_t> inlineValue(entry.value);
+                inlineValue.resize(4, 0); // Left-justified
+                writer.bytes(inlineValue);
+            } else {
+                writer.u32(valueOffset);
+                valueOffset += static_cast<uint32_t>((entry.value.size() + 1) & ~size_t(1));
+            }
+        }
+        writer.u32(0); // No next IFD
+        for (const Entry& entry : entries) {
+            if (entry.value.size() > 4) {
+                writer.bytes(entry.value);
+                if (entry.value.size() % 2) tiff.push_back(0);
+            }
+        }
+    }
+
+private:
+    struct Entry {
+        uint16_t tag;
+        uint16_t type;
+        uint32_t count;
+        std::vector<uint8_t> value;
+    };
+    bool bigEndian;
+    std::vector<Entry> entries;
+};
+
+void appendBigEndian(std::vector<uint8_t>& out, uint64_t value, int bytes) {
+    for (int shift = (bytes - 1) * 8; shift >= 0; shift -= 8) {
+        out.push_back(static_cast<uint8_t>(value >> shift));
+    }
+}
+
+std::vector<uint8_t> box(const char* type, const std::vector<uint8_t>& content) {
+    std::vector<uint8_t> out;
+    appendBigEndian(out, 8 + content.size(), 4);
+    out.insert(out.end(), type, type + 4);
+    out.insert(out.end(), content.begin(), content.end());
+    return out;
+}
+
+std::vector<uint8_t> fullBox(const char* type, uint8_t version, const std::vector<uint8_t>& content) {
+    std::vector<uint8_t> versioned = {version, 0, 0, 0};
+    versioned.insert(versioned.end(), content.begin(), content.end());
+    return box(type, versioned);
+}
+
+void appendAll(std::vector<uint8_t>& out, const std::vector<uint8_t>& data) {
+    out.insert(out.end(), data.begin(), data.end());
+}
+
+}
+
+std::vector<uint8_t> ExifBuilder::buildTiff(const SyntheticExif& exif) {
+    const bool bigEndian = exif.motorola;
+    IFDBuilder ifd0(bigEndian);
+    ifd0.ascii(0x010F, exif.make);
+    ifd0.ascii(0x0110, exif.model);
+    ifd0.shortValue(0x0112, exif.orientation);
+    if (!exif.dateTimeOriginal.empty()) {
+        ifd0.ascii(0x0132, exif.dateTimeOriginal);
+    }
+    // The SubIFD follows IFD0, which ends once its pointer entry is added
+    ifd0.longValue(0x8769, static_cast<uint32_t>(8 + ifd0.size(1)));
+
+    IFDBuilder exifIFD(bigEndian);
+    exifIFD.rational(0x829A, 1, exif.exposureDenominator);
+    exifIFD.rational(0x829D, exif.fNumberTenths, 10);
+    exifIFD.shortValue(0x8827, exif.isoSpeed);
+    if (!exif.dateTimeOriginal.empty()) {
+        exifIFD.ascii(0x9003, exif.dateTimeOriginal);
+        exifIFD.ascii(0x9004, exif.dateTimeOriginal);
+        if (!exif.offsetTimeOriginal.empty()) {
+            exifIFD.ascii(0x9011, exif.offsetTimeOriginal);
+        }
+    }
+    exifIFD.rational(0x920A, exif.focalLength, 1);
+    exifIFD.longValue(0xA002, exif.imageWidth);
+    exifIFD.longValue(0xA003, exif.imageHeight);
+    if (!exif.lensModel.empty()) {
+        exifIFD.ascii(0xA434, exif.lensModel);
+    }
+
+    std::vector<uint8_t> tiff;
+    ByteWriter writer(tiff, bigEndian);
+    tiff.push_back(bigEndian ? 'M' : 'I');
+    tiff.push_back(bigEndian ? 'M' : 'I');
+    writer.u16(42);
+    writer.u32(8);
+    ifd0.write(tiff);
+    exifIFD.write(tiff);
+    return tiff;
+}
+
+void ExifBuilder::corrupt(std::vector<uint8_t>& tiff, ExifCorruption corruption, bool motorola) {
+    std::vector<uint8_t> patch;
+    ByteWriter writer(patch, motorola);
+    switch (corruption) {
+    case ExifCorruption::None:
+        return;
+    case ExifCorruption::Truncated:
+        tiff.resize(tiff.size() / 2);
+        return;
+    case ExifCorruption::BadByteOrder:
+        tiff[0] = 'X';
+        tiff[1] = 'Y';
+        return;
+    case ExifCorruption::IFDOffsetOutside:
+        writer.u32(0xFFFFFF00u);
+        std::copy(patch.begin(), patch.end(), tiff.begin() + 4);
+        return;
+    case ExifCorruption::HugeEntryCount:
+        writer.u16(0xFFFF);
+        std::copy(patch.begin(), patch.end(), tiff.begin() + 8);
+        return;
+    case ExifCorruption::SubIFDLoop: {
+        // The pointer is IFD0's last entry; its value sits just before the
+        // next-IFD offset
+        size_t entryCount = motorola ? (tiff[8] << 8 | tiff[9]) : (tiff[9] << 8 | tiff[8]);
+        size_t pointerValue = 8 + 2 + 12 * entryCount - 4;
+        writer.u32(8);
+        std::copy(patch.begin(), patch.end(), tiff.begin() + pointerValue);
+        return;
+    }
+    }
+}
+
+std::vector<uint8_t> ExifBuilder::buildJpegHeader(const std::vector<uint8_t>& tiff) {
+    size_t segmentLength = 2 + 6 + tiff.size();
+    std::vector<uint8_t> jpeg = {0xFF, 0xD8, 0xFF, 0xE1};
+    appendBigEndian(jpeg, segmentLength, 2);
+    jpeg.insert(jpeg.end(), {'E', 'x', 'i', 'f', 0, 0});
+    appendAll(jpeg, tiff);
+    return jpeg;
+}
+
+std::vector<uint8_t> ExifBuilder::buildHeifHeader(const std::vector<uint8_t>& tiff, uint64_t imageDataSize) {
+    // The Exif item: offset of the TIFF header past "Exif\0\0", then both
+    std::vector<uint8_t> exifItem;
+    appendBigEndian(exifItem, 6, 4);
+    exifItem.insert(exifItem.end(), {'E', 'x', 'i', 'f', 0, 0});
+    appendAll(exifItem, tiff);
+
+    std::vector<uint8_t> ftypContent = {'h', 'e', 'i', 'c', 0, 0, 0, 0, 'm', 'i', 'f', '1', 'h', 'e', 'i', 'c'};
+    std::vector<uint8_t> hdlrContent(4, 0);
+    hdlrContent.insert(hdlrContent.end(), {'p', 'i', 'c', 't'});
+    hdlrContent.resize(hdlrContent.size() + 13, 0);
+
+    // Item 1 is the image, item 2 the Exif block
+    auto infe = [](uint16_t itemId, const char* itemType) {
+        std::vector<uint8_t> content;
+        appendBigEndian(content, itemId, 2);
+        appendBigEndian(content, 0, 2);
+        content.insert(content.end(), itemType, itemType + 4);
+        content.push_back(0); // Empty item name
+        return fullBox("infe", 2, content);
+    };
+    std::vector<uint8_t> iinfContent;
+    appendBigEndian(iinfContent, 2, 2);
+    appendAll(iinfContent, infe(1, "hvc1"));
+    appendAll(iinfContent, infe(2, "Exif"));
+
+    // iloc version 1: 4-byte offsets and lengths, no base offset. The image
+    // extent is left empty (its data is the mdat); Exif is in idat
+    // (construction method 1).
+    std::vector<uint8_t> ilocContent = {0x44, 0x00};
+    appendBigEndian(ilocContent, 2, 2);
+    for (uint16_t itemId : {uint16_t(1), uint16_t(2)}) {
+        appendBigEndian(ilocContent, itemId, 2);
+        appendBigEndian(ilocContent, itemId == 2 ? 1 : 0, 2); // Construction method
+        appendBigEndian(ilocContent, 0, 2);                   // Data reference index
+        appendBigEndian(ilocContent, 1, 2);                   // Extent count
+        appendBigEndian(ilocContent, 0, 4);                   // Extent offset
+        appendBigEndian(ilocContent, itemId == 2 ? exifItem.size() : 0, 4);
+    }
+
+    std::vector<uint8_t> metaContent = fullBox("hdlr", 0, hdlrContent);
+    appendAll(metaContent, fullBox("iinf", 0, iinfContent));
+    appendAll(metaContent, fullBox("iloc", 1, ilocContent));
+    appendAll(metaContent, box("idat", exifItem));
+
+    std::vector<uint8_t> heif = box("ftyp", ftypContent);
+    appendAll(heif, fullBox("meta", 0, metaContent));
+    if (imageDataSize + 8 > UINT32_MAX) {
+        appendBigEndian(heif, 1, 4); // 64-bit size follows the type
+        heif.insert(heif.end(), {'m', 'd', 'a', 't'});
+        appendBigEndian(heif, imageDataSize + 16, 8);
+    } else {
+        appendBigEndian(heif, imageDataSize + 8, 4);
+        heif.insert(heif.end(), {'m', 'd', 'a', 't'});
+    }
+    return heif;
+}
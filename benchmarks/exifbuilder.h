@@ -0,0 +1,63 @@
+#ifndef EXIFBUILDER_H
+#define EXIFBUILDER_H
+
+/***********************************************************************
+ * File Name: exifbuilder.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the ExifBuilder class, which writes the
+ *              metadata of synthetic photos for the benchmark tools: a TIFF
+ *              structure (IFD0 and EXIF SubIFD, in either byte order) and
+ *              the JPEG or HEIF header that carries it. The files are shaped
+ *              for MetaMover's metadata readers, not for image decoders.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+struct SyntheticExif {
+    std::string make;
+    std::string model;
+    std::string lensModel;
+    std::string dateTimeOriginal;   // "YYYY:MM:DD HH:MM:SS"; empty leaves out the date tags
+    std::string offsetTimeOriginal; // "+HH:MM"; empty leaves out the tag
+    uint16_t orientation = 1;
+    uint16_t isoSpeed = 100;
+    uint32_t exposureDenominator = 125; // Exposure time 1/N s
+    uint32_t fNumberTenths = 40;
+    uint32_t focalLength = 50;
+    uint32_t imageWidth = 6000;
+    uint32_t imageHeight = 4000;
+    bool motorola = false;              // Big-endian ("MM") instead of Intel ("II")
+};
+
+// Ways the TIFF structure is damaged for corrupt test files
+enum class ExifCorruption {
+    None,
+    Truncated,         // Cut in half
+    BadByteOrder,      // Neither "II" nor "MM"
+    IFDOffsetOutside,  // IFD0 points past the end of the data
+    HugeEntryCount,    // IFD0 claims 65535 entries
+    SubIFDLoop         // The EXIF SubIFD pointer leads back to IFD0
+};
+
+class ExifBuilder
+{
+public:
+    // "II*\0" (or "MM\0*") followed by IFD0 and the EXIF SubIFD
+    static std::vector<uint8_t> buildTiff(const SyntheticExif& exif);
+    static void corrupt(std::vector<uint8_t>& tiff, ExifCorruption corruption, bool motorola);
+
+    // SOI and an APP1 segment holding "Exif\0\0" and 'tiff'. The image data
+    // and the EOI marker are up to the caller.
+    static std::vector<uint8_t> buildJpegHeader(const std::vector<uint8_t>& tiff);
+
+    // ftyp and a meta box whose Exif item (kept in the meta box's idat) is
+    // 'tiff', then the header of an mdat box of 'imageDataSize' bytes, which
+    // the caller writes after it
+    static std::vector<uint8_t> buildHeifHeader(const std::vector<uint8_t>& tiff, uint64_t imageDataSize);
+};
+
+#endif // EXIFBUILDER_H
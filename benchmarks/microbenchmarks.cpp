@@ -0,0 +1,349 @@
+/***********************************************************************
+ * File Name: microbenchmarks.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: MetaMoverBenchmarks, microbenchmarks of the per-photo hot
+ *              paths: EXIF parsing, date parsing, output path generation,
+ *              copy name generation and duplicate detection. The EXIF
+ *              benchmarks parse the JPEGs of --jpeg-dir if given, otherwise
+ *              generated EXIF headers. Photos for the other benchmarks are
+ *              restored from made-up scan cache entries, so no file is read
+ *              and only the code under test is measured (duplicates get an
+ *              empty file, as their modified times are compared).
+ *              Usage: MetaMoverBenchmarks [--filter <text>] [--min-time <ms>]
+ *                                         [--jpeg-dir <directory>] [--json <file>]
+ * License: MIT License
+ ***********************************************************************/
+
+#include <QCoreApplication>
+#include <cctype>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "benchmarkharness.h"
+#include "appconfig.h"
+#include "directorytransfer.h"
+#include "exif.h"
+#include "exifbuilder.h"
+#include "exifsegmentreader.h"
+#include "photofilehandler.h"
+#include "transfermanager.h"
+
+// Reaches the private functions being measured (a friend of both classes)
+struct BenchmarkAccess {
+    static void parseDateTime(PhotoFileHandler& handler, std::string_view dateTime, std::string_view offset) {
+        handler.parseDateTime(dateTime, offset);
+    }
+    static void compilePathTemplates(TransferManager& transferManager) {
+        transferManager.compilePathTemplates();
+    }
+    static const std::string& generateDirectoryPath(TransferManager& transferManager, PhotoFileHandler* handler) {
+        return transferManager.generateDirectoryPath(handler);
+    }
+    static std::string createNumericalFileName(TransferManager& transferManager, const std::string& fileName,
+                                               const std::string& targetDirectory) {
+        return transferManager.createNumericalFileName(fileName, targetDirectory);
+    }
+    static TargetDirectoryIndex& getTargetDirectoryIndex(TransferManager& transferManager,
+                                                        const std::string& targetDirectory) {
+        DirectoryTransfer& directoryTransfer = transferManager.directoryTransferMap[targetDirectory];
+        directoryTransfer.setTargetDirectory(targetDirectory);
+        return directoryTransfer.getTargetDirectoryIndex();
+    }
+};
+
+namespace {
+
+const size_t InputSizes[] = {1000, 10000, 100000};
+
+const char* const CameraMakes[] = {"Canon", "NIKON CORPORATION", "SONY", "FUJIFILM", "Apple"};
+const char* const CameraModels[] = {"Canon EOS R5", "NIKON Z 6_2", "ILCE-7M4", "X-T5", "iPhone 15 Pro"};
+const char* const LensModels[] = {"RF24-105mm F4 L IS USM", "NIKKOR Z 24-70mm f/4 S", "FE 35mm F1.8",
+                                  "XF16-55mmF2.8 R LM WR", "iPhone 15 Pro back triple camera 6.86mm f/1.78"};
+
+std::string makeDateTime(size_t index) {
+    char text[32];
+    std::snprintf(text, sizeof(text), "%04u:%02u:%02u %02u:%02u:%02u",
+                  static_cast<unsigned>(2005 + index % 20), static_cast<unsigned>(1 + index % 12),
+                  static_cast<unsigned>(1 + index % 28), static_cast<unsigned>(index % 24),
+                  static_cast<unsigned>(index % 60), static_cast<unsigned>((index * 7) % 60));
+    return text;
+}
+
+// A JPEG holding only its EXIF segment, as a camera writes it. Every other
+// one is big-endian, as Nikon and Apple write theirs.
+std::vector<uint8_t> makeJPEGHeader(size_t index) {
+    size_t camera = index % 5;
+    SyntheticExif exif;
+    exif.make = CameraMakes[camera];
+    exif.model = CameraModels[camera];
+    exif.lensModel = LensModels[camera];
+    exif.dateTimeOriginal = makeDateTime(index);
+    exif.offsetTimeOriginal = index % 2 ? "+02:00" : "-05:00";
+    exif.exposureDenominator = static_cast<uint32_t>(60 + index % 4000);
+    exif.fNumberTenths = static_cast<uint32_t>(14 + index % 100);
+    exif.isoSpeed = static_cast<uint16_t>(100 << (index % 6));
+    exif.focalLength = static_cast<uint32_t>(24 + index % 176);
+    exif.motorola = index % 2 != 0;
+
+    std::vector<uint8_t> jpeg = ExifBuilder::buildJpegHeader(ExifBuilder::buildTiff(exif));
+    jpeg.push_back(0xFF);
+    jpeg.push_back(0xD9);
+    return jpeg;
+}
+
+// The first 'headerSize' bytes of each JPEG in 'directory' (the EXIF
+// segment is at the start of the file)
+std::vector<std::vector<uint8_t>> readJPEGHeaders(const std::string& directory, size_t headerSize) {
+    std::vector<std::vector<uint8_t>> headers;
+    std::error_code ec;
+    for (const auto& entry : std::filesystem::directory_iterator(directory, ec)) {
+        std::string extension = entry.path().extension().string();
+        for (char& c : extension) c = static_cast<char>(std::tolower(static_cast<unsigned char>(c)));
+        if (extension != ".jpg" && extension != ".jpeg") {
+            continue;
+        }
+        std::ifstream in(entry.path(), std::ios::binary);
+        std::vector<uint8_t> header(headerSize);
+        in.read(reinterpret_cast<char*>(header.data()), static_cast<std::streamsize>(header.size()));
+        header.resize(static_cast<size_t>(in.gcount()));
+        if (!header.empty()) {
+            headers.push_back(std::move(header));
+        }
+    }
+    return headers;
+}
+
+// The EXIF segment of a JPEG header, as EXIFSegmentReader returns it
+std::vector<uint8_t> extractEXIFSegment(const std::vector<uint8_t>& jpeg) {
+    for (size_t offset = 2; offset + 4 <= jpeg.size(); ) {
+        if (jpeg[offset] != 0xFF) break;
+        size_t length = (static_cast<size_t>(jpeg[offset + 2]) << 8) | jpeg[offset + 3];
+        if (jpeg[offset + 1] == 0xE1 && offset + 2 + length <= jpeg.size() && length >= 8 &&
+            std::memcmp(&jpeg[offset + 4], "Exif\0\0", 6) == 0) {
+            return std::vector<uint8_t>(jpeg.begin() + offset + 4, jpeg.begin() + offset + 2 + length);
+        }
+        offset += 2 + length;
+    }
+    return {};
+}
+
+std::string makePhotoPath(const std::string& directory, size_t index) {
+    return (std::filesystem::path(directory) / ("IMG_" + std::to_string(index) + ".JPG")).string();
+}
+
+std::unique_ptr<PhotoFileHandler> makePhoto(size_t index, bool withEXIF,
+                                            const std::string& directory = "/benchmark/source") {
+    ScanCacheEntry entry;
+    entry.filePath = makePhotoPath(directory, index);
+    entry.fileSize = 4000000 + (index % 97) * 1024;
+    entry.exifFingerprint = 0x9E3779B97F4A7C15ULL * (index + 1);
+    entry.containsEXIFData = withEXIF;
+    if (withEXIF) {
+        entry.dateTimeOriginal = makeDateTime(index);
+        entry.cameraMake = CameraMakes[index % 5];
+        entry.cameraModel = CameraModels[index % 5];
+        entry.lensModel = LensModels[index % 5];
+    }
+    auto photo = std::make_unique<PhotoFileHandler>(entry.filePath);
+    photo->restoreFromScanCache(entry);
+    return photo;
+}
+
+void benchmarkEXIFParsing(BenchmarkHarness& harness, const std::string& jpegDirectory) {
+    std::vector<std::vector<uint8_t>> jpegs;
+    if (!jpegDirectory.empty()) {
+        jpegs = readJPEGHeaders(jpegDirectory, 128 * 1024);
+        if (jpegs.empty()) {
+            std::cerr << "No JPEGs in " << jpegDirectory << ", using generated headers" << std::endl;
+        }
+    }
+    if (jpegs.empty()) {
+        for (size_t i = 0; i < 64; ++i) {
+            jpegs.push_back(makeJPEGHeader(i));
+        }
+    }
+    std::vector<std::vector<uint8_t>> segments;
+    for (const auto& jpeg : jpegs) {
+        std::vector<uint8_t> segment = extractEXIFSegment(jpeg);
+        if (!segment.empty()) segments.push_back(std::move(segment));
+    }
+
+    harness.run("EXIFInfo::parseFrom", jpegs.size(), [&]() {
+        for (const auto& jpeg : jpegs) {
+            easyexif::EXIFInfo info;
+            int code = info.parseFrom(jpeg.data(), static_cast<unsigned>(jpeg.size()));
+            doNotOptimize(code);
+        }
+    });
+    if (segments.empty()) {
+        return;
+    }
+    harness.run("EXIFInfo::parseFromEXIFSegment", segments.size(), [&]() {
+        for (const auto& segment : segments) {
+            easyexif::EXIFInfo info;
+            int code = info.parseFromEXIFSegment(segment.data(), static_cast<unsigned>(segment.size()));
+            doNotOptimize(code);
+        }
+    });
+    // The scan's path: only the tags used for sorting
+    easyexif::EXIFView view;
+    uint32_t scanTags = easyexif::EXIFView::FingerprintTags | easyexif::EXIFView::TagLensModel |
+                        easyexif::EXIFView::TagOffsetTimeOriginal;
+    harness.run("EXIFView::parseFromEXIFSegment", segments.size(), [&]() {
+        for (const auto& segment : segments) {
+            int code = view.parseFromEXIFSegment(segment.data(), static_cast<unsigned>(segment.size()), scanTags);
+            uint64_t fingerprint = view.fingerprint();
+            doNotOptimize(code);
+            doNotOptimize(fingerprint);
+        }
+    });
+}
+
+void benchmarkDateParsing(BenchmarkHarness& harness) {
+    std::vector<std::string> dateTimes, offsets;
+    for (size_t i = 0; i < 1024; ++i) {
+        dateTimes.push_back(i % 64 == 63 ? "0000:00:00 00:00:00" : makeDateTime(i)); // Some cameras write zeros
+        offsets.push_back(i % 3 == 0 ? "" : (i % 3 == 1 ? "+09:00" : "-07:00"));
+    }
+    PhotoFileHandler handler("/benchmark/source/IMG_0001.JPG");
+    harness.run("PhotoFileHandler::parseDateTime", dateTimes.size(), [&]() {
+        for (size_t i = 0; i < dateTimes.size(); ++i) {
+            BenchmarkAccess::parseDateTime(handler, dateTimes[i], offsets[i]);
+            doNotOptimize(handler.validCreationDataInEXIF);
+        }
+    });
+}
+
+void benchmarkPathGeneration(BenchmarkHarness& harness) {
+    std::vector<std::unique_ptr<PhotoFileHandler>> photos;
+    for (size_t i = 0; i < 1024; ++i) {
+        photos.push_back(makePhoto(i, true));
+    }
+    AppConfig& config = AppConfig::get();
+    config.setOutputDirectory("/benchmark/output");
+    const std::pair<const char*, std::string> folderStructures[] = {
+        {"legacy", "Year, Month, Camera Model"},
+        {"pattern", "{Year}/{Year}-{Month:2}-{Day:2}/{Make} {Model}"}
+    };
+    for (const auto& folderStructure : folderStructures) {
+        std::string structure = folderStructure.second;
+        config.setPhotosOutputFolderStructureSelection(structure);
+        TransferManager transferManager;
+        BenchmarkAccess::compilePathTemplates(transferManager);
+        harness.run(std::string("TransferManager::generateDirectoryPath/") + folderStructure.first, photos.size(),
+                    [&]() {
+            for (const auto& photo : photos) {
+                const std::string& path = BenchmarkAccess::generateDirectoryPath(transferManager, photo.get());
+                doNotOptimize(path);
+            }
+        });
+    }
+}
+
+// Every name is already in the target directory and asked for ten times,
+// as when a card is imported again with "Add 'Copy##'" duplicates
+void benchmarkCopyNames(BenchmarkHarness& harness, const std::string& targetDirectory) {
+    for (size_t count : InputSizes) {
+        std::vector<std::string> fileNames;
+        for (size_t i = 0; i < count; ++i) {
+            fileNames.push_back("IMG_" + std::to_string(i % (count / 10)) + ".JPG");
+        }
+        std::unique_ptr<TransferManager> transferManager;
+        harness.runWithSetup("TransferManager::createNumericalFileName/" + std::to_string(count), count,
+            [&]() {
+                transferManager = std::make_unique<TransferManager>();
+                TargetDirectoryIndex& index = BenchmarkAccess::getTargetDirectoryIndex(*transferManager, targetDirectory);
+                for (size_t i = 0; i < count / 10; ++i) {
+                    index.reserveFileName(fileNames[i]);
+                }
+            },
+            [&]() {
+                for (const std::string& fileName : fileNames) {
+                    std::string copyName = BenchmarkAccess::createNumericalFileName(*transferManager, fileName,
+                                                                                    targetDirectory);
+                    doNotOptimize(copyName);
+                }
+            });
+    }
+}
+
+// One photo in a hundred duplicates another; contents hashes are set up
+// front, as duplicate detection would have computed them
+void benchmarkDuplicateDetection(BenchmarkHarness& harness, const std::string& sourceDirectory) {
+    auto originalOf = [](size_t index) { return index % 100 == 99 ? index - 50 : index; };
+    for (size_t i = 99; i < InputSizes[2]; i += 100) {
+        std::ofstream(makePhotoPath(sourceDirectory, originalOf(i)));
+    }
+    for (size_t count : InputSizes) {
+        DirectoryTransfer directoryTransfer;
+        harness.runWithSetup("DirectoryTransfer::getAllPhotoEXIFDuplicates/" + std::to_string(count), count,
+            [&]() {
+                directoryTransfer.clear();
+                directoryTransfer.setTargetDirectory("/benchmark/output/missing");
+                for (size_t i = 0; i < count; ++i) {
+                    size_t original = originalOf(i);
+                    std::unique_ptr<PhotoFileHandler> photo = makePhoto(original, false, sourceDirectory);
+                    photo->setContentHash(0xC2B2AE3D27D4EB4FULL * (original + 1));
+                    directoryTransfer.addPhotoFileToTransfer(photo);
+                }
+            },
+            [&]() {
+                std::vector<std::unique_ptr<PhotoFileHandler>> duplicates = directoryTransfer.getAllPhotoEXIFDuplicates();
+                doNotOptimize(duplicates);
+            });
+    }
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication application(argc, argv);
+    BenchmarkHarness harness;
+    std::string jpegDirectory, jsonPath;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--filter" && hasValue) {
+            harness.setFilter(argv[++i]);
+        } else if (argument == "--min-time" && hasValue) {
+            harness.setMinimumTime(std::chrono::milliseconds(std::atoi(argv[++i])));
+        } else if (argument == "--jpeg-dir" && hasValue) {
+            jpegDirectory = argv[++i];
+        } else if (argument == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else {
+            std::cerr << "Usage: " << argv[0]
+                      << " [--filter <text>] [--min-time <ms>] [--jpeg-dir <directory>] [--json <file>]" << std::endl;
+            return 2;
+        }
+    }
+
+    // An empty target directory, so its index starts out empty, and the
+    // sources of the duplicates
+    std::filesystem::path workDirectory = std::filesystem::temp_directory_path() /
+        ("metamover-benchmark-" + std::to_string(QCoreApplication::applicationPid()));
+    std::filesystem::path targetDirectory = workDirectory / "target";
+    std::filesystem::path sourceDirectory = workDirectory / "source";
+    std::filesystem::create_directories(targetDirectory);
+    std::filesystem::create_directories(sourceDirectory);
+
+    harness.printHeader();
+    benchmarkEXIFParsing(harness, jpegDirectory);
+    benchmarkDateParsing(harness);
+    benchmarkPathGeneration(harness);
+    benchmarkCopyNames(harness, targetDirectory.string());
+    benchmarkDuplicateDetection(harness, sourceDirectory.string());
+
+    std::error_code ec;
+    std::filesystem::remove_all(workDirectory, ec);
+    if (!jsonPath.empty() && !harness.writeJson(jsonPath)) {
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,393 @@
+/***********************************************************************
+ * File Name: throughputbenchmark.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: MetaMoverThroughputBenchmark, an end-to-end benchmark of a
+ *              photo tree going through Scanner::scan and
+ *              TransferManager::processPhotoFiles without the GUI, the way
+ *              a batch run drives them. The phases are:
+ *                scan        the source, with an empty scan cache
+ *                rescan      the source again, from the scan cache
+ *                copy        the source into <work-dir>/copied
+ *                scanCopied  the copies
+ *                move        the copies into <work-dir>/moved
+ *              Each phase's wall time, files/s and MB/s and the peak RSS
+ *              are printed and written to --json. Given a --baseline (a
+ *              results file of an earlier run, optionally with a
+ *              "tolerance"), every metric the baseline holds is compared
+ *              and the exit code is 1 if one is worse by more than the
+ *              tolerance: rates (*PerSecond) and ratios (*Speedup) may not
+ *              drop and times and memory may not grow. --baseline may be
+ *              given more than once, e.g. for the machine-independent
+ *              metrics and for the rates measured on this machine. The
+ *              tree is usually written by MetaMoverCorpusGenerator.
+ *              --trace writes a Chrome trace of the run, with a span per
+ *              phase.
+ *              Usage: MetaMoverThroughputBenchmark --source <directory>
+ *                     [--work-dir <directory>] [--json <file>]
+ *                     [--baseline <file>] [--tolerance <fraction>]
+ *                     [--duplicate-identity filename|exif]
+ *                     [--scan-threads <count>] [--transfers-per-device <count>]
+ *                     [--keep] [--log] [--trace <file>]
+ * License: MIT License
+ ***********************************************************************/
+
+#include <QCoreApplication>
+#include <QFile>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <map>
+#include <streambuf>
+#include <string>
+#include <vector>
+#include "appconfig.h"
+#include "appconfigmanager.h"
+#include "scanner.h"
+#include "tracer.h"
+#include "transfermanager.h"
+
+#if defined(_WIN32)
+#include <windows.h>
+#include <psapi.h>
+#else
+#include <sys/resource.h>
+#endif
+
+namespace {
+
+const double DefaultTolerance = 0.25;
+
+struct PhaseResult {
+    std::string name;
+    double seconds = 0;
+    uint64_t files = 0;
+    uint64_t bytes = 0;        // Transferred; 0 for scans
+    uint64_t filesFailed = 0;
+    bool transfer = false;
+};
+
+// Throws away what the scan and transfer code logs per file, after it has
+// been formatted, so the logging still costs what it does in a batch run
+class DiscardBuffer : public std::streambuf
+{
+protected:
+    int overflow(int c) override { return c == traits_type::eof() ? 0 : c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+uint64_t getPeakResidentBytes() {
+#if defined(_WIN32)
+    PROCESS_MEMORY_COUNTERS counters;
+    if (GetProcessMemoryInfo(GetCurrentProcess(), &counters, sizeof(counters))) {
+        return counters.PeakWorkingSetSize;
+    }
+    return 0;
+#else
+    struct rusage usage;
+    if (getrusage(RUSAGE_SELF, &usage) != 0) {
+        return 0;
+    }
+#if defined(__APPLE__)
+    return static_cast<uint64_t>(usage.ru_maxrss);        // Bytes
+#else
+    return static_cast<uint64_t>(usage.ru_maxrss) * 1024; // Kilobytes
+#endif
+#endif
+}
+
+double secondsSince(std::chrono::steady_clock::time_point start) {
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+PhaseResult runScan(const std::string& name, Scanner& scanner, const std::filesystem::path& directory) {
+    TraceSpan span("ThroughputBenchmark::runScan", "benchmark", name);
+    PhaseResult result;
+    result.name = name;
+    auto start = std::chrono::steady_clock::now();
+    scanner.scan(directory.string(), true);
+    result.seconds = secondsSince(start);
+    // Photos read, with usable metadata or not
+    result.files = scanner.getPhotoFileHandlers().size() + scanner.getInvalidPhotoFileHandlers().size();
+    return result;
+}
+
+// Transfers what 'scanner' found last into 'outputDirectory'
+PhaseResult runTransfer(const std::string& name, Scanner& scanner, TransferManager& transferManager,
+                        const std::filesystem::path& outputDirectory, bool moveFiles) {
+    TraceSpan span("ThroughputBenchmark::runTransfer", "benchmark", name);
+    AppConfig& config = AppConfig::get();
+    config.setOutputDirectory(outputDirectory.string());
+    config.setInvalidFileMetaDirectory((outputDirectory / "Invalid").string());
+
+    PhaseResult result;
+    result.name = name;
+    result.transfer = true;
+    auto start = std::chrono::steady_clock::now();
+    transferManager.processPhotoFiles(&scanner.getPhotoFileHandlers(), &scanner.getInvalidPhotoFileHandlers(),
+                                      moveFiles);
+    result.seconds = secondsSince(start);
+    TransferMetricsSnapshot metrics = transferManager.getTransferMetrics();
+    result.files = metrics.filesCompleted - metrics.filesFailed;
+    result.filesFailed = metrics.filesFailed;
+    result.bytes = metrics.bytesCompleted;
+    return result;
+}
+
+// Metric name to value, the names used by the results and baseline files
+std::map<std::string, double> collectMetrics(const std::vector<PhaseResult>& phases, uint64_t peakResidentBytes) {
+    std::map<std::string, double> metrics;
+    for (const PhaseResult& phase : phases) {
+        double seconds = phase.seconds > 0 ? phase.seconds : 1e-9;
+        metrics[phase.name + ".seconds"] = phase.seconds;
+        metrics[phase.name + ".filesPerSecond"] = phase.files / seconds;
+        if (phase.transfer) {
+            metrics[phase.name + ".megabytesPerSecond"] = phase.bytes / (1024.0 * 1024.0) / seconds;
+        }
+    }
+    // How much the scan cache saves, which holds on any machine
+    if (metrics.count("scan.filesPerSecond") && metrics.count("rescan.filesPerSecond") &&
+        metrics["scan.filesPerSecond"] > 0) {
+        metrics["rescanSpeedup"] = metrics["rescan.filesPerSecond"] / metrics["scan.filesPerSecond"];
+    }
+    metrics["peakRssMegabytes"] = peakResidentBytes / (1024.0 * 1024.0);
+    return metrics;
+}
+
+void printPhases(const std::vector<PhaseResult>& phases, uint64_t peakResidentBytes) {
+    std::printf("%-12s %10s %10s %12s %10s %8s\n", "phase", "seconds", "files", "files/s", "MB/s", "failed");
+    for (const PhaseResult& phase : phases) {
+        double seconds = phase.seconds > 0 ? phase.seconds : 1e-9;
+        std::printf("%-12s %10.3f %10llu %12.1f ", phase.name.c_str(), phase.seconds,
+                    static_cast<unsigned long long>(phase.files), phase.files / seconds);
+        if (phase.transfer) {
+            std::printf("%10.1f %8llu\n", phase.bytes / (1024.0 * 1024.0) / seconds,
+                        static_cast<unsigned long long>(phase.filesFailed));
+        } else {
+            std::printf("%10s %8s\n", "-", "-");
+        }
+    }
+    std::printf("peak RSS: %.1f MB\n", peakResidentBytes / (1024.0 * 1024.0));
+    std::fflush(stdout);
+}
+
+std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') quoted += '\\';
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+bool writeJson(const std::string& filePath, const std::vector<PhaseResult>& phases, uint64_t peakResidentBytes,
+               const std::map<std::string, double>& metrics) {
+    std::ofstream out(filePath, std::ios::trunc);
+    out << std::setprecision(10);
+    out << "{\n  \"phases\": [\n";
+    for (size_t i = 0; i < phases.size(); ++i) {
+        const PhaseResult& phase = phases[i];
+        out << "    {\"name\":" << jsonString(phase.name)
+            << ",\"seconds\":" << phase.seconds
+            << ",\"files\":" << phase.files
+            << ",\"bytes\":" << phase.bytes
+            << ",\"filesFailed\":" << phase.filesFailed << "}"
+            << (i + 1 < phases.size() ? ",\n" : "\n");
+    }
+    out << "  ],\n  \"peakRssBytes\": " << peakResidentBytes << ",\n  \"metrics\": {\n";
+    size_t written = 0;
+    for (const auto& [name, value] : metrics) {
+        out << "    " << jsonString(name) << ": " << value << (++written < metrics.size() ? ",\n" : "\n");
+    }
+    out << "  }\n}\n";
+    out.close();
+    if (out.fail()) {
+        std::cerr << "Unable to write benchmark results to: " << filePath << std::endl;
+        return false;
+    }
+    return true;
+}
+
+// Returns false if a metric regressed past the tolerance, or the baseline
+// cannot be read
+bool compareWithBaseline(const std::string& baselinePath, const std::map<std::string, double>& metrics,
+                         double toleranceOverride) {
+    QFile file(QString::fromStdString(baselinePath));
+    if (!file.open(QIODevice::ReadOnly)) {
+        std::cerr << "Unable to open baseline: " << baselinePath << std::endl;
+        return false;
+    }
+    QJsonParseError parseError;
+    QJsonDocument document = QJsonDocument::fromJson(file.readAll(), &parseError);
+    if (document.isNull() || !document.isObject()) {
+        std::cerr << "Unable to parse baseline " << baselinePath << ": "
+                  << parseError.errorString().toStdString() << std::endl;
+        return false;
+    }
+    QJsonObject baseline = document.object();
+    double tolerance = toleranceOverride >= 0 ? toleranceOverride
+                                              : baseline.value("tolerance").toDouble(DefaultTolerance);
+    QJsonObject baselineMetrics = baseline.value("metrics").toObject();
+
+    bool passed = true;
+    std::printf("\n%s\n%-28s %14s %14s %9s\n", baselinePath.c_str(), "metric", "baseline", "current", "change");
+    for (auto it = baselineMetrics.begin(); it != baselineMetrics.end(); ++it) {
+        std::string name = it.key().toStdString();
+        double expected = it.value().toDouble();
+        auto current = metrics.find(name);
+        if (current == metrics.end()) {
+            std::printf("%-28s %14.2f %14s %9s  (not measured)\n", name.c_str(), expected, "-", "-");
+            continue;
+        }
+        auto endsWith = [&name](const std::string& suffix) {
+            return name.size() >= suffix.size() &&
+                   name.compare(name.size() - suffix.size(), suffix.size(), suffix) == 0;
+        };
+        bool higherIsBetter = endsWith("PerSecond") || endsWith("Speedup");
+        bool regressed = higherIsBetter ? current->second < expected * (1 - tolerance)
+                                        : current->second > expected * (1 + tolerance);
+        double change = expected != 0 ? (current->second / expected - 1) * 100 : 0;
+        std::printf("%-28s %14.2f %14.2f %+8.1f%%%s\n", name.c_str(), expected, current->second, change,
+                    regressed ? "  REGRESSION" : "");
+        passed = passed && !regressed;
+    }
+    std::printf("tolerance: %.0f%%, %s\n", tolerance * 100, passed ? "passed" : "FAILED");
+    std::fflush(stdout);
+    return passed;
+}
+
+}
+
+int main(int argc, char* argv[]) {
+    QCoreApplication application(argc, argv);
+    std::filesystem::path sourceDirectory, workDirectory;
+    std::string jsonPath, tracePath, duplicateIdentity = "File Names Match";
+    std::vector<std::string> baselinePaths;
+    double tolerance = -1; // From the baseline
+    int scanThreads = -1, transfersPerDevice = -1;
+    bool keepOutput = false, keepLog = false;
+    for (int i = 1; i < argc; ++i) {
+        std::string argument = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (argument == "--keep") {
+            keepOutput = true;
+        } else if (argument == "--log") {
+            keepLog = true;
+        } else if (argument == "--source" && hasValue) {
+            sourceDirectory = argv[++i];
+        } else if (argument == "--work-dir" && hasValue) {
+            workDirectory = argv[++i];
+        } else if (argument == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (argument == "--trace" && hasValue) {
+            tracePath = argv[++i];
+        } else if (argument == "--baseline" && hasValue) {
+            baselinePaths.push_back(argv[++i]);
+        } else if (argument == "--tolerance" && hasValue) {
+            tolerance = std::atof(argv[++i]);
+        } else if (argument == "--duplicate-identity" && hasValue) {
+            std::string mode = argv[++i];
+            duplicateIdentity = mode == "exif" ? "All EXIF and Exact File Contents Match" : "File Names Match";
+        } else if (argument == "--scan-threads" && hasValue) {
+            scanThreads = std::atoi(argv[++i]);
+        } else if (argument == "--transfers-per-device" && hasValue) {
+            transfersPerDevice = std::atoi(argv[++i]);
+        } else {
+            sourceDirectory.clear();
+            break;
+        }
+    }
+    if (sourceDirectory.empty() || !std::filesystem::is_directory(sourceDirectory)) {
+        std::cerr << "Usage: " << argv[0] << " --source <directory> [--work-dir <directory>] [--json <file>]\n"
+                  << "       [--baseline <file>] [--tolerance <fraction>] [--duplicate-identity filename|exif]\n"
+                  << "       [--scan-threads <count>] [--transfers-per-device <count>] [--keep] [--log]\n"
+                  << "       [--trace <file>]"
+                  << std::endl;
+        return 2;
+    }
+    bool temporaryWorkDirectory = workDirectory.empty();
+    if (temporaryWorkDirectory) {
+        workDirectory = std::filesystem::temp_directory_path() /
+            ("metamover-throughput-" + std::to_string(QCoreApplication::applicationPid()));
+    }
+    std::filesystem::path copiedDirectory = workDirectory / "copied";
+    std::filesystem::path movedDirectory = workDirectory / "moved";
+    std::error_code ec;
+    std::filesystem::remove_all(copiedDirectory, ec);
+    std::filesystem::remove_all(movedDirectory, ec);
+    std::filesystem::create_directories(copiedDirectory);
+    std::filesystem::create_directories(movedDirectory);
+    // The first scan starts cold
+    std::filesystem::remove(AppConfigManager::getDefaultScanCachePath(), ec);
+
+    // The settings a batch run starts from
+    AppConfig& config = AppConfig::get();
+    config.setSourceDirectory(sourceDirectory.string());
+    config.setIncludeSubDirectories(true);
+    std::string duplicatesSelection = config.getDuplicatesFoundOptions().front();
+    std::string folderStructure = "Year, Month";
+    config.setDuplicatesFoundSelection(duplicatesSelection);
+    config.setPhotosOutputFolderStructureSelection(folderStructure);
+    config.setPhotosDuplicateIdentitySetting(duplicateIdentity);
+    config.setMoveInvalidFileMeta(true);
+    if (scanThreads >= 0) config.setScanWorkerThreadCount(scanThreads);
+    if (transfersPerDevice > 0) config.setTransfersPerDevice(transfersPerDevice);
+
+    DiscardBuffer discardBuffer;
+    std::streambuf* coutBuffer = std::cout.rdbuf(keepLog ? std::cerr.rdbuf() : &discardBuffer);
+
+    if (!tracePath.empty()) {
+        Tracer::start(tracePath);
+    }
+    Scanner scanner;
+    TransferManager transferManager;
+    std::vector<PhaseResult> phases;
+    phases.push_back(runScan("scan", scanner, sourceDirectory));
+    phases.push_back(runScan("rescan", scanner, sourceDirectory));
+    phases.push_back(runTransfer("copy", scanner, transferManager, copiedDirectory, false));
+    phases.push_back(runScan("scanCopied", scanner, copiedDirectory));
+    phases.push_back(runTransfer("move", scanner, transferManager, movedDirectory, true));
+    uint64_t peakResidentBytes = getPeakResidentBytes();
+
+    std::cout.rdbuf(coutBuffer);
+    bool traceWritten = tracePath.empty() || Tracer::finish();
+    if (!keepOutput) {
+        std::filesystem::remove_all(copiedDirectory, ec);
+        std::filesystem::remove_all(movedDirectory, ec);
+        if (temporaryWorkDirectory) {
+            std::filesystem::remove(workDirectory, ec);
+        }
+    }
+
+    printPhases(phases, peakResidentBytes);
+    std::map<std::string, double> metrics = collectMetrics(phases, peakResidentBytes);
+    int exitCode = 0;
+    for (const PhaseResult& phase : phases) {
+        if (phase.filesFailed > 0) {
+            std::cerr << phase.filesFailed << " files failed in the " << phase.name << " phase" << std::endl;
+            exitCode = 1;
+        }
+    }
+    if (phases.front().files == 0) {
+        std::cerr << "No files found in " << sourceDirectory.string() << std::endl;
+        exitCode = 1;
+    }
+    if (!traceWritten) {
+        exitCode = 1;
+    }
+    if (!jsonPath.empty() && !writeJson(jsonPath, phases, peakResidentBytes, metrics)) {
+        exitCode = 1;
+    }
+    for (const std::string& baselinePath : baselinePaths) {
+        if (!compareWithBaseline(baselinePath, metrics, tolerance)) {
+            exitCode = 1;
+        }
+    }
+    return exitCode;
+}
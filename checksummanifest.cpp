@@ -0,0 +1,172 @@
+/***********************************************************************
+ * File Name: checksummanifest.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the ChecksumManifest class. Hashes are
+ *              collected while files are copied and each manifest is
+ *              rewritten once at the end of the transfer, to a synced
+ *              temporary file that replaces it, so a manifest is never left
+ *              half written, even by a power loss.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstdio>
+#include <fstream>
+#include <iostream>
+#include "checksummanifest.h"
+#include "filecopier.h"
+
+namespace {
+
+bool parseLine(const std::string& line, std::string& fileName, uint64_t& hash) {
+    // "<hash>  <name>" (or "<hash> *<name>", binary mode in some tools)
+    if (line.size() < 19 || line[16] != ' ' || (line[17] != ' ' && line[17] != '*')) {
+        return false;
+    }
+    hash = 0;
+    for (size_t i = 0; i < 16; ++i) {
+        char c = line[i];
+        unsigned digit;
+        if (c >= '0' && c <= '9') digit = static_cast<unsigned>(c - '0');
+        else if (c >= 'a' && c <= 'f') digit = static_cast<unsigned>(c - 'a' + 10);
+        else if (c >= 'A' && c <= 'F') digit = static_cast<unsigned>(c - 'A' + 10);
+        else return false;
+        hash = (hash << 4) | digit;
+    }
+    fileName = line.substr(18);
+    if (!fileName.empty() && fileName.back() == '\r') {
+        fileName.pop_back();
+    }
+    return !fileName.empty();
+}
+
+std::string formatLine(const std::string& fileName, uint64_t hash) {
+    char digits[17];
+    std::snprintf(digits, sizeof(digits), "%016llx", static_cast<unsigned long long>(hash));
+    return std::string(digits) + "  " + fileName;
+}
+
+}
+
+void ChecksumManifest::add(const std::filesystem::path& filePath, uint64_t hash) {
+    std::string fileName = filePath.filename().string();
+    // xxhsum escapes these; such files are simply not listed
+    if (fileName.find_first_of("\n\r\\") != std::string::npos) {
+        return;
+    }
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingUpdates[filePath.parent_path().string()].push_back({std::move(fileName), hash, false});
+}
+
+void ChecksumManifest::remove(const std::filesystem::path& filePath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingUpdates[filePath.parent_path().string()].push_back({filePath.filename().string(), 0, true});
+}
+
+bool ChecksumManifest::save() {
+    std::lock_guard<std::mutex> lock(mutex);
+    bool saved = true;
+    for (const auto& directory : pendingUpdates) {
+        if (!saveDirectory(directory.first, directory.second)) {
+            std::cerr << "Unable to write the checksum manifest in: " << directory.first << std::endl;
+            saved = false;
+        }
+    }
+    pendingUpdates.clear();
+    return saved;
+}
+
+void ChecksumManifest::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    pendingUpdates.clear();
+}
+
+bool ChecksumManifest::saveDirectory(const std::string& directory, const std::vector<PendingUpdate>& updates) {
+    std::filesystem::path manifestPath = std::filesystem::path(directory) / fileName;
+    std::vector<std::string> lines;
+    std::unordered_map<std::string, size_t> lineIndices; // File name -> line
+    std::error_code ec;
+    std::filesystem::file_time_type writtenTime = std::filesystem::last_write_time(manifestPath, ec);
+    bool manifestExisted = !ec;
+    std::ifstream existing(manifestPath);
+    std::string line, listedName;
+    uint64_t listedHash;
+    while (std::getline(existing, line)) {
+        if (parseLine(line, listedName, listedHash)) {
+            // Files removed or changed since the last write are dropped, so
+            // every line stays true as of the manifest's modified time
+            std::filesystem::file_time_type modifiedTime =
+                std::filesystem::last_write_time(std::filesystem::path(directory) / listedName, ec);
+            if (ec || modifiedTime > writtenTime) {
+                continue;
+            }
+            lineIndices[listedName] = lines.size();
+        }
+        lines.push_back(line);
+    }
+    existing.close();
+
+    for (const PendingUpdate& update : updates) {
+        auto found = lineIndices.find(update.fileName);
+        if (update.removed) {
+            if (found != lineIndices.end()) {
+                lines[found->second].clear(); // Not written
+                lineIndices.erase(found);
+            }
+        } else if (found != lineIndices.end()) {
+            lines[found->second] = formatLine(update.fileName, update.hash); // Overwritten file
+        } else {
+            lineIndices.emplace(update.fileName, lines.size());
+            lines.push_back(formatLine(update.fileName, update.hash));
+        }
+    }
+    // Only removals, and nothing to remove them from
+    if (!manifestExisted && lineIndices.empty()) {
+        return true;
+    }
+
+    std::filesystem::path temporaryPath = manifestPath;
+    temporaryPath += ".tmp";
+    std::ofstream out(temporaryPath, std::ios::trunc);
+    for (const std::string& manifestLine : lines) {
+        if (!manifestLine.empty()) {
+            out << manifestLine << '\n';
+        }
+    }
+    out.close();
+    // Synced before and after the rename, like the transfer journal, so a
+    // power loss leaves the old manifest or the new one
+    if (out.fail() || !FileCopier::syncFile(temporaryPath, ec)) {
+        std::filesystem::remove(temporaryPath, ec);
+        return false;
+    }
+    std::filesystem::rename(temporaryPath, manifestPath, ec);
+    if (ec) {
+        std::filesystem::remove(temporaryPath, ec);
+        return false;
+    }
+    return FileCopier::syncDirectory(directory, ec);
+}
+
+bool ChecksumManifest::load(const std::filesystem::path& directory, std::unordered_map<std::string, uint64_t>& hashes) {
+    std::filesystem::path manifestPath = directory / fileName;
+    std::error_code ec;
+    std::filesystem::file_time_type writtenTime = std::filesystem::last_write_time(manifestPath, ec);
+    std::ifstream in(manifestPath);
+    if (ec || !in) {
+        return false;
+    }
+    std::string line, listedName;
+    uint64_t listedHash;
+    while (std::getline(in, line)) {
+        if (!parseLine(line, listedName, listedHash)) {
+            continue;
+        }
+        // A file replaced since its hash was listed must be read again
+        std::filesystem::file_time_type modifiedTime = std::filesystem::last_write_time(directory / listedName, ec);
+        if (!ec && modifiedTime <= writtenTime) {
+            hashes[listedName] = listedHash;
+        }
+    }
+    return true;
+}
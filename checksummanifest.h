@@ -0,0 +1,68 @@
+#ifndef CHECKSUMMANIFEST_H
+#define CHECKSUMMANIFEST_H
+
+/***********************************************************************
+ * File Name: checksummanifest.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the ChecksumManifest class, which keeps a
+ *              "checksums.xxh64" file in each target directory listing the
+ *              XXH64 hash of every file copied there. Lines are written as
+ *              "<16 hex digits>  <file name>", the format of "xxhsum", so a
+ *              directory can be audited with "xxhsum -c checksums.xxh64".
+ *              Duplicate detection reads the manifest back, so photos already
+ *              in a target directory are not read again to compare contents.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstdint>
+#include <filesystem>
+#include <map>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+class ChecksumManifest
+{
+public:
+    ChecksumManifest() = default;
+    ChecksumManifest(const ChecksumManifest&) = delete;
+    ChecksumManifest& operator=(const ChecksumManifest&) = delete;
+
+    // Records the hash of the file at 'filePath' for its directory's
+    // manifest. Safe to call from several threads.
+    void add(const std::filesystem::path& filePath, uint64_t hash);
+    // Drops the line of the file at 'filePath' from its directory's manifest
+    // when it is saved, for a file put there without being hashed. Safe to
+    // call from several threads.
+    void remove(const std::filesystem::path& filePath);
+    // Writes the recorded hashes into the manifests, replacing the lines of
+    // files listed before, drops the removed files' lines and forgets both.
+    // Returns false if a manifest could not be written.
+    bool save();
+    void clear();
+
+    // Reads the hashes in 'directory's manifest, by file name. Files
+    // modified after the manifest was written are left out. Returns false if
+    // the directory has no manifest.
+    static bool load(const std::filesystem::path& directory, std::unordered_map<std::string, uint64_t>& hashes);
+
+    static constexpr const char* fileName = "checksums.xxh64";
+
+private:
+    // A file to list with its hash, or to drop from the manifest
+    struct PendingUpdate {
+        std::string fileName;
+        uint64_t hash = 0;
+        bool removed = false;
+    };
+
+    static bool saveDirectory(const std::string& directory, const std::vector<PendingUpdate>& updates);
+
+    std::mutex mutex;
+    std::map<std::string, std::vector<PendingUpdate>> pendingUpdates; // Directory -> files, in order
+};
+
+#endif // CHECKSUMMANIFEST_H
@@ -0,0 +1,43 @@
+#ifndef CONTENTHASHER_H
+#define CONTENTHASHER_H
+
+/***********************************************************************
+ * File Name: contenthasher.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the ContentHasher class, a streaming 64-bit
+ *              non-cryptographic hash of file contents (the XXH64 algorithm).
+ *              Data is consumed in 32-byte stripes across four independent
+ *              accumulator lanes, which keeps the hash well above disk speed.
+ *              It is used to confirm that two files flagged as duplicates
+ *              really hold the same bytes.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+class ContentHasher
+{
+public:
+    ContentHasher(uint64_t seed = 0);
+    void reset(uint64_t seed = 0);
+    void update(const void* data, size_t length);
+    uint64_t digest() const;
+
+    // Hashes a whole file, reading it in fixed size chunks. Returns false if
+    // the file could not be read.
+    static bool hashFile(const std::string& filePath, uint64_t& hash);
+
+    static constexpr size_t fileChunkSize = 1 << 20; // 1 MiB
+
+private:
+    uint64_t lanes[4];
+    uint64_t seed;
+    uint64_t totalLength;
+    unsigned char stripe[32];
+    size_t stripeLength;
+};
+
+#endif // CONTENTHASHER_H
@@ -14,17 +14,27 @@
  ***********************************************************************/
 
 
+#include <algorithm>
 #include <filesystem>
 #include <iostream>
+#include <unordered_map>
+#include <QtConcurrent>
 #include "directorytransfer.h"
 #include "scanner.h"
+#include "contenthasher.h"
+#include "tracer.h"
 
 DirectoryTransfer::DirectoryTransfer(const std::string inputTargetDirectory)
     : targetDirectory(inputTargetDirectory){
 }
 
+// Setting the same directory again writes nothing, so a streamed transfer
+// can route more files here while workers read the path
 void DirectoryTransfer::setTargetDirectory(std::string targetDirectory){
-    this->targetDirectory = targetDirectory;
+    if (this->targetDirectory != targetDirectory) {
+        targetDirectoryIndex.clear(); // Rebuilt for the new directory on next use
+        this->targetDirectory = targetDirectory;
+    }
 }
 
 void DirectoryTransfer::setPhotoFilesToTransfer(std::vector<std::unique_ptr<PhotoFileHandler>> &inputPhotoFiles){
@@ -78,45 +88,189 @@ bool DirectoryTransfer::transferFiles(bool move, bool replaceDashesWithUnderscor
     createDirectoryIfNotExists(targetDirectory);
     // commence copy or move of all files in the list:
     for (const auto& photoHandler : photoFilesToTransfer) {
-        // Construct the source and target paths
-        std::filesystem::path sourcePath(photoHandler->getSourceFilePath());
-        std::filesystem::path targetPath;
-        if(replaceDashesWithUnderscores){
-            std::string targetFilename = photoHandler->getTargetFileName();
-            std::replace(targetFilename.begin(), targetFilename.end(), '-', '_');
-            targetPath = std::filesystem::path(targetDirectory) / targetFilename;
-        }else{
-            targetPath = std::filesystem::path(targetDirectory) / photoHandler->getTargetFileName();
-        }
-
-        try {
-            if (move) {
-                if (photoHandler->overwriteEnabled || !std::filesystem::exists(targetPath)) {
-                    std::filesystem::rename(sourcePath, targetPath); // Move file
-                    std::cout << "Moved file: " << sourcePath << " to " << targetPath << std::endl; // Debug log
-                } else {
-                    std::cerr << "File already exists and overwrite is disabled: " << targetPath << std::endl;
-                }
-            } else {
-                if (photoHandler->overwriteEnabled) {
-                    std::filesystem::copy(sourcePath, targetPath, std::filesystem::copy_options::overwrite_existing); // Copy file with overwrite
-                } else {
-                    std::filesystem::copy(sourcePath, targetPath, std::filesystem::copy_options::skip_existing); // Copy file without overwrite
+        if (!transferFile(*photoHandler, move, replaceDashesWithUnderscores)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::filesystem::path DirectoryTransfer::getTargetPath(PhotoFileHandler& photoHandler,
+                                                       bool replaceDashesWithUnderscores) const {
+    if(replaceDashesWithUnderscores){
+        std::string targetFilename = photoHandler.getTargetFileName();
+        std::replace(targetFilename.begin(), targetFilename.end(), '-', '_');
+        return std::filesystem::path(targetDirectory) / targetFilename;
+    }
+    return std::filesystem::path(targetDirectory) / photoHandler.getTargetFileName();
+}
+
+// Transfers a single file. The target directory must already exist. Safe to
+// call for different files of this directory from several threads at once.
+bool DirectoryTransfer::transferFile(PhotoFileHandler& photoHandler, bool move, bool replaceDashesWithUnderscores,
+                                     const FileCopier::ProgressCallback& onBytesCopied, bool* skipped){
+    TraceSpan span("DirectoryTransfer::transferFile", "transfer");
+    if (span.isRecording()) {
+        span.setDetail(photoHandler.getSourceFilePath());
+    }
+    // Construct the source and target paths
+    std::filesystem::path sourcePath(photoHandler.getSourceFilePath());
+    std::filesystem::path targetPath = getTargetPath(photoHandler, replaceDashesWithUnderscores);
+    if (skipped) {
+        *skipped = false;
+    }
+
+    try {
+        if (!photoHandler.overwriteEnabled && std::filesystem::exists(targetPath)) {
+            std::cerr << "File already exists and overwrite is disabled: " << targetPath << std::endl;
+            if (skipped) {
+                *skipped = true;
+            }
+            return true;
+        }
+        if (move) {
+            std::error_code renameError;
+            std::filesystem::rename(sourcePath, targetPath, renameError); // Move file
+            if (!renameError) {
+                // The file keeps its modified time, so a line listed for an
+                // earlier file of the same name would still look current
+                if (transferOptions.checksumManifest) {
+                    transferOptions.checksumManifest->remove(targetPath);
                 }
-                std::cout << "Copied file: " << sourcePath << " to " << targetPath << std::endl; // Debug log
+                targetDirectoryIndex.addFile(targetPath.filename().string());
+                std::cout << "Moved file: " << sourcePath << " to " << targetPath << std::endl; // Debug log
+                return true;
             }
-        } catch (const std::filesystem::filesystem_error& e) {
-            std::cerr << "Filesystem error: " << e.what() << std::endl; // Log error
-            return false;
-        } catch (const std::exception& e) {
-            std::cerr << "Error: " << e.what() << std::endl; // Log error
-            return false;
+            // Card to disk moves always end up copying below
+            if (renameError != std::errc::cross_device_link) {
+                throw std::filesystem::filesystem_error("rename", sourcePath, targetPath, renameError);
+            }
+        }
+
+        FileCopier::CopyMethod copyMethod = copyIntoPlace(photoHandler, sourcePath, targetPath, move, onBytesCopied);
+        targetDirectoryIndex.addFile(targetPath.filename().string());
+        if (!move) {
+            std::cout << "Copied file (" << FileCopier::getCopyMethodName(copyMethod) << "): "
+                      << sourcePath << " to " << targetPath << std::endl; // Debug log
+            return true;
         }
+
+        // The copy is verified and on disk. The source goes once the new
+        // directory entry is durable too.
+        if (transferOptions.sourceRemover &&
+            transferOptions.sourceRemover->add(sourcePath.string(), targetPath.string())) {
+            std::cout << "Moved file (" << FileCopier::getCopyMethodName(copyMethod) << ", source queued for removal): "
+                      << sourcePath << " to " << targetPath << std::endl; // Debug log
+            return true;
+        }
+        std::error_code ec;
+        if (!FileCopier::syncDirectory(targetPath.parent_path(), ec)) {
+            throw std::filesystem::filesystem_error("fsync", targetPath.parent_path(), ec);
+        }
+        std::filesystem::remove(sourcePath);
+        std::cout << "Moved file (" << FileCopier::getCopyMethodName(copyMethod) << "): "
+                  << sourcePath << " to " << targetPath << std::endl; // Debug log
+    } catch (const std::filesystem::filesystem_error& e) {
+        std::cerr << "Filesystem error: " << e.what() << std::endl; // Log error
+        return false;
+    } catch (const std::exception& e) {
+        std::cerr << "Error: " << e.what() << std::endl; // Log error
+        return false;
     }
     return true;
 }
 
+std::filesystem::path DirectoryTransfer::getTemporaryPath(const std::filesystem::path& targetPath) {
+    return targetPath.parent_path() / ("." + targetPath.filename().string() + ".partial");
+}
+
+// Copies to a temporary name next to the target and renames it into place
+// once complete, so an interrupted transfer never leaves a partial file
+// under the real name. A copy is hashed as it is made when it is verified
+// (by default only those made for a move) or listed in a checksum manifest.
+// A copy made for a move is synced before the rename. Throws
+// std::filesystem::filesystem_error on failure.
+FileCopier::CopyMethod DirectoryTransfer::copyIntoPlace(PhotoFileHandler& photoHandler,
+                                                        const std::filesystem::path& sourcePath,
+                                                        const std::filesystem::path& targetPath, bool forMove,
+                                                        const FileCopier::ProgressCallback& onBytesCopied) {
+    TraceSpan span("DirectoryTransfer::copyIntoPlace", "copy");
+    std::filesystem::path temporaryPath = getTemporaryPath(targetPath);
+    std::error_code ec;
+    std::filesystem::remove(temporaryPath, ec); // Left behind by an interrupted transfer
+    bool verify = forMove ? transferOptions.verifyMoves : transferOptions.verifyCopies;
+    bool hashed = verify || transferOptions.checksumManifest;
+    ContentHasher hasher;
+    try {
+        FileCopier::CopyMethod copyMethod = FileCopier::copyFile(sourcePath, temporaryPath, false, onBytesCopied,
+                                                                 hashed ? &hasher : nullptr);
+        if (copyMethod == FileCopier::CopyMethod::None) {
+            throw std::filesystem::filesystem_error("copy_file", sourcePath, temporaryPath,
+                                                    std::make_error_code(std::errc::file_exists));
+        }
+        if (verify && !verifyCopy(photoHandler, temporaryPath, hasher.digest())) {
+            throw std::filesystem::filesystem_error("copy does not match its source", sourcePath, temporaryPath,
+                                                    std::make_error_code(std::errc::io_error));
+        }
+        if (forMove && !FileCopier::syncFile(temporaryPath, ec)) {
+            throw std::filesystem::filesystem_error("fsync", temporaryPath, ec);
+        }
+        std::filesystem::rename(temporaryPath, targetPath);
+        if (hashed) {
+            // Later duplicate checks against this photo need not read it
+            photoHandler.setContentHash(hasher.digest());
+            if (transferOptions.checksumManifest) {
+                transferOptions.checksumManifest->add(targetPath, hasher.digest());
+            }
+        }
+        return copyMethod;
+    } catch (...) {
+        std::filesystem::remove(temporaryPath, ec);
+        throw;
+    }
+}
+
+// 'copiedHash' is the hash of the data as it was copied, so the source is
+// not read again. It has to match the hash duplicate detection took of the
+// source (if any) and the copy as read back from its device.
+bool DirectoryTransfer::verifyCopy(PhotoFileHandler& photoHandler, const std::filesystem::path& targetPath,
+                                   uint64_t copiedHash) {
+    TraceSpan span("DirectoryTransfer::verifyCopy", "verify");
+    std::error_code ec;
+    uint64_t targetSize = std::filesystem::file_size(targetPath, ec);
+    if (ec || targetSize != photoHandler.getFileSize()) {
+        return false;
+    }
+    uint64_t sourceHash, targetHash;
+    if (photoHandler.getContentHash(sourceHash) && sourceHash != copiedHash) {
+        return false; // The source changed since it was scanned
+    }
+    return FileCopier::hashFileFromDisk(targetPath, targetHash, ec) && targetHash == copiedHash;
+}
+
+const std::string& DirectoryTransfer::getTargetDirectory() const {
+    return targetDirectory;
+}
+
+void DirectoryTransfer::setTransferOptions(const TransferOptions& options) {
+    transferOptions = options;
+}
+
+void DirectoryTransfer::applyChecksumManifest(std::vector<std::unique_ptr<PhotoFileHandler>>& targetPhotos) {
+    std::unordered_map<std::string, uint64_t> listedHashes;
+    if (targetPhotos.empty() || !ChecksumManifest::load(targetDirectory, listedHashes)) {
+        return;
+    }
+    for (const auto& targetPhoto : targetPhotos) {
+        auto listed = listedHashes.find(std::filesystem::path(targetPhoto->getSourceFilePath()).filename().string());
+        if (listed != listedHashes.end()) {
+            targetPhoto->setContentHash(listed->second);
+        }
+    }
+}
+
 std::vector<std::unique_ptr<PhotoFileHandler>> DirectoryTransfer::getAllPhotoFilenameDuplicates(){
+    TraceSpan span("DirectoryTransfer::getAllPhotoFilenameDuplicates", "dedupe", targetDirectory);
     std::vector<std::unique_ptr<PhotoFileHandler>> duplicatesFound;
     // Use an iterator to allow safe erasing while iterating
     for (auto it = photoFilesToTransfer.begin(); it != photoFilesToTransfer.end(); ) {
@@ -130,27 +284,86 @@ std::vector<std::unique_ptr<PhotoFileHandler>> DirectoryTransfer::getAllPhotoFil
     return duplicatesFound;
 }
 
+namespace {
+
+// Photos can only be exact duplicates when both their EXIF fingerprint and
+// their file size match, so the pair is used as the bucket key
+uint64_t duplicateCandidateKey(PhotoFileHandler& photo) {
+    return photo.getExifFingerprint() ^ (photo.getFileSize() * 0x9E3779B97F4A7C15ULL);
+}
+
+// All EXIF fields and the exact file contents have to match
+bool isExactDuplicate(PhotoFileHandler& lhs, PhotoFileHandler& rhs) {
+    if (lhs.getFileSize() != rhs.getFileSize()) return false;
+    if (!(lhs.getExifData() == rhs.getExifData())) return false;
+    uint64_t lhsHash, rhsHash;
+    if (!lhs.getContentHash(lhsHash) || !rhs.getContentHash(rhsHash)) return false;
+    return lhsHash == rhsHash;
+}
+
+}
+
 std::vector<std::unique_ptr<PhotoFileHandler>> DirectoryTransfer::getAllPhotoEXIFDuplicates() {
+    TraceSpan span("DirectoryTransfer::getAllPhotoEXIFDuplicates", "dedupe", targetDirectory);
     std::vector<std::unique_ptr<PhotoFileHandler>> duplicatesFound;
-    std::vector<std::unique_ptr<PhotoFileHandler>> uniquePhotos;
+
+    // Scan the target directory for photos already there (if it exists)
+    Scanner targetDirectoryScanner;
+    targetDirectoryScanner.setScanCacheUsed(false);
+    std::vector<PhotoFileHandler*> targetPhotos;
+    if (std::filesystem::exists(targetDirectory)) {
+        targetDirectoryScanner.scan(targetDirectory, false);
+        applyChecksumManifest(targetDirectoryScanner.getPhotoFileHandlers());
+        for (const auto& targetPhoto : targetDirectoryScanner.getPhotoFileHandlers()) {
+            if (targetPhoto) {
+                targetPhotos.push_back(targetPhoto.get());
+            }
+        }
+    }
+
+    // Size-first filter: only photos sharing their EXIF fingerprint and file
+    // size with at least one other photo are worth reading in full. Those are
+    // hashed in parallel, each file streamed in chunks.
+    std::unordered_map<uint64_t, std::vector<PhotoFileHandler*>> candidateGroups;
+    candidateGroups.reserve(photoFilesToTransfer.size() + targetPhotos.size());
+    for (const auto& photo : photoFilesToTransfer) {
+        candidateGroups[duplicateCandidateKey(*photo)].push_back(photo.get());
+    }
+    for (PhotoFileHandler* targetPhoto : targetPhotos) {
+        candidateGroups[duplicateCandidateKey(*targetPhoto)].push_back(targetPhoto);
+    }
+    std::vector<PhotoFileHandler*> photosToHash;
+    for (const auto& group : candidateGroups) {
+        if (group.second.size() > 1) {
+            photosToHash.insert(photosToHash.end(), group.second.begin(), group.second.end());
+        }
+    }
+    QtConcurrent::blockingMap(photosToHash, [](PhotoFileHandler* photo) {
+        photo->computeContentHash();
+    });
 
     // check internally against the source files for any matching files
-    // (files can be named differently and still match)
-    for (auto it1 = photoFilesToTransfer.begin(); it1 != photoFilesToTransfer.end(); ) {
+    // (files can be named differently and still match). Unique photos are
+    // bucketed by candidate key (indices into uniquePhotos), so the full
+    // comparison only runs within a bucket.
+    std::vector<std::unique_ptr<PhotoFileHandler>> uniquePhotos;
+    std::unordered_map<uint64_t, std::vector<size_t>> uniquePhotoBuckets;
+    uniquePhotoBuckets.reserve(photoFilesToTransfer.size());
+    for (auto& photo : photoFilesToTransfer) {
         bool duplicateFound = false;
+        std::vector<size_t>& bucket = uniquePhotoBuckets[duplicateCandidateKey(*photo)];
 
-        for (auto it2 = uniquePhotos.begin(); it2 != uniquePhotos.end(); ++it2) {
-            if ((*it1)->getExifData() == (*it2)->getExifData()) {
+        for (size_t uniqueIndex : bucket) {
+            std::unique_ptr<PhotoFileHandler>& uniquePhoto = uniquePhotos[uniqueIndex];
+            if (isExactDuplicate(*photo, *uniquePhoto)) {
                 // Compare creation times to determine which to keep as duplicate
-                if ((*it1)->getFileCreationTime() < (*it2)->getFileCreationTime()) {
-                    // it1 is older, move it to duplicatesFound
-                    duplicatesFound.push_back(std::move(*it1));
-                    it1 = photoFilesToTransfer.erase(it1); // Erase returns the next valid iterator
+                if (photo->getFileCreationTime() < uniquePhoto->getFileCreationTime()) {
+                    // photo is older, move it to duplicatesFound
+                    duplicatesFound.push_back(std::move(photo));
                 } else {
-                    // it2 is older, move it to duplicatesFound
-                    duplicatesFound.push_back(std::move(*it2));
-                    *it2 = std::move(*it1); // Move it1 to the position of it2
-                    it1 = photoFilesToTransfer.erase(it1); // Erase it1
+                    // uniquePhoto is older, move it to duplicatesFound
+                    duplicatesFound.push_back(std::move(uniquePhoto));
+                    uniquePhoto = std::move(photo); // Keep photo in its place
                 }
                 duplicateFound = true;
                 break; // Break out of the inner loop
@@ -159,41 +372,106 @@ std::vector<std::unique_ptr<PhotoFileHandler>> DirectoryTransfer::getAllPhotoEXI
 
         if (!duplicateFound) {
             // Move the unique photo to uniquePhotos
-            uniquePhotos.push_back(std::move(*it1));
-            it1 = photoFilesToTransfer.erase(it1); // Erase returns the next valid iterator
+            bucket.push_back(uniquePhotos.size());
+            uniquePhotos.push_back(std::move(photo));
         }
     }
 
-    // Move unique photos back to photoFilesToTransfer
-    for (auto& uniquePhoto : uniquePhotos) {
-        photoFilesToTransfer.push_back(std::move(uniquePhoto));
-    }
-    uniquePhotos.clear();
+    // Unique photos become the new transfer list
+    photoFilesToTransfer = std::move(uniquePhotos);
 
-    // Now check the target directory for possible matches (if it exists)
-    if (std::filesystem::exists(targetDirectory)) {
-        Scanner targetDirectoryScanner;
-        targetDirectoryScanner.scan(targetDirectory, false);
-        std::vector<std::unique_ptr<PhotoFileHandler>> &targetDirectoryPhotoFileHandlers = targetDirectoryScanner.getPhotoFileHandlers();
-        // Use an iterator to allow safe erasing while iterating
-        for (auto it1 = photoFilesToTransfer.begin(); it1 != photoFilesToTransfer.end(); ) {
+    // Now check against the photos already in the target directory
+    if (!targetPhotos.empty()) {
+        std::unordered_multimap<uint64_t, PhotoFileHandler*> targetPhotoBuckets;
+        targetPhotoBuckets.reserve(targetPhotos.size());
+        for (PhotoFileHandler* targetPhoto : targetPhotos) {
+            targetPhotoBuckets.emplace(duplicateCandidateKey(*targetPhoto), targetPhoto);
+        }
+        std::vector<std::unique_ptr<PhotoFileHandler>> remainingPhotos;
+        remainingPhotos.reserve(photoFilesToTransfer.size());
+        for (auto& photo : photoFilesToTransfer) {
             bool duplicateFound = false;
-            for (auto it2 = targetDirectoryPhotoFileHandlers.begin(); it2 != targetDirectoryPhotoFileHandlers.end(); ++it2) {
-                if (*it1 && *it2 && (*it1)->getExifData() == (*it2)->getExifData()) {
-                    duplicatesFound.push_back(std::move(*it1)); // Move the unique_ptr to duplicatesFound
-                    it1 = photoFilesToTransfer.erase(it1); // Erase returns the next valid iterator
+            auto candidates = targetPhotoBuckets.equal_range(duplicateCandidateKey(*photo));
+            for (auto it = candidates.first; it != candidates.second; ++it) {
+                if (isExactDuplicate(*photo, *it->second)) {
                     duplicateFound = true;
-                    break; // Break out of the inner loop once a duplicate is found and handled
+                    break; // Stop once a duplicate is found
                 }
             }
-            if (!duplicateFound) {
-                ++it1; // Only increment if no duplicate was found
+            if (duplicateFound) {
+                duplicatesFound.push_back(std::move(photo));
+            } else {
+                remainingPhotos.push_back(std::move(photo));
             }
         }
+        photoFilesToTransfer = std::move(remainingPhotos);
     }
     return duplicatesFound;
 }
 
+bool DirectoryTransfer::checkEXIFDuplicate(PhotoFileHandler& photo, bool replaceDashesWithUnderscores) {
+    TraceSpan span("DirectoryTransfer::checkEXIFDuplicate", "dedupe");
+    // The photos already in the target directory are scanned once, on the
+    // first photo routed here
+    if (!targetDirectoryPhotosLoaded) {
+        targetDirectoryPhotosLoaded = true;
+        if (std::filesystem::exists(targetDirectory)) {
+            Scanner targetDirectoryScanner;
+            targetDirectoryScanner.setScanCacheUsed(false);
+            targetDirectoryScanner.scan(targetDirectory, false);
+            targetDirectoryPhotos = std::move(targetDirectoryScanner.getPhotoFileHandlers());
+            applyChecksumManifest(targetDirectoryPhotos);
+            for (const auto& targetPhoto : targetDirectoryPhotos) {
+                acceptedPhotoBuckets[duplicateCandidateKey(*targetPhoto)].push_back(
+                    makeAcceptedPhoto(*targetPhoto, targetPhoto->getSourceFilePath()));
+            }
+        }
+    }
+
+    // Equal contents imply equal EXIF data, so only the cheap key is checked
+    // before hashing; files are only read when the key matches
+    std::vector<AcceptedPhoto>& bucket = acceptedPhotoBuckets[duplicateCandidateKey(photo)];
+    uint64_t photoHash;
+    if (!bucket.empty() && photo.computeContentHash() && photo.getContentHash(photoHash)) {
+        for (AcceptedPhoto& acceptedPhoto : bucket) {
+            uint64_t acceptedHash;
+            if (acceptedPhoto.fileSize == photo.getFileSize() &&
+                acceptedPhoto.exifFingerprint == photo.getExifFingerprint() &&
+                getAcceptedPhotoHash(acceptedPhoto, acceptedHash) && acceptedHash == photoHash) {
+                return true;
+            }
+        }
+    }
+    bucket.push_back(makeAcceptedPhoto(photo, getTargetPath(photo, replaceDashesWithUnderscores).string()));
+    return false;
+}
+
+DirectoryTransfer::AcceptedPhoto DirectoryTransfer::makeAcceptedPhoto(PhotoFileHandler& photo,
+                                                                      std::string landedPath) {
+    AcceptedPhoto acceptedPhoto;
+    acceptedPhoto.fileSize = photo.getFileSize();
+    acceptedPhoto.exifFingerprint = photo.getExifFingerprint();
+    acceptedPhoto.contentHashKnown = photo.getContentHash(acceptedPhoto.contentHash);
+    acceptedPhoto.sourcePath = photo.getSourceFilePath();
+    acceptedPhoto.landedPath = std::move(landedPath);
+    return acceptedPhoto;
+}
+
+// Hashes the file itself rather than asking its handler, which a transfer
+// worker may be using
+bool DirectoryTransfer::getAcceptedPhotoHash(AcceptedPhoto& acceptedPhoto, uint64_t& hash) {
+    if (!acceptedPhoto.contentHashKnown) {
+        // A moved photo is no longer at its source. Renames are atomic and a
+        // source moved across devices is only removed once its copy is
+        // complete, so the file at the target is complete.
+        acceptedPhoto.contentHashKnown =
+            ContentHasher::hashFile(acceptedPhoto.sourcePath, acceptedPhoto.contentHash) ||
+            ContentHasher::hashFile(acceptedPhoto.landedPath, acceptedPhoto.contentHash);
+    }
+    hash = acceptedPhoto.contentHash;
+    return acceptedPhoto.contentHashKnown;
+}
+
 std::vector<std::unique_ptr<PhotoFileHandler>>& DirectoryTransfer::getPhotoFileToTransfer()
 {
     return photoFilesToTransfer;
@@ -205,20 +483,17 @@ int DirectoryTransfer::getFilesToMoveCount(){
 }
 
 
-bool DirectoryTransfer::checkFilenameMatch(const std::string& targetFilename) {
-    std::filesystem::path path{targetDirectory};
-    if (!std::filesystem::exists(path) || !std::filesystem::is_directory(path)) {
-        std::cerr << "Provided path is not a valid directory." << std::endl;
-        return false; //Path doesn't exist - so there should not a copy or move conflict
-    }
-
-    for (const auto& entry : std::filesystem::directory_iterator(path)) {
-        if (entry.is_regular_file() && entry.path().filename() == targetFilename) {
-            return true;  // Filename match found
-        }
+// Built once from a single directory listing, then kept up to date as
+// files land, so each lookup is a hash set probe
+TargetDirectoryIndex& DirectoryTransfer::getTargetDirectoryIndex() {
+    if (!targetDirectoryIndex.isBuilt()) {
+        targetDirectoryIndex.build(targetDirectory);
     }
+    return targetDirectoryIndex;
+}
 
-    return false;  // No match found
+bool DirectoryTransfer::checkFilenameMatch(const std::string& targetFilename) {
+    return getTargetDirectoryIndex().contains(targetFilename);
 }
 
 void DirectoryTransfer::createDirectoryIfNotExists(const std::string& path) {
@@ -228,4 +503,8 @@ void DirectoryTransfer::createDirectoryIfNotExists(const std::string& path) {
 void DirectoryTransfer::clear(){
     photoFilesToTransfer.clear();
     targetDirectory = "";
+    targetDirectoryIndex.clear();
+    targetDirectoryPhotos.clear();
+    acceptedPhotoBuckets.clear();
+    targetDirectoryPhotosLoaded = false;
 }
@@ -17,9 +17,27 @@
  ***********************************************************************/
 
 
+#include <filesystem>
 #include <vector>
 #include <memory>
+#include <unordered_map>
+#include "checksummanifest.h"
+#include "filecopier.h"
 #include "photofilehandler.h"
+#include "sourceremover.h"
+#include "targetdirectoryindex.h"
+
+// How copies are checked, and how a move between devices (which cannot be
+// a rename) is completed: the file is copied, optionally compared with its
+// source, synced, and only then is the source removed. A copy is compared
+// by hashing the data as it is copied and again as read back from the
+// target's device.
+struct TransferOptions {
+    bool verifyMoves = true;                      // Compare before removing the source
+    bool verifyCopies = false;                    // Compare plain copies too
+    SourceRemover* sourceRemover = nullptr;       // Removes sources in batches; nullptr = right away
+    ChecksumManifest* checksumManifest = nullptr; // Records the hash of every file copied
+};
 
 class DirectoryTransfer
 {
@@ -30,19 +48,61 @@ public:
     void setTargetDirectory(std::string targetDirectory);
     void addPhotoFileToTransfer(std::unique_ptr<PhotoFileHandler> &photoFile);
     bool transferFiles(bool move = false, bool replaceDashesWithUnderscores = false);
+    // 'skipped' (if given) is set when the target existed and overwrite is
+    // disabled, so nothing was transferred
+    bool transferFile(PhotoFileHandler& photoHandler, bool move = false, bool replaceDashesWithUnderscores = false,
+                      const FileCopier::ProgressCallback& onBytesCopied = {}, bool* skipped = nullptr);
+    // Where a file is copied before it is renamed to 'targetPath'
+    static std::filesystem::path getTemporaryPath(const std::filesystem::path& targetPath);
+    std::filesystem::path getTargetPath(PhotoFileHandler& photoHandler,
+                                        bool replaceDashesWithUnderscores = false) const;
+    const std::string& getTargetDirectory() const;
+    // Not to be changed while files are being transferred
+    void setTransferOptions(const TransferOptions& options);
     bool checkFilenameMatch(const std::string& targetFilename);    
     bool removePhotoFileFromTransfer(const std::unique_ptr<PhotoFileHandler>& photoFile);
     bool movePhotoFileToAnotherVector(const std::unique_ptr<PhotoFileHandler>& photoFile,
                                                          std::vector<std::unique_ptr<PhotoFileHandler>>& targetVector);
     std::vector<std::unique_ptr<PhotoFileHandler>> getAllPhotoFilenameDuplicates();
     std::vector<std::unique_ptr<PhotoFileHandler>> getAllPhotoEXIFDuplicates();
+    // Pipelined transfers decide one photo at a time: returns true if 'photo'
+    // exactly duplicates a photo already in the target directory or one
+    // accepted by an earlier call, otherwise records 'photo' (which must
+    // outlive this DirectoryTransfer's use) as accepted
+    bool checkEXIFDuplicate(PhotoFileHandler& photo, bool replaceDashesWithUnderscores = false);
     std::vector<std::unique_ptr<PhotoFileHandler>>& getPhotoFileToTransfer();
+    TargetDirectoryIndex& getTargetDirectoryIndex();
     void createDirectoryIfNotExists(const std::string& path);
     void clear();
     int getFilesToMoveCount();
 private:
+    // A photo that is (or will be) in the target directory, for
+    // checkEXIFDuplicate. Its fields are copied before the photo is
+    // submitted - from then on its handler belongs to a transfer worker.
+    struct AcceptedPhoto {
+        uint64_t fileSize = 0;
+        uint64_t exifFingerprint = 0;
+        uint64_t contentHash = 0;
+        bool contentHashKnown = false;
+        std::string sourcePath;
+        std::string landedPath; // Where the file is once transferred
+    };
+    static AcceptedPhoto makeAcceptedPhoto(PhotoFileHandler& photo, std::string landedPath);
+    bool getAcceptedPhotoHash(AcceptedPhoto& acceptedPhoto, uint64_t& hash);
+    FileCopier::CopyMethod copyIntoPlace(PhotoFileHandler& photoHandler, const std::filesystem::path& sourcePath,
+                                         const std::filesystem::path& targetPath, bool forMove,
+                                         const FileCopier::ProgressCallback& onBytesCopied);
+    bool verifyCopy(PhotoFileHandler& photoHandler, const std::filesystem::path& targetPath, uint64_t copiedHash);
+    // Gives the photos of the target directory the hashes listed in its
+    // checksum manifest
+    void applyChecksumManifest(std::vector<std::unique_ptr<PhotoFileHandler>>& targetPhotos);
     std::vector<std::unique_ptr<PhotoFileHandler>> photoFilesToTransfer;
     std::string targetDirectory;
+    TargetDirectoryIndex targetDirectoryIndex;
+    std::vector<std::unique_ptr<PhotoFileHandler>> targetDirectoryPhotos;
+    std::unordered_map<uint64_t, std::vector<AcceptedPhoto>> acceptedPhotoBuckets;
+    bool targetDirectoryPhotosLoaded = false;
+    TransferOptions transferOptions;
 };
 
 #endif // DIRECTORYTRANSFER_H
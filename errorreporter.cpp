@@ -0,0 +1,25 @@
+/***********************************************************************
+ * File Name: errorreporter.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the ErrorReporter class.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <QApplication>
+#include <QMessageBox>
+#include <QString>
+#include <iostream>
+#include "errorreporter.h"
+
+void ErrorReporter::showError(const std::string& message) {
+    if (guiAvailable()) {
+        QMessageBox::critical(nullptr, "Error", QString::fromStdString(message), QMessageBox::Ok);
+    } else {
+        std::cerr << "Error: " << message << std::endl;
+    }
+}
+
+bool ErrorReporter::guiAvailable() {
+    return qobject_cast<QApplication*>(QCoreApplication::instance()) != nullptr;
+}
@@ -0,0 +1,28 @@
+#ifndef ERRORREPORTER_H
+#define ERRORREPORTER_H
+
+/***********************************************************************
+ * File Name: errorreporter.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the ErrorReporter class, which shows an
+ *              error to the user. With the GUI running this is a message
+ *              box; in batch mode there is no display to show (and dismiss)
+ *              a message box on, so the error is written to stderr instead.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <string>
+
+class ErrorReporter
+{
+public:
+    static void showError(const std::string& message);
+    // True when running with a QApplication (and so a display)
+    static bool guiAvailable();
+
+private:
+    ErrorReporter() = delete;
+};
+
+#endif // ERRORREPORTER_H
@@ -33,6 +33,7 @@
 #include <tuple>
 #include <algorithm>
 #include <cstdint>
+#include <cstring>
 #include <stdio.h>
 #include <vector>
 
@@ -465,6 +466,345 @@ bool operator==(const EXIFInfo& lhs, const EXIFInfo& rhs) {
 }
 
 
+namespace {
+
+// FNV-1a based accumulator used for EXIFInfo::fingerprint()
+class FingerprintHasher {
+ public:
+  void add(const unsigned char *data, size_t length) {
+    for (size_t i = 0; i < length; ++i) {
+      hash_ ^= data[i];
+      hash_ *= 0x100000001b3ULL;
+    }
+  }
+  void add(uint64_t value) {
+    unsigned char bytes[8];
+    for (int i = 0; i < 8; ++i) bytes[i] = static_cast<unsigned char>(value >> (8 * i));
+    add(bytes, 8);
+  }
+  void add(double value) {
+    // +0.0 and -0.0 compare equal, so they must hash equal as well
+    if (value == 0) value = 0;
+    uint64_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    add(bits);
+  }
+  void add(std::string_view value) {
+    // Length prefix keeps ("ab", "c") and ("a", "bc") apart
+    add(static_cast<uint64_t>(value.size()));
+    add(reinterpret_cast<const unsigned char *>(value.data()), value.size());
+  }
+  uint64_t result() const {
+    // Final avalanche (splitmix64) so the low bits are usable as buckets
+    uint64_t z = hash_;
+    z = (z ^ (z >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    z = (z ^ (z >> 27)) * 0x94d049bb133111ebULL;
+    return z ^ (z >> 31);
+  }
+
+ private:
+  uint64_t hash_ = 0xcbf29ce484222325ULL;
+};
+}
+
+// Shared by EXIFInfo and EXIFView, which name the fields alike, so both
+// always hash the same way
+template <typename Fields>
+uint64_t fingerprintFields(const Fields &fields) {
+  FingerprintHasher hasher;
+  hasher.add(static_cast<uint64_t>(fields.ByteAlign));
+  hasher.add(std::string_view(fields.Make));
+  hasher.add(std::string_view(fields.Model));
+  hasher.add(std::string_view(fields.DateTime));
+  hasher.add(std::string_view(fields.DateTimeOriginal));
+  hasher.add(std::string_view(fields.DateTimeDigitized));
+  hasher.add(std::string_view(fields.SubSecTimeOriginal));
+  hasher.add(static_cast<uint64_t>(fields.Orientation));
+  hasher.add(static_cast<uint64_t>(fields.ISOSpeedRatings));
+  hasher.add(static_cast<uint64_t>(fields.ImageWidth));
+  hasher.add(static_cast<uint64_t>(fields.ImageHeight));
+  hasher.add(fields.ExposureTime);
+  hasher.add(fields.FNumber);
+  hasher.add(fields.FocalLength);
+  return hasher.result();
+}
+
+uint64_t EXIFInfo::fingerprint() const {
+  return fingerprintFields(*this);
+}
+
+uint64_t EXIFView::fingerprint() const {
+  return fingerprintFields(*this);
+}
+
+void EXIFView::clear() {
+  FoundTags = 0;
+  ByteAlign = 0;
+  Make = Model = DateTime = std::string_view();
+  DateTimeOriginal = DateTimeDigitized = SubSecTimeOriginal = std::string_view();
+  LensModel = OffsetTimeOriginal = std::string_view();
+  Orientation = 0;
+  ISOSpeedRatings = 0;
+  ImageWidth = 0;
+  ImageHeight = 0;
+  ExposureTime = 0;
+  FNumber = 0;
+  FocalLength = 0;
+}
+
+namespace {
+
+// A directory entry read in place. Mirrors what parseIFEntry_temp accepts:
+// 'valid' is false exactly where it would mark the entry with tag 0xFF.
+struct EntryView {
+  unsigned short tag;
+  unsigned short format;
+  unsigned length;
+  const unsigned char *value;  // First value, null if not extracted
+  unsigned data;               // Raw value/offset field
+  bool valid;
+};
+
+template <bool alignIntel>
+EntryView readEntry(const unsigned char *buf, unsigned offs, unsigned base,
+                    unsigned len) {
+  EntryView entry;
+  parseIFEntryHeader<alignIntel>(buf + offs, entry.tag, entry.format,
+                                 entry.length, entry.data);
+  entry.value = nullptr;
+  entry.valid = true;
+  size_t elementSize;
+  switch (entry.format) {
+    case 1: case 2: elementSize = 1; break;
+    case 3: elementSize = 2; break;
+    case 4: elementSize = 4; break;
+    case 5: elementSize = 8; break;
+    case 7: case 9: case 10: return entry;  // Not extracted
+    default: entry.valid = false; return entry;
+  }
+  size_t size = elementSize * entry.length;
+  if (size <= 4) {
+    // Small values sit in the entry itself, in file byte order
+    entry.value = buf + offs + 8;
+  } else {
+    const unsigned char *data = buf + base + entry.data;
+    if (data + size > buf + len) {
+      entry.valid = false;
+      return entry;
+    }
+    entry.value = data;
+  }
+  return entry;
+}
+
+std::string_view entryString(const EntryView &entry) {
+  std::string_view value(reinterpret_cast<const char *>(entry.value),
+                         entry.length);
+  if (!value.empty() && value.back() == '\0') value.remove_suffix(1);
+  return value;
+}
+
+template <bool alignIntel>
+bool entryShort(const EntryView &entry, unsigned short &value) {
+  if (!entry.valid || entry.format != 3 || entry.length == 0) return false;
+  value = parse<uint16_t, alignIntel>(entry.value);
+  return true;
+}
+
+template <bool alignIntel>
+bool entryRational(const EntryView &entry, double &value) {
+  if (!entry.valid || entry.format != 5 || entry.length == 0) return false;
+  value = parse<Rational, alignIntel>(entry.value);
+  return true;
+}
+
+// Checks the entry count of the IFD at 'offs' the way
+// EXIFInfo::parseFromEXIFSegment does for its SubIFDs
+template <bool alignIntel>
+bool subIFDFits(const unsigned char *buf, unsigned offs, unsigned len) {
+  int numEntries = parse<uint16_t, alignIntel>(buf + offs);
+  return !(offs + 6 + 12 * numEntries > len);
+}
+
+template <bool alignIntel>
+int parseEXIFView(easyexif::EXIFView &view, const unsigned char *buf,
+                  unsigned len, unsigned offs, unsigned tiffHeaderStart,
+                  uint32_t tagMask) {
+  using easyexif::EXIFView;
+  auto wanted = [&](uint32_t tag) { return (tagMask & tag) != 0; };
+  auto allFound = [&]() { return (view.FoundTags & tagMask) == tagMask; };
+
+  // IFD0. Walked in full unless everything (including the SubIFD pointers,
+  // needed to validate the SubIFDs) has been seen.
+  if (offs + 2 > len) return PARSE_EXIF_ERROR_CORRUPT;
+  int numEntries = parse<uint16_t, alignIntel>(buf + offs);
+  if (offs + 6 + 12 * numEntries > len) return PARSE_EXIF_ERROR_CORRUPT;
+  offs += 2;
+  unsigned exifSubIFDOffset = len;
+  unsigned gpsSubIFDOffset = len;
+  bool exifPointerFound = false;
+  bool gpsPointerFound = false;
+  for (; numEntries > 0; --numEntries, offs += 12) {
+    EntryView entry = readEntry<alignIntel>(buf, offs, tiffHeaderStart, len);
+    if (!entry.valid) continue;
+    switch (entry.tag) {
+      case 0x10F:
+        if (wanted(EXIFView::TagMake) && entry.format == 2) {
+          view.Make = entryString(entry);
+          view.FoundTags |= EXIFView::TagMake;
+        }
+        break;
+      case 0x110:
+        if (wanted(EXIFView::TagModel) && entry.format == 2) {
+          view.Model = entryString(entry);
+          view.FoundTags |= EXIFView::TagModel;
+        }
+        break;
+      case 0x112:
+        if (wanted(EXIFView::TagOrientation) &&
+            entryShort<alignIntel>(entry, view.Orientation))
+          view.FoundTags |= EXIFView::TagOrientation;
+        break;
+      case 0x132:
+        if (wanted(EXIFView::TagDateTime) && entry.format == 2) {
+          view.DateTime = entryString(entry);
+          view.FoundTags |= EXIFView::TagDateTime;
+        }
+        break;
+      case 0x8825:
+        gpsSubIFDOffset = tiffHeaderStart + entry.data;
+        gpsPointerFound = true;
+        break;
+      case 0x8769:
+        exifSubIFDOffset = tiffHeaderStart + entry.data;
+        exifPointerFound = true;
+        break;
+    }
+    if (exifPointerFound && gpsPointerFound && allFound()) break;
+  }
+
+  if (exifSubIFDOffset + 4 <= len) {
+    if (!subIFDFits<alignIntel>(buf, exifSubIFDOffset, len))
+      return PARSE_EXIF_ERROR_CORRUPT;
+    offs = exifSubIFDOffset;
+    int numSubEntries = parse<uint16_t, alignIntel>(buf + offs);
+    offs += 2;
+    for (; numSubEntries > 0 && !allFound(); --numSubEntries, offs += 12) {
+      EntryView entry = readEntry<alignIntel>(buf, offs, tiffHeaderStart, len);
+      if (!entry.valid) continue;
+      switch (entry.tag) {
+        case 0x829a:
+          if (wanted(EXIFView::TagExposureTime) &&
+              entryRational<alignIntel>(entry, view.ExposureTime))
+            view.FoundTags |= EXIFView::TagExposureTime;
+          break;
+        case 0x829d:
+          if (wanted(EXIFView::TagFNumber) &&
+              entryRational<alignIntel>(entry, view.FNumber))
+            view.FoundTags |= EXIFView::TagFNumber;
+          break;
+        case 0x8827:
+          if (wanted(EXIFView::TagISOSpeedRatings) &&
+              entryShort<alignIntel>(entry, view.ISOSpeedRatings))
+            view.FoundTags |= EXIFView::TagISOSpeedRatings;
+          break;
+        case 0x9003:
+          if (wanted(EXIFView::TagDateTimeOriginal) && entry.format == 2) {
+            view.DateTimeOriginal = entryString(entry);
+            view.FoundTags |= EXIFView::TagDateTimeOriginal;
+          }
+          break;
+        case 0x9004:
+          if (wanted(EXIFView::TagDateTimeDigitized) && entry.format == 2) {
+            view.DateTimeDigitized = entryString(entry);
+            view.FoundTags |= EXIFView::TagDateTimeDigitized;
+          }
+          break;
+        case 0x920a:
+          if (wanted(EXIFView::TagFocalLength) &&
+              entryRational<alignIntel>(entry, view.FocalLength))
+            view.FoundTags |= EXIFView::TagFocalLength;
+          break;
+        case 0x9291:
+          if (wanted(EXIFView::TagSubSecTimeOriginal) && entry.format == 2) {
+            view.SubSecTimeOriginal = entryString(entry);
+            view.FoundTags |= EXIFView::TagSubSecTimeOriginal;
+          }
+          break;
+        case 0x9011:
+          if (wanted(EXIFView::TagOffsetTimeOriginal) && entry.format == 2) {
+            view.OffsetTimeOriginal = entryString(entry);
+            view.FoundTags |= EXIFView::TagOffsetTimeOriginal;
+          }
+          break;
+        case 0xa434:
+          if (wanted(EXIFView::TagLensModel) && entry.format == 2) {
+            view.LensModel = entryString(entry);
+            view.FoundTags |= EXIFView::TagLensModel;
+          }
+          break;
+        case 0xa002:
+        case 0xa003: {
+          uint32_t tag = entry.tag == 0xa002 ? EXIFView::TagImageWidth
+                                             : EXIFView::TagImageHeight;
+          unsigned &dimension =
+              entry.tag == 0xa002 ? view.ImageWidth : view.ImageHeight;
+          if (!wanted(tag) || entry.length == 0) break;
+          if (entry.format == 4) {
+            dimension = parse<uint32_t, alignIntel>(entry.value);
+            view.FoundTags |= tag;
+          } else if (entry.format == 3) {
+            dimension = parse<uint16_t, alignIntel>(entry.value);
+            view.FoundTags |= tag;
+          }
+          break;
+        }
+      }
+    }
+  }
+
+  // The GPS fields are never decoded, but a GPS IFD that does not fit
+  // fails EXIFInfo, so it fails here too
+  if (gpsSubIFDOffset + 4 <= len &&
+      !subIFDFits<alignIntel>(buf, gpsSubIFDOffset, len))
+    return PARSE_EXIF_ERROR_CORRUPT;
+  return PARSE_EXIF_SUCCESS;
+}
+
+}
+
+int EXIFView::parseFromEXIFSegment(const unsigned char *buf, unsigned len,
+                                   uint32_t tagMask) {
+  clear();
+  if (!buf || len < 6) return PARSE_EXIF_ERROR_NO_EXIF;
+  if (!std::equal(buf, buf + 6, "Exif\0\0")) return PARSE_EXIF_ERROR_NO_EXIF;
+  unsigned offs = 6;
+
+  // TIFF header, as in EXIFInfo::parseFromEXIFSegment. The byte order is
+  // resolved once here; everything below is compiled for it.
+  if (offs + 8 > len) return PARSE_EXIF_ERROR_CORRUPT;
+  unsigned tiffHeaderStart = offs;
+  bool alignIntel;
+  if (buf[offs] == 'I' && buf[offs + 1] == 'I')
+    alignIntel = true;
+  else if (buf[offs] == 'M' && buf[offs + 1] == 'M')
+    alignIntel = false;
+  else
+    return PARSE_EXIF_ERROR_UNKNOWN_BYTEALIGN;
+  ByteAlign = alignIntel;
+  offs += 2;
+  if (0x2a != parse_value<uint16_t>(buf + offs, alignIntel))
+    return PARSE_EXIF_ERROR_CORRUPT;
+  offs += 2;
+  unsigned firstIFDOffset = parse_value<uint32_t>(buf + offs, alignIntel);
+  offs += firstIFDOffset - 4;
+  if (offs >= len) return PARSE_EXIF_ERROR_CORRUPT;
+
+  if (alignIntel)
+    return parseEXIFView<true>(*this, buf, len, offs, tiffHeaderStart, tagMask);
+  return parseEXIFView<false>(*this, buf, len, offs, tiffHeaderStart, tagMask);
+}
+
 //
 // Locates the EXIF segment and parses it using parseFromEXIFSegment
 //
@@ -473,19 +813,9 @@ int easyexif::EXIFInfo::parseFrom(const unsigned char *buf, unsigned len) {
   if (!buf || len < 4) return PARSE_EXIF_ERROR_NO_JPEG;
   if (buf[0] != 0xFF || buf[1] != 0xD8) return PARSE_EXIF_ERROR_NO_JPEG;
 
-  // Sanity check: some cameras pad the JPEG image with some bytes at the end.
-  // Normally, we should be able to find the JPEG end marker 0xFFD9 at the end
-  // of the image buffer, but not always. As long as there are some bytes
-  // except 0xD9 at the end of the image buffer, keep decrementing len until
-  // an 0xFFD9 is found. If JPEG end marker 0xFFD9 is not found,
-  // then we can be reasonably sure that the buffer is not a JPEG.
-  while (len > 2) {
-    if (buf[len - 1] == 0xD9 && buf[len - 2] == 0xFF)
-      break;
-    len--;
-  }
-  if (len <= 2)
-    return PARSE_EXIF_ERROR_NO_JPEG;
+  // Note: the buffer is not required to hold the whole image. The EXIF
+  // segment always precedes the image data, so a prefix of the file is
+  // enough and we no longer look for the JPEG end marker 0xFFD9.
 
   clear();
 
@@ -731,6 +1061,12 @@ int easyexif::EXIFInfo::parseFromEXIFSegment(const unsigned char *buf,
             this->SubSecTimeOriginal = result.val_string();
           break;
 
+        case 0x9011:
+          // UTC offset of the original date and time
+          if (result.format() == 2)
+            this->OffsetTimeOriginal = result.val_string();
+          break;
+
         case 0xa002:
           // EXIF Image width
           if (result.format() == 4 && result.val_long().size())
@@ -922,6 +1258,7 @@ void easyexif::EXIFInfo::clear() {
   DateTimeOriginal = "";
   DateTimeDigitized = "";
   SubSecTimeOriginal = "";
+  OffsetTimeOriginal = "";
   Copyright = "";
 
   // Shorts / unsigned / double
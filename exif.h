@@ -34,7 +34,9 @@
 #ifndef __EXIF_H
 #define __EXIF_H
 
+#include <cstdint>
 #include <string>
+#include <string_view>
 
 namespace easyexif {
 
@@ -61,6 +63,12 @@ class EXIFInfo {
   // Set all data members to default values.
   void clear();
 
+  // 64-bit fingerprint over the identifying subset of the fields compared
+  // by operator== (camera, timestamps, dimensions and exposure). Equal
+  // EXIFInfo objects always have equal fingerprints, so the fingerprint can
+  // be used to bucket candidates before running the full comparison.
+  uint64_t fingerprint() const;
+
   // Data fields filled out by parseFrom()
   char ByteAlign;                   // 0 = Motorola byte alignment, 1 = Intel
   std::string ImageDescription;     // Image description
@@ -79,6 +87,7 @@ class EXIFInfo {
   std::string DateTimeOriginal;     // Original file date and time (may not exist)
   std::string DateTimeDigitized;    // Digitization date and time (may not exist)
   std::string SubSecTimeOriginal;   // Sub-second time that original picture was taken
+  std::string OffsetTimeOriginal;   // UTC offset of DateTimeOriginal, "+HH:MM" (may not exist)
   std::string Copyright;            // File copyright information
   double ExposureTime;              // Exposure time in seconds
   double FNumber;                   // F/stop
@@ -156,6 +165,73 @@ class EXIFInfo {
 // Declare the == operator overload
 bool operator==(const EXIFInfo& lhs, const EXIFInfo& rhs);
 
+//
+// Selective, allocation free alternative to EXIFInfo for hot paths (the
+// scan). Only the tags in the requested mask are decoded; strings are views
+// into the parsed buffer, so they are only valid while that buffer is. The
+// EXIF SubIFD walk stops as soon as every requested tag has been seen.
+// Return codes are the same as EXIFInfo::parseFromEXIFSegment for the same
+// buffer. A tag repeated later in an IFD than where the walk stopped is not
+// seen (EXIFInfo keeps the last occurrence).
+//
+class EXIFView {
+ public:
+  enum Tag : uint32_t {
+    TagMake               = 1u << 0,
+    TagModel              = 1u << 1,
+    TagDateTime           = 1u << 2,
+    TagOrientation        = 1u << 3,
+    TagDateTimeOriginal   = 1u << 4,
+    TagDateTimeDigitized  = 1u << 5,
+    TagSubSecTimeOriginal = 1u << 6,
+    TagExposureTime       = 1u << 7,
+    TagFNumber            = 1u << 8,
+    TagISOSpeedRatings    = 1u << 9,
+    TagFocalLength        = 1u << 10,
+    TagImageWidth         = 1u << 11,
+    TagImageHeight        = 1u << 12,
+    TagLensModel          = 1u << 13,  // Not part of the fingerprint
+    TagOffsetTimeOriginal = 1u << 14,  // Not part of the fingerprint
+    // Tags stored in IFD0; the rest are in the EXIF SubIFD
+    IFD0Tags = TagMake | TagModel | TagDateTime | TagOrientation,
+    // Everything fingerprint() covers
+    FingerprintTags = (1u << 13) - 1
+  };
+
+  // Same input as EXIFInfo::parseFromEXIFSegment (a blob starting with
+  // "Exif\0\0"). Fields outside 'tagMask' are left cleared.
+  int parseFromEXIFSegment(const unsigned char *buf, unsigned len,
+                           uint32_t tagMask = FingerprintTags);
+
+  void clear();
+
+  // Equal to EXIFInfo::fingerprint() for the same buffer when parsed with
+  // FingerprintTags
+  uint64_t fingerprint() const;
+
+  uint32_t FoundTags;               // Requested tags present in the data
+  char ByteAlign;                   // 0 = Motorola byte alignment, 1 = Intel
+  std::string_view Make;
+  std::string_view Model;
+  std::string_view DateTime;
+  std::string_view DateTimeOriginal;
+  std::string_view DateTimeDigitized;
+  std::string_view SubSecTimeOriginal;
+  std::string_view LensModel;
+  std::string_view OffsetTimeOriginal;
+  unsigned short Orientation;
+  unsigned short ISOSpeedRatings;
+  unsigned ImageWidth;
+  unsigned ImageHeight;
+  double ExposureTime;
+  double FNumber;
+  double FocalLength;
+
+  EXIFView() {
+    clear();
+  }
+};
+
 }
 
 // Parse was successful
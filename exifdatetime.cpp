@@ -0,0 +1,117 @@
+/***********************************************************************
+ * File Name: exifdatetime.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the EXIFDateTime structure.
+ * License: MIT License
+ ***********************************************************************/
+
+#include "exifdatetime.h"
+
+namespace {
+
+bool parseDigits(std::string_view text, size_t offset, size_t count, unsigned& value) {
+    value = 0;
+    for (size_t i = offset; i < offset + count; ++i) {
+        if (text[i] < '0' || text[i] > '9') {
+            return false;
+        }
+        value = value * 10 + static_cast<unsigned>(text[i] - '0');
+    }
+    return true;
+}
+
+}
+
+bool EXIFDateTime::parse(std::string_view text, EXIFDateTime& dateTime) {
+    // "YYYY:MM:DD HH:MM:SS"
+    if (text.size() < 19 || text[4] != ':' || text[7] != ':' || text[10] != ' ' ||
+        text[13] != ':' || text[16] != ':') {
+        return false;
+    }
+    unsigned year, month, day, hour, minute, second;
+    if (!parseDigits(text, 0, 4, year) || !parseDigits(text, 5, 2, month) || !parseDigits(text, 8, 2, day) ||
+        !parseDigits(text, 11, 2, hour) || !parseDigits(text, 14, 2, minute) || !parseDigits(text, 17, 2, second)) {
+        return false;
+    }
+    // Seconds go to 60 for a leap second
+    if (month < 1 || month > 12 || day < 1 || day > daysInMonth(year, month) ||
+        hour > 23 || minute > 59 || second > 60) {
+        return false;
+    }
+    dateTime.year = static_cast<uint16_t>(year);
+    dateTime.month = static_cast<uint8_t>(month);
+    dateTime.day = static_cast<uint8_t>(day);
+    dateTime.hour = static_cast<uint8_t>(hour);
+    dateTime.minute = static_cast<uint8_t>(minute);
+    dateTime.second = static_cast<uint8_t>(second);
+    return true;
+}
+
+bool EXIFDateTime::parseOffset(std::string_view text, int16_t& offsetMinutes) {
+    if (text == "Z") {
+        offsetMinutes = 0;
+        return true;
+    }
+    unsigned hours, minutes;
+    if (text.size() < 5 || (text[0] != '+' && text[0] != '-') || !parseDigits(text, 1, 2, hours)) {
+        return false;
+    }
+    size_t minutesStart = text[3] == ':' ? 4 : 3;
+    if (text.size() < minutesStart + 2 || !parseDigits(text, minutesStart, 2, minutes) ||
+        hours > 14 || minutes > 59) {
+        return false;
+    }
+    int total = static_cast<int>(hours * 60 + minutes);
+    offsetMinutes = static_cast<int16_t>(text[0] == '-' ? -total : total);
+    return true;
+}
+
+uint64_t EXIFDateTime::pack() const {
+    return (static_cast<uint64_t>(year) << 40) | (static_cast<uint64_t>(month) << 32) |
+           (static_cast<uint64_t>(day) << 24) | (static_cast<uint64_t>(hour) << 16) |
+           (static_cast<uint64_t>(minute) << 8) | second;
+}
+
+EXIFDateTime EXIFDateTime::unpack(uint64_t packed, int16_t offsetMinutes) {
+    EXIFDateTime dateTime;
+    dateTime.year = static_cast<uint16_t>(packed >> 40);
+    dateTime.month = static_cast<uint8_t>(packed >> 32);
+    dateTime.day = static_cast<uint8_t>(packed >> 24);
+    dateTime.hour = static_cast<uint8_t>(packed >> 16);
+    dateTime.minute = static_cast<uint8_t>(packed >> 8);
+    dateTime.second = static_cast<uint8_t>(packed);
+    dateTime.offsetMinutes = offsetMinutes;
+    return dateTime;
+}
+
+int64_t EXIFDateTime::daysSinceEpoch() const {
+    return daysFromCivil(year, month, day);
+}
+
+std::chrono::system_clock::time_point EXIFDateTime::toTimePoint() const {
+    int64_t seconds = daysSinceEpoch() * 86400 + hour * 3600 + minute * 60 + second;
+    if (offsetMinutes != NoOffset) {
+        seconds -= static_cast<int64_t>(offsetMinutes) * 60;
+    }
+    return std::chrono::system_clock::time_point(std::chrono::seconds(seconds));
+}
+
+// Howard Hinnant's days_from_civil: proleptic Gregorian calendar, with the
+// year starting in March so the leap day is the last day of the year
+int64_t EXIFDateTime::daysFromCivil(int64_t year, unsigned month, unsigned day) {
+    year -= month <= 2;
+    const int64_t era = (year >= 0 ? year : year - 399) / 400;
+    const unsigned yearOfEra = static_cast<unsigned>(year - era * 400);
+    const unsigned dayOfYear = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1;
+    const unsigned dayOfEra = yearOfEra * 365 + yearOfEra / 4 - yearOfEra / 100 + dayOfYear;
+    return era * 146097 + static_cast<int64_t>(dayOfEra) - 719468;
+}
+
+unsigned EXIFDateTime::daysInMonth(unsigned year, unsigned month) {
+    static const unsigned days[12] = {31, 28, 31, 30, 31, 30, 31, 31, 30, 31, 30, 31};
+    if (month == 2 && year % 4 == 0 && (year % 100 != 0 || year % 400 == 0)) {
+        return 29;
+    }
+    return month >= 1 && month <= 12 ? days[month - 1] : 0;
+}
@@ -0,0 +1,56 @@
+#ifndef EXIFDATETIME_H
+#define EXIFDATETIME_H
+
+/***********************************************************************
+ * File Name: exifdatetime.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the EXIFDateTime structure, an EXIF date
+ *              ("YYYY:MM:DD HH:MM:SS") and its optional UTC offset
+ *              (OffsetTimeOriginal, "+HH:MM"). Parsing reads the fixed
+ *              positions directly and conversions use days-from-civil
+ *              arithmetic, so neither touches the locale or the time zone
+ *              database - unlike std::get_time and std::mktime, which take
+ *              process wide locks and serialize a parallel scan.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <chrono>
+#include <cstdint>
+#include <string_view>
+
+struct EXIFDateTime {
+    static constexpr int16_t NoOffset = INT16_MIN;
+
+    uint16_t year = 0;
+    uint8_t month = 0;
+    uint8_t day = 0;
+    uint8_t hour = 0;
+    uint8_t minute = 0;
+    uint8_t second = 0;
+    int16_t offsetMinutes = NoOffset; // East of UTC, NoOffset if unknown
+
+    // Accepts "YYYY:MM:DD HH:MM:SS" (anything after it is ignored) naming a
+    // real calendar date. Returns false for blank or impossible dates.
+    static bool parse(std::string_view text, EXIFDateTime& dateTime);
+    // Accepts "+HH:MM", "-HH:MM", "+HHMM" and "Z". Returns false (leaving
+    // 'offsetMinutes' alone) for anything else, including blank offsets.
+    static bool parseOffset(std::string_view text, int16_t& offsetMinutes);
+
+    // Each field in its own bits, so packed dates sort chronologically
+    // (by the camera's clock): year << 40 | month << 32 | day << 24 |
+    // hour << 16 | minute << 8 | second. 0 means no date.
+    uint64_t pack() const;
+    static EXIFDateTime unpack(uint64_t packed, int16_t offsetMinutes = NoOffset);
+
+    // Days since 1970-01-01 of the date
+    int64_t daysSinceEpoch() const;
+    // The moment the photo was taken. Without an offset the camera's clock
+    // is read as UTC, which keeps the calendar fields exact.
+    std::chrono::system_clock::time_point toTimePoint() const;
+
+    static int64_t daysFromCivil(int64_t year, unsigned month, unsigned day);
+    static unsigned daysInMonth(unsigned year, unsigned month);
+};
+
+#endif // EXIFDATETIME_H
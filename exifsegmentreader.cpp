@@ -0,0 +1,426 @@
+/***********************************************************************
+ * File Name: exifsegmentreader.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the EXIFSegmentReader class. The JPEG
+ *              reader follows the marker chain (SOI, APPn, DQT, ...) one
+ *              segment header at a time, seeking over segments it does not
+ *              need. Reading stops as soon as the APP1 EXIF payload has been
+ *              read, or when the start of scan / end of image is reached,
+ *              because EXIF data never follows the compressed image data.
+ *              The TIFF reader copies IFD0 and the EXIF and GPS SubIFDs,
+ *              with the values they point to, into a fresh little TIFF
+ *              behind an "Exif\0\0" signature, rewriting the offsets as it
+ *              goes. Reads go through a small block cache, since an IFD and
+ *              its values usually sit next to each other. The HEIF reader
+ *              walks the box headers to the 'meta' box, looks the Exif item
+ *              up in 'iinf' and 'iloc' and reads only that item.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include "exifsegmentreader.h"
+#include "exif.h"
+#include "isobmffbox.h"
+#include "positionedfile.h"
+
+namespace {
+
+// JPEG marker codes (the byte following 0xFF)
+constexpr uint8_t MarkerSOI  = 0xD8; // Start of image
+constexpr uint8_t MarkerEOI  = 0xD9; // End of image
+constexpr uint8_t MarkerSOS  = 0xDA; // Start of scan - compressed data follows
+constexpr uint8_t MarkerAPP1 = 0xE1; // EXIF (or XMP) application segment
+constexpr uint8_t MarkerTEM  = 0x01; // Standalone marker without a length
+
+bool isStandaloneMarker(uint8_t marker) {
+    return marker == MarkerTEM || (marker >= 0xD0 && marker <= 0xD7); // TEM, RST0-RST7
+}
+
+bool readBytes(std::ifstream& file, uint8_t* data, std::streamsize count) {
+    file.read(reinterpret_cast<char*>(data), count);
+    return file.gcount() == count;
+}
+
+// Limits that keep a corrupt file from making us read (or allocate) much
+constexpr unsigned MaxIFDEntries = 1024;
+constexpr uint32_t MaxValueSize = 64 * 1024;     // Larger values (maker notes, strips) are left out
+constexpr size_t MaxSegmentSize = 1024 * 1024;
+constexpr size_t SignatureSize = 6;              // "Exif\0\0" - TIFF offsets start after it
+
+constexpr uint16_t TagExifIFD = 0x8769;
+constexpr uint16_t TagGPSIFD = 0x8825;
+
+// Bytes per value of each TIFF field type (0 = unknown type)
+uint32_t formatSize(uint16_t format) {
+    static const uint32_t sizes[] = {0, 1, 1, 2, 4, 8, 1, 1, 2, 4, 8, 4, 8, 4};
+    return format < sizeof(sizes) / sizeof(sizes[0]) ? sizes[format] : 0;
+}
+
+class TIFFRepacker {
+public:
+    TIFFRepacker(PositionedFile& file, bool alignIntel, std::vector<uint8_t>& segment)
+        : file(file), alignIntel(alignIntel), segment(segment) {}
+
+    // Appends the IFD at 'fileOffset' and its values to the segment, then
+    // the EXIF and GPS SubIFDs it points to. Returns the IFD's TIFF offset
+    // in the segment, or 0 if it could not be read.
+    uint32_t copyIFD(uint32_t fileOffset, bool followSubIFDs) {
+        uint8_t countBytes[2];
+        if (!file.read(fileOffset, countBytes, 2)) return 0;
+        unsigned entryCount = get16(countBytes);
+        if (entryCount == 0 || entryCount > MaxIFDEntries) return 0;
+        std::vector<uint8_t> entries(entryCount * 12);
+        if (!file.read(fileOffset + 2, entries.data(), entries.size())) return 0;
+
+        // Keep the entries whose values can be copied
+        std::vector<const uint8_t*> kept;
+        for (unsigned i = 0; i < entryCount; ++i) {
+            const uint8_t* entry = entries.data() + i * 12;
+            uint32_t size = formatSize(get16(entry + 2));
+            uint64_t valueSize = static_cast<uint64_t>(size) * get32(entry + 4);
+            if (size != 0 && valueSize <= MaxValueSize) kept.push_back(entry);
+        }
+        size_t ifdPosition = segment.size();
+        if (ifdPosition + 6 + kept.size() * 12 > MaxSegmentSize) return 0;
+        segment.resize(ifdPosition + 2 + kept.size() * 12 + 4, 0);
+        put16(segment.data() + ifdPosition, static_cast<uint16_t>(kept.size()));
+
+        std::vector<std::pair<size_t, uint32_t>> subIFDs; // Entry position, file offset
+        for (size_t i = 0; i < kept.size(); ++i) {
+            size_t entryPosition = ifdPosition + 2 + i * 12;
+            std::memcpy(segment.data() + entryPosition, kept[i], 12);
+            uint16_t tag = get16(kept[i]);
+            uint32_t valueSize = formatSize(get16(kept[i] + 2)) * get32(kept[i] + 4);
+            if (followSubIFDs && (tag == TagExifIFD || tag == TagGPSIFD)) {
+                subIFDs.emplace_back(entryPosition, get32(kept[i] + 8));
+            } else if (valueSize > 4 && !copyValue(entryPosition, get32(kept[i] + 8), valueSize)) {
+                dropEntry(entryPosition);
+            }
+        }
+        for (const auto& subIFD : subIFDs) {
+            uint32_t subIFDOffset = copyIFD(subIFD.second, false);
+            if (subIFDOffset == 0) {
+                dropEntry(subIFD.first);
+                continue;
+            }
+            // Some writers type the pointer as IFD (13), which the parser
+            // does not know
+            put16(segment.data() + subIFD.first + 2, 4);
+            put32(segment.data() + subIFD.first + 8, subIFDOffset);
+        }
+        return static_cast<uint32_t>(ifdPosition - SignatureSize);
+    }
+
+    uint16_t get16(const uint8_t* data) const {
+        return alignIntel ? static_cast<uint16_t>(data[0] | (data[1] << 8))
+                          : static_cast<uint16_t>((data[0] << 8) | data[1]);
+    }
+    uint32_t get32(const uint8_t* data) const {
+        return alignIntel ? (static_cast<uint32_t>(data[0]) | (static_cast<uint32_t>(data[1]) << 8) |
+                             (static_cast<uint32_t>(data[2]) << 16) | (static_cast<uint32_t>(data[3]) << 24))
+                          : ((static_cast<uint32_t>(data[0]) << 24) | (static_cast<uint32_t>(data[1]) << 16) |
+                             (static_cast<uint32_t>(data[2]) << 8) | static_cast<uint32_t>(data[3]));
+    }
+    void put16(uint8_t* data, uint16_t value) const {
+        data[alignIntel ? 0 : 1] = static_cast<uint8_t>(value);
+        data[alignIntel ? 1 : 0] = static_cast<uint8_t>(value >> 8);
+    }
+    void put32(uint8_t* data, uint32_t value) const {
+        for (int i = 0; i < 4; ++i) {
+            data[alignIntel ? i : 3 - i] = static_cast<uint8_t>(value >> (8 * i));
+        }
+    }
+
+private:
+    // An entry of unknown type is skipped by the parser
+    void dropEntry(size_t entryPosition) {
+        put16(segment.data() + entryPosition + 2, 0);
+    }
+
+    // Appends a value stored outside its entry and points the entry at it
+    bool copyValue(size_t entryPosition, uint32_t fileOffset, uint32_t valueSize) {
+        size_t valuePosition = segment.size();
+        if (valuePosition + valueSize + 1 > MaxSegmentSize) return false;
+        segment.resize(valuePosition + valueSize + (valueSize & 1)); // Values start on word boundaries
+        if (!file.read(fileOffset, segment.data() + valuePosition, valueSize)) {
+            segment.resize(valuePosition);
+            return false;
+        }
+        put32(segment.data() + entryPosition + 8, static_cast<uint32_t>(valuePosition - SignatureSize));
+        return true;
+    }
+
+    PositionedFile& file;
+    bool alignIntel;
+    std::vector<uint8_t>& segment;
+};
+
+// Looks up the ID of the first 'Exif' item in the 'iinf' box
+bool findExifItem(PositionedFile& file, uint64_t start, uint64_t end, uint32_t& itemId) {
+    uint8_t fullBox[4];
+    if (!file.read(start, fullBox, 4)) return false;
+    uint64_t offset = start + 4;
+    uint64_t entryCount;
+    if (!ISOBMFFBox::readBigEndian(file, offset, fullBox[0] == 0 ? 2 : 4, entryCount)) return false;
+    for (uint64_t i = 0; i < entryCount && i < ISOBMFFBox::maxBoxesPerLevel; ++i) {
+        ISOBMFFBox infe;
+        if (!ISOBMFFBox::find(file, offset, end, "infe", infe)) return false;
+        offset = infe.contentEnd;
+        uint64_t entryStart = infe.contentStart, entryEnd = infe.contentEnd;
+        // Item types only exist from infe version 2 on
+        uint8_t entry[12];
+        if (entryEnd - entryStart < 12 || !file.read(entryStart, entry, sizeof(entry))) continue;
+        unsigned version = entry[0];
+        if (version < 2) continue;
+        unsigned idSize = version == 2 ? 2 : 4;
+        // item_ID, item_protection_index (2), item_type (4)
+        if (entryEnd - entryStart < 4 + idSize + 2 + 4) continue;
+        uint8_t itemType[4];
+        if (!file.read(entryStart + 4 + idSize + 2, itemType, 4)) return false;
+        if (std::memcmp(itemType, "Exif", 4) == 0) {
+            itemId = ISOBMFFBox::getBigEndian(entry + 4, idSize);
+            return true;
+        }
+    }
+    return false;
+}
+
+struct ItemExtent {
+    uint64_t offset;
+    uint64_t length;
+};
+
+// Reads where the item's data lives from the 'iloc' box. Offsets are
+// absolute file offsets, or relative to the 'idat' box when 'inIdat' is set.
+bool findItemLocation(PositionedFile& file, uint64_t start, uint32_t itemId,
+                      std::vector<ItemExtent>& extents, bool& inIdat) {
+    uint8_t header[6];
+    if (!file.read(start, header, sizeof(header))) return false;
+    unsigned version = header[0];
+    if (version > 2) return false;
+    unsigned offsetSize = header[4] >> 4;
+    unsigned lengthSize = header[4] & 0x0F;
+    unsigned baseOffsetSize = header[5] >> 4;
+    unsigned indexSize = version > 0 ? (header[5] & 0x0F) : 0;
+    uint64_t offset = start + 6;
+    uint64_t itemCount;
+    if (!ISOBMFFBox::readBigEndian(file, offset, version < 2 ? 2 : 4, itemCount)) return false;
+    for (uint64_t i = 0; i < itemCount && i < ISOBMFFBox::maxBoxesPerLevel; ++i) {
+        uint64_t id, constructionMethod = 0, dataReferenceIndex, baseOffset, extentCount;
+        if (!ISOBMFFBox::readBigEndian(file, offset, version < 2 ? 2 : 4, id)) return false;
+        if (version > 0 && !ISOBMFFBox::readBigEndian(file, offset, 2, constructionMethod)) return false;
+        if (!ISOBMFFBox::readBigEndian(file, offset, 2, dataReferenceIndex) ||
+            !ISOBMFFBox::readBigEndian(file, offset, baseOffsetSize, baseOffset) ||
+            !ISOBMFFBox::readBigEndian(file, offset, 2, extentCount)) {
+            return false;
+        }
+        for (uint64_t e = 0; e < extentCount; ++e) {
+            uint64_t extentIndex, extentOffset, extentLength;
+            if (!ISOBMFFBox::readBigEndian(file, offset, indexSize, extentIndex) ||
+                !ISOBMFFBox::readBigEndian(file, offset, offsetSize, extentOffset) ||
+                !ISOBMFFBox::readBigEndian(file, offset, lengthSize, extentLength)) {
+                return false;
+            }
+            if (id == itemId) {
+                extents.push_back({baseOffset + extentOffset, extentLength});
+            }
+        }
+        if (id == itemId) {
+            // 0 = file offsets, 1 = idat offsets; data in other items or
+            // other files is not supported
+            constructionMethod &= 0x0F;
+            inIdat = constructionMethod == 1;
+            return constructionMethod <= 1 && dataReferenceIndex == 0 && !extents.empty();
+        }
+    }
+    return false;
+}
+
+}
+
+int EXIFSegmentReader::readFromJPEG(const std::string& filePath, std::vector<uint8_t>& segment) {
+    segment.clear();
+    std::ifstream file(filePath, std::ios::binary);
+    if (!file) {
+        return PARSE_EXIF_ERROR_FILE_ACCESS;
+    }
+
+    // All JPEG files start with 0xFFD8
+    uint8_t header[2];
+    if (!readBytes(file, header, 2) || header[0] != 0xFF || header[1] != MarkerSOI) {
+        return PARSE_EXIF_ERROR_NO_JPEG;
+    }
+
+    while (true) {
+        // Every segment starts with 0xFF followed by the marker code. Any
+        // number of 0xFF fill bytes may precede the marker code.
+        uint8_t byte = 0;
+        if (!readBytes(file, &byte, 1)) return PARSE_EXIF_ERROR_NO_EXIF;
+        if (byte != 0xFF) return PARSE_EXIF_ERROR_CORRUPT;
+        uint8_t marker = 0xFF;
+        while (marker == 0xFF) {
+            if (!readBytes(file, &marker, 1)) return PARSE_EXIF_ERROR_NO_EXIF;
+        }
+
+        if (marker == MarkerSOS || marker == MarkerEOI) {
+            // EXIF is always stored ahead of the image data
+            return PARSE_EXIF_ERROR_NO_EXIF;
+        }
+        if (isStandaloneMarker(marker)) {
+            continue;
+        }
+
+        // The segment length is in Motorola byte order and includes its own
+        // two bytes
+        uint8_t lengthBytes[2];
+        if (!readBytes(file, lengthBytes, 2)) return PARSE_EXIF_ERROR_CORRUPT;
+        unsigned segmentLength = (static_cast<unsigned>(lengthBytes[0]) << 8) | lengthBytes[1];
+        if (segmentLength < 2) return PARSE_EXIF_ERROR_CORRUPT;
+        unsigned payloadLength = segmentLength - 2;
+
+        if (marker == MarkerAPP1 && payloadLength >= 6) {
+            // APP1 is also used for XMP packets, so check for the EXIF
+            // signature before reading the rest of the payload
+            uint8_t signature[6];
+            if (!readBytes(file, signature, 6)) return PARSE_EXIF_ERROR_CORRUPT;
+            if (std::equal(signature, signature + 6, "Exif\0\0")) {
+                // The segment has to contain at least the TIFF header
+                // (see EXIFInfo::parseFrom)
+                if (payloadLength < 14) return PARSE_EXIF_ERROR_CORRUPT;
+                segment.resize(payloadLength);
+                std::copy(signature, signature + 6, segment.begin());
+                if (!readBytes(file, segment.data() + 6, payloadLength - 6)) {
+                    segment.clear();
+                    return PARSE_EXIF_ERROR_CORRUPT;
+                }
+                return PARSE_EXIF_SUCCESS;
+            }
+            payloadLength -= 6;
+        }
+
+        // Skip over the segment without reading it
+        file.seekg(payloadLength, std::ios::cur);
+        if (!file) return PARSE_EXIF_ERROR_CORRUPT;
+    }
+}
+
+int EXIFSegmentReader::readFromTIFF(const std::string& filePath, std::vector<uint8_t>& segment) {
+    segment.clear();
+    PositionedFile file(filePath);
+    if (!file.isOpen()) {
+        return PARSE_EXIF_ERROR_FILE_ACCESS;
+    }
+
+    // "II" or "MM", the magic number and the offset of IFD0
+    uint8_t header[8];
+    if (!file.read(0, header, sizeof(header))) return PARSE_EXIF_ERROR_NO_EXIF;
+    bool alignIntel;
+    if (header[0] == 'I' && header[1] == 'I') {
+        alignIntel = true;
+    } else if (header[0] == 'M' && header[1] == 'M') {
+        alignIntel = false;
+    } else {
+        return PARSE_EXIF_ERROR_NO_EXIF;
+    }
+    TIFFRepacker repacker(file, alignIntel, segment);
+    uint16_t magic = repacker.get16(header + 2);
+    // TIFF/DNG/CR2/NEF use 42; Olympus ORF uses "RO"/"RS" and Panasonic 0x55
+    if (magic != 0x2a && magic != 0x4f52 && magic != 0x5352 && magic != 0x55) {
+        return PARSE_EXIF_ERROR_NO_EXIF;
+    }
+    uint32_t firstIFDOffset = repacker.get32(header + 4);
+
+    // The rebuilt header always says 42 so the EXIF parser accepts it
+    segment.assign({'E', 'x', 'i', 'f', 0, 0, header[0], header[1], 0, 0, 0, 0, 0, 0});
+    repacker.put16(segment.data() + SignatureSize + 2, 0x2a);
+    repacker.put32(segment.data() + SignatureSize + 4, 8);
+    if (repacker.copyIFD(firstIFDOffset, true) == 0) {
+        segment.clear();
+        return PARSE_EXIF_ERROR_CORRUPT;
+    }
+    return PARSE_EXIF_SUCCESS;
+}
+
+int EXIFSegmentReader::readFromHEIF(const std::string& filePath, std::vector<uint8_t>& segment) {
+    segment.clear();
+    PositionedFile file(filePath);
+    if (!file.isOpen()) {
+        return PARSE_EXIF_ERROR_FILE_ACCESS;
+    }
+    const uint64_t fileEnd = UINT64_MAX; // Box sizes bound every read
+
+    // ftyp > meta > iinf (which item is Exif) + iloc (where it is)
+    ISOBMFFBox ftyp, meta, iinf, iloc;
+    if (!ISOBMFFBox::find(file, 0, fileEnd, "ftyp", ftyp) || ftyp.start != 0) {
+        return PARSE_EXIF_ERROR_NO_EXIF;
+    }
+    if (!ISOBMFFBox::find(file, ftyp.contentEnd, fileEnd, "meta", meta)) {
+        return PARSE_EXIF_ERROR_NO_EXIF;
+    }
+    uint64_t metaStart = meta.contentStart + 4; // meta is a full box - skip version and flags
+    uint32_t exifItemId;
+    if (!ISOBMFFBox::find(file, metaStart, meta.contentEnd, "iinf", iinf) ||
+        !findExifItem(file, iinf.contentStart, iinf.contentEnd, exifItemId)) {
+        return PARSE_EXIF_ERROR_NO_EXIF;
+    }
+    std::vector<ItemExtent> extents;
+    bool inIdat = false;
+    if (!ISOBMFFBox::find(file, metaStart, meta.contentEnd, "iloc", iloc) ||
+        !findItemLocation(file, iloc.contentStart, exifItemId, extents, inIdat)) {
+        return PARSE_EXIF_ERROR_CORRUPT;
+    }
+    uint64_t baseOffset = 0;
+    if (inIdat) {
+        ISOBMFFBox idat;
+        if (!ISOBMFFBox::find(file, metaStart, meta.contentEnd, "idat", idat)) return PARSE_EXIF_ERROR_CORRUPT;
+        baseOffset = idat.contentStart;
+    }
+
+    // Read just the Exif item
+    std::vector<uint8_t> item;
+    for (const ItemExtent& extent : extents) {
+        if (extent.length > MaxSegmentSize - item.size()) return PARSE_EXIF_ERROR_CORRUPT;
+        size_t itemSize = item.size();
+        item.resize(itemSize + extent.length);
+        if (!file.read(baseOffset + extent.offset, item.data() + itemSize, extent.length)) {
+            return PARSE_EXIF_ERROR_CORRUPT;
+        }
+    }
+
+    // The item starts with the offset of the TIFF header within the rest of
+    // the item (which usually begins with "Exif\0\0")
+    if (item.size() < 4) return PARSE_EXIF_ERROR_CORRUPT;
+    uint64_t tiffStart = 4 + static_cast<uint64_t>(ISOBMFFBox::getBigEndian(item.data(), 4));
+    if (tiffStart + 8 > item.size()) return PARSE_EXIF_ERROR_CORRUPT;
+    segment.reserve(SignatureSize + item.size() - tiffStart);
+    segment.assign({'E', 'x', 'i', 'f', 0, 0});
+    segment.insert(segment.end(), item.begin() + tiffStart, item.end());
+    return PARSE_EXIF_SUCCESS;
+}
+
+int EXIFSegmentReader::readFromFile(const std::string& filePath, std::vector<uint8_t>& segment) {
+    // Picks the container from its signature rather than the extension
+    uint8_t signature[8];
+    {
+        PositionedFile file(filePath);
+        if (!file.isOpen()) {
+            segment.clear();
+            return PARSE_EXIF_ERROR_FILE_ACCESS;
+        }
+        if (!file.read(0, signature, sizeof(signature))) {
+            segment.clear();
+            return PARSE_EXIF_ERROR_NO_JPEG;
+        }
+    }
+    if (std::memcmp(signature + 4, "ftyp", 4) == 0) {
+        return readFromHEIF(filePath, segment);
+    }
+    if ((signature[0] == 'I' && signature[1] == 'I') || (signature[0] == 'M' && signature[1] == 'M')) {
+        return readFromTIFF(filePath, segment);
+    }
+    return readFromJPEG(filePath, segment);
+}
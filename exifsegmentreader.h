@@ -0,0 +1,48 @@
+#ifndef EXIFSEGMENTREADER_H
+#define EXIFSEGMENTREADER_H
+
+/***********************************************************************
+ * File Name: exifsegmentreader.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the EXIFSegmentReader class, which locates
+ *              the EXIF block inside an image file without loading the whole
+ *              file into memory. The JPEG reader walks the marker segment
+ *              headers from the start of the file, reads only the APP1
+ *              "Exif" payload and stops, so scan I/O no longer grows with
+ *              the size of the image data. TIFF based RAW files (CR2, NEF,
+ *              ORF, DNG, TIFF) keep their EXIF in IFDs near the start of the
+ *              file; the TIFF reader follows the IFD offsets with positioned
+ *              reads and repacks just those IFDs into an EXIF segment.
+ *              HEIF/HEIC files store EXIF as an item of the ISOBMFF 'meta'
+ *              box; only the box headers and that item are read.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class EXIFSegmentReader
+{
+public:
+    // Reads the APP1 EXIF payload (starting with "Exif\0\0") of a JPEG file
+    // into 'segment'. Returns PARSE_EXIF_SUCCESS or a PARSE_EXIF_ERROR_* code.
+    static int readFromJPEG(const std::string& filePath, std::vector<uint8_t>& segment);
+    // Builds an EXIF segment (as readFromJPEG returns) from the IFD0, EXIF
+    // and GPS IFDs of a TIFF container
+    static int readFromTIFF(const std::string& filePath, std::vector<uint8_t>& segment);
+    // Reads the Exif item of a HEIF/HEIC file and returns it as an EXIF
+    // segment
+    static int readFromHEIF(const std::string& filePath, std::vector<uint8_t>& segment);
+    // Picks the reader from the first bytes of the file
+    static int readFromFile(const std::string& filePath, std::vector<uint8_t>& segment);
+
+private:
+    EXIFSegmentReader() = delete;
+};
+
+// The file could not be opened or read
+#define PARSE_EXIF_ERROR_FILE_ACCESS          1986
+
+#endif // EXIFSEGMENTREADER_H
@@ -0,0 +1,395 @@
+/***********************************************************************
+ * File Name: filecopier.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the FileCopier class. Each Linux copy method
+ *              picks up at the offset where the previous one gave up, so a
+ *              copy_file_range that is refused part way through (for example
+ *              across file systems on older kernels) finishes in the buffered
+ *              loop instead of starting over. A hashed copy goes straight to
+ *              the buffered loop, and the hash is taken from the same buffer
+ *              the data is written from.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cerrno>
+#include <fstream>
+#include <system_error>
+#include <vector>
+#include "filecopier.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#elif defined(_WIN32)
+#include <fcntl.h>
+#include <io.h>
+#endif
+
+#ifdef __linux__
+#include <algorithm>
+#include <cerrno>
+#include <vector>
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <linux/fs.h>
+#endif
+
+namespace {
+
+[[noreturn]] void throwCopyError(const std::filesystem::path& sourcePath,
+                                 const std::filesystem::path& targetPath, int error) {
+    throw std::filesystem::filesystem_error("copy_file", sourcePath, targetPath,
+                                            std::error_code(error, std::generic_category()));
+}
+
+#ifdef __linux__
+
+// Closes the descriptor when it goes out of scope
+class FileDescriptor
+{
+public:
+    explicit FileDescriptor(int fd) : fd(fd) {}
+    ~FileDescriptor() { if (fd >= 0) ::close(fd); }
+    FileDescriptor(const FileDescriptor&) = delete;
+    FileDescriptor& operator=(const FileDescriptor&) = delete;
+    int get() const { return fd; }
+    int release() { int result = fd; fd = -1; return result; }
+private:
+    int fd;
+};
+
+// Errors meaning the method is not available for this pair of files, as
+// opposed to the copy itself failing
+bool isUnsupported(int error) {
+    return error == EXDEV || error == ENOSYS || error == EINVAL || error == EOPNOTSUPP ||
+           error == ENOTTY || error == EBADF || error == EPERM || error == ETXTBSY;
+}
+
+bool tryReflink(int sourceFd, int targetFd) {
+#ifdef FICLONE
+    return ::ioctl(targetFd, FICLONE, sourceFd) == 0;
+#else
+    (void)sourceFd;
+    (void)targetFd;
+    return false;
+#endif
+}
+
+// Returns false if the kernel refused before the whole file was copied.
+// 'offset' is advanced past the copied bytes either way.
+bool tryCopyFileRange(int sourceFd, int targetFd, off_t fileSize, off_t& offset, int& error,
+                      const FileCopier::ProgressCallback& onBytesCopied) {
+    while (offset < fileSize) {
+        loff_t sourceOffset = offset;
+        loff_t targetOffset = offset;
+        // Copied in chunks so progress can be reported
+        size_t chunkSize = static_cast<size_t>(std::min<off_t>(fileSize - offset, FileCopier::bufferSize));
+        ssize_t copied = ::copy_file_range(sourceFd, &sourceOffset, targetFd, &targetOffset, chunkSize, 0);
+        if (copied < 0) {
+            if (errno == EINTR) continue;
+            error = isUnsupported(errno) ? 0 : errno;
+            return false;
+        }
+        if (copied == 0) {
+            break; // Source was truncated while copying
+        }
+        offset += copied;
+        if (onBytesCopied) onBytesCopied(static_cast<uint64_t>(copied));
+    }
+    return true;
+}
+
+bool bufferedCopy(int sourceFd, int targetFd, off_t offset, int& error,
+                  const FileCopier::ProgressCallback& onBytesCopied, ContentHasher* hasher) {
+    ::posix_fadvise(sourceFd, offset, 0, POSIX_FADV_SEQUENTIAL);
+    // Transfers run on several threads, each keeps its own buffer
+    thread_local std::vector<char> buffer(FileCopier::bufferSize);
+    while (true) {
+        ssize_t bytesRead = ::pread(sourceFd, buffer.data(), buffer.size(), offset);
+        if (bytesRead < 0) {
+            if (errno == EINTR) continue;
+            error = errno;
+            return false;
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+        if (hasher) {
+            hasher->update(buffer.data(), static_cast<size_t>(bytesRead));
+        }
+        ssize_t written = 0;
+        while (written < bytesRead) {
+            ssize_t result = ::pwrite(targetFd, buffer.data() + written,
+                                      static_cast<size_t>(bytesRead - written), offset + written);
+            if (result < 0) {
+                if (errno == EINTR) continue;
+                error = errno;
+                return false;
+            }
+            written += result;
+        }
+        offset += bytesRead;
+        if (onBytesCopied) onBytesCopied(static_cast<uint64_t>(bytesRead));
+    }
+    // The source pages are not needed again
+    ::posix_fadvise(sourceFd, 0, 0, POSIX_FADV_DONTNEED);
+    return true;
+}
+
+FileCopier::CopyMethod copyFileLinux(const std::filesystem::path& sourcePath,
+                                     const std::filesystem::path& targetPath, bool overwrite,
+                                     const FileCopier::ProgressCallback& onBytesCopied, ContentHasher* hasher) {
+    FileDescriptor source(::open(sourcePath.c_str(), O_RDONLY | O_CLOEXEC));
+    if (source.get() < 0) {
+        throwCopyError(sourcePath, targetPath, errno);
+    }
+    struct stat sourceStat;
+    if (::fstat(source.get(), &sourceStat) != 0) {
+        throwCopyError(sourcePath, targetPath, errno);
+    }
+    if (!S_ISREG(sourceStat.st_mode)) {
+        throwCopyError(sourcePath, targetPath, EINVAL);
+    }
+
+    struct stat targetStat;
+    bool targetExists = ::stat(targetPath.c_str(), &targetStat) == 0;
+    if (targetExists) {
+        if (!overwrite) {
+            return FileCopier::CopyMethod::None;
+        }
+        // Truncating the target would destroy the source
+        if (targetStat.st_dev == sourceStat.st_dev && targetStat.st_ino == sourceStat.st_ino) {
+            throwCopyError(sourcePath, targetPath, EEXIST);
+        }
+    }
+
+    int flags = O_WRONLY | O_CREAT | O_CLOEXEC | (overwrite ? O_TRUNC : O_EXCL);
+    FileDescriptor target(::open(targetPath.c_str(), flags, sourceStat.st_mode & 07777));
+    if (target.get() < 0) {
+        if (errno == EEXIST && !overwrite) {
+            return FileCopier::CopyMethod::None; // Created by someone else meanwhile
+        }
+        throwCopyError(sourcePath, targetPath, errno);
+    }
+    if (targetExists) {
+        ::fchmod(target.get(), sourceStat.st_mode & 07777);
+    }
+
+    FileCopier::CopyMethod method;
+    int error = 0;
+    off_t offset = 0;
+    bool copied;
+    if (!hasher && tryReflink(source.get(), target.get())) {
+        method = FileCopier::CopyMethod::Reflink;
+        copied = true;
+        if (onBytesCopied) onBytesCopied(static_cast<uint64_t>(sourceStat.st_size));
+    } else if (!hasher &&
+               tryCopyFileRange(source.get(), target.get(), sourceStat.st_size, offset, error, onBytesCopied)) {
+        method = FileCopier::CopyMethod::CopyFileRange;
+        copied = true;
+    } else {
+        method = FileCopier::CopyMethod::BufferedCopy;
+        copied = error == 0 && bufferedCopy(source.get(), target.get(), offset, error, onBytesCopied, hasher);
+    }
+
+    if (!copied || ::close(target.release()) != 0) {
+        if (error == 0) error = errno;
+        if (!targetExists) {
+            ::unlink(targetPath.c_str()); // Do not leave a partial copy behind
+        }
+        throwCopyError(sourcePath, targetPath, error);
+    }
+    return method;
+}
+
+#else
+
+// Hashed copies on other platforms, which std::filesystem::copy_file
+// cannot do
+FileCopier::CopyMethod hashedCopyPortable(const std::filesystem::path& sourcePath,
+                                          const std::filesystem::path& targetPath, bool overwrite,
+                                          const FileCopier::ProgressCallback& onBytesCopied, ContentHasher& hasher) {
+    std::error_code ec;
+    bool targetExists = std::filesystem::exists(targetPath, ec);
+    if (targetExists) {
+        if (!overwrite) {
+            return FileCopier::CopyMethod::None;
+        }
+        if (std::filesystem::equivalent(sourcePath, targetPath, ec)) {
+            throwCopyError(sourcePath, targetPath, EEXIST);
+        }
+    }
+    std::ifstream source(sourcePath, std::ios::binary);
+    if (!source) {
+        throwCopyError(sourcePath, targetPath, ENOENT);
+    }
+    std::ofstream target(targetPath, std::ios::binary | std::ios::trunc);
+    if (!target) {
+        throwCopyError(sourcePath, targetPath, EACCES);
+    }
+    thread_local std::vector<char> buffer(FileCopier::bufferSize);
+    bool copied = true;
+    while (source) {
+        source.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize bytesRead = source.gcount();
+        if (bytesRead <= 0) {
+            break;
+        }
+        hasher.update(buffer.data(), static_cast<size_t>(bytesRead));
+        if (!target.write(buffer.data(), bytesRead)) {
+            copied = false;
+            break;
+        }
+        if (onBytesCopied) onBytesCopied(static_cast<uint64_t>(bytesRead));
+    }
+    copied = copied && !source.bad();
+    target.close();
+    if (!copied || target.fail()) {
+        if (!targetExists) {
+            std::filesystem::remove(targetPath, ec); // Do not leave a partial copy behind
+        }
+        throwCopyError(sourcePath, targetPath, EIO);
+    }
+    std::filesystem::permissions(targetPath, std::filesystem::status(sourcePath).permissions(), ec);
+    return FileCopier::CopyMethod::Portable;
+}
+
+#endif
+
+}
+
+FileCopier::CopyMethod FileCopier::copyFile(const std::filesystem::path& sourcePath,
+                                            const std::filesystem::path& targetPath,
+                                            bool overwrite,
+                                            const ProgressCallback& onBytesCopied,
+                                            ContentHasher* hasher) {
+#ifdef __linux__
+    return copyFileLinux(sourcePath, targetPath, overwrite, onBytesCopied, hasher);
+#else
+    if (hasher) {
+        return hashedCopyPortable(sourcePath, targetPath, overwrite, onBytesCopied, *hasher);
+    }
+    auto options = overwrite ? std::filesystem::copy_options::overwrite_existing
+                             : std::filesystem::copy_options::skip_existing;
+    if (!std::filesystem::copy_file(sourcePath, targetPath, options)) {
+        return CopyMethod::None;
+    }
+    if (onBytesCopied) onBytesCopied(std::filesystem::file_size(targetPath));
+    return CopyMethod::Portable;
+#endif
+}
+
+const char* FileCopier::getCopyMethodName(CopyMethod method) {
+    switch (method) {
+    case CopyMethod::None: return "skipped";
+    case CopyMethod::Reflink: return "reflink";
+    case CopyMethod::CopyFileRange: return "copy_file_range";
+    case CopyMethod::BufferedCopy: return "buffered copy";
+    case CopyMethod::Portable: return "copy_file";
+    }
+    return "unknown";
+}
+
+bool FileCopier::syncFile(const std::filesystem::path& filePath, std::error_code& error) {
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(filePath.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0 || ::fsync(fd) != 0) {
+        error = std::error_code(errno, std::generic_category());
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    ::close(fd);
+#elif defined(_WIN32)
+    int fd = ::_wopen(filePath.c_str(), _O_RDWR | _O_BINARY);
+    if (fd < 0 || ::_commit(fd) != 0) {
+        error = std::error_code(errno, std::generic_category());
+        if (fd >= 0) ::_close(fd);
+        return false;
+    }
+    ::_close(fd);
+#else
+    (void)filePath;
+#endif
+    error.clear();
+    return true;
+}
+
+bool FileCopier::syncFile(std::FILE* file, std::error_code& error) {
+#if defined(__unix__) || defined(__APPLE__)
+    if (::fsync(::fileno(file)) != 0) {
+        error = std::error_code(errno, std::generic_category());
+        return false;
+    }
+#elif defined(_WIN32)
+    if (::_commit(::_fileno(file)) != 0) {
+        error = std::error_code(errno, std::generic_category());
+        return false;
+    }
+#else
+    (void)file;
+#endif
+    error.clear();
+    return true;
+}
+
+// New directory entries are only durable once the directory itself is
+// synced. Windows has no equivalent (NTFS journals its metadata).
+bool FileCopier::syncDirectory(const std::filesystem::path& directoryPath, std::error_code& error) {
+#if defined(__unix__) || defined(__APPLE__)
+    int fd = ::open(directoryPath.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+    if (fd < 0 || ::fsync(fd) != 0) {
+        error = std::error_code(errno, std::generic_category());
+        if (fd >= 0) ::close(fd);
+        return false;
+    }
+    ::close(fd);
+#else
+    (void)directoryPath;
+#endif
+    error.clear();
+    return true;
+}
+
+// O_DIRECT would bypass the cache without the sync, but it needs aligned
+// buffers and is refused by some file systems (tmpfs, FUSE); dropping the
+// synced pages works everywhere. Other platforms read the file as is.
+bool FileCopier::hashFileFromDisk(const std::filesystem::path& filePath, uint64_t& hash, std::error_code& error) {
+#ifdef __linux__
+    FileDescriptor file(::open(filePath.c_str(), O_RDONLY | O_CLOEXEC));
+    if (file.get() < 0 || ::fdatasync(file.get()) != 0) {
+        error = std::error_code(errno, std::generic_category());
+        return false;
+    }
+    ::posix_fadvise(file.get(), 0, 0, POSIX_FADV_DONTNEED);
+    ::posix_fadvise(file.get(), 0, 0, POSIX_FADV_SEQUENTIAL);
+    thread_local std::vector<char> buffer(bufferSize);
+    ContentHasher hasher;
+    off_t offset = 0;
+    while (true) {
+        ssize_t bytesRead = ::pread(file.get(), buffer.data(), buffer.size(), offset);
+        if (bytesRead < 0) {
+            if (errno == EINTR) continue;
+            error = std::error_code(errno, std::generic_category());
+            return false;
+        }
+        if (bytesRead == 0) {
+            break;
+        }
+        hasher.update(buffer.data(), static_cast<size_t>(bytesRead));
+        offset += bytesRead;
+    }
+    ::posix_fadvise(file.get(), 0, 0, POSIX_FADV_DONTNEED);
+    hash = hasher.digest();
+#else
+    if (!ContentHasher::hashFile(filePath.string(), hash)) {
+        error = std::make_error_code(std::errc::io_error);
+        return false;
+    }
+#endif
+    error.clear();
+    return true;
+}
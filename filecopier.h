@@ -0,0 +1,74 @@
+#ifndef FILECOPIER_H
+#define FILECOPIER_H
+
+/***********************************************************************
+ * File Name: filecopier.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the FileCopier class, which copies a single
+ *              file using the cheapest method the platform and file systems
+ *              allow. On Linux a reflink (FICLONE) is tried first, so copies
+ *              within a copy-on-write volume (btrfs, XFS) only share extents,
+ *              then copy_file_range lets the kernel copy without bouncing the
+ *              data through user space, and finally a large-buffer read/write
+ *              loop with sequential read-ahead hints is used. Other platforms
+ *              use std::filesystem::copy_file. A copy can hash the bytes as
+ *              they pass through the buffer, so verifying it does not read
+ *              the source a second time.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <functional>
+#include "contenthasher.h"
+
+class FileCopier
+{
+public:
+    enum class CopyMethod {
+        None,          // Nothing copied (target exists and overwrite is disabled)
+        Reflink,
+        CopyFileRange,
+        BufferedCopy,
+        Portable       // std::filesystem::copy_file
+    };
+
+    // Receives the number of bytes written since the previous call
+    using ProgressCallback = std::function<void(uint64_t bytesCopied)>;
+
+    // Copies 'sourcePath' to 'targetPath' with the permissions of the source.
+    // Like std::filesystem::copy, an existing target is skipped unless
+    // 'overwrite' is set. 'onBytesCopied' is called as data is written, at
+    // most 'bufferSize' bytes apart (a reflink is reported in one call).
+    // If 'hasher' is given every byte copied is fed to it; the copy is then
+    // always made through the buffer, as a reflink or copy_file_range never
+    // passes the data through user space.
+    // Throws std::filesystem::filesystem_error on failure.
+    static CopyMethod copyFile(const std::filesystem::path& sourcePath,
+                               const std::filesystem::path& targetPath,
+                               bool overwrite,
+                               const ProgressCallback& onBytesCopied = {},
+                               ContentHasher* hasher = nullptr);
+    static const char* getCopyMethodName(CopyMethod method);
+
+    // Flush a file's data, or a directory's entries, to stable storage.
+    // Return false (with 'error' set) on failure.
+    static bool syncFile(const std::filesystem::path& filePath, std::error_code& error);
+    // Syncs a file already open for writing, after its buffer is flushed
+    static bool syncFile(std::FILE* file, std::error_code& error);
+    static bool syncDirectory(const std::filesystem::path& directoryPath, std::error_code& error);
+    // Hashes a file as stored on the device: its data is synced and dropped
+    // from the page cache before it is read, so a freshly written copy is
+    // not just read back from memory. Returns false (with 'error' set) on
+    // failure.
+    static bool hashFileFromDisk(const std::filesystem::path& filePath, uint64_t& hash, std::error_code& error);
+
+    static constexpr size_t bufferSize = 4 << 20;
+
+private:
+    FileCopier() = delete;
+};
+
+#endif // FILECOPIER_H
@@ -15,6 +15,8 @@
  * License: MIT License
  ***********************************************************************/
 
+#include <algorithm>
+#include <cctype>
 #include <memory>
 #include <map>
 #include <string>
@@ -94,12 +96,33 @@ struct FileFactory
         }
     }
 
-    // Creates a file handler based on the file's extension
-    std::unique_ptr<BasicFileHandler> makeFileHandler(const std::string filePath) {
+    // Returns the file extension without the leading dot, in lower case
+    // (cameras name their files "IMG_0001.JPG")
+    static std::string getExtension(const std::string& filePath) {
         std::filesystem::path path(filePath);
         std::string extension = path.has_extension() ? path.extension().string().substr(1) : "";
+        std::transform(extension.begin(), extension.end(), extension.begin(),
+                       [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+        return extension;
+    }
+
+    // Checks whether the file would be handled by a PhotoFileHandler
+    bool isPhotoFile(const std::string& filePath) const {
+        auto it = file_factories.find(getExtension(filePath));
+        return it != file_factories.end() &&
+               dynamic_cast<const PhotoFileHandlerFactory*>(it->second.get()) != nullptr;
+    }
 
-        auto it = file_factories.find(extension);
+    // Checks whether the file would be handled by a VideoFileHandler
+    bool isVideoFile(const std::string& filePath) const {
+        auto it = file_factories.find(getExtension(filePath));
+        return it != file_factories.end() &&
+               dynamic_cast<const VideoFileHandlerFactory*>(it->second.get()) != nullptr;
+    }
+
+    // Creates a file handler based on the file's extension
+    std::unique_ptr<BasicFileHandler> makeFileHandler(const std::string filePath) {
+        auto it = file_factories.find(getExtension(filePath));
         if (it != file_factories.end()) {
             return it->second->make(filePath);
         } else {
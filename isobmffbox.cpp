@@ -0,0 +1,66 @@
+/***********************************************************************
+ * File Name: isobmffbox.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the ISOBMFFBox class. All numbers in the
+ *              box structure are big endian.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstring>
+#include "isobmffbox.h"
+
+bool ISOBMFFBox::readHeader(PositionedFile& file, uint64_t offset, uint64_t end) {
+    uint8_t header[16];
+    if (offset > end || end - offset < 8 || !file.read(offset, header, 8)) return false;
+    uint64_t boxSize = getBigEndian(header, 4);
+    uint64_t headerSize = 8;
+    if (boxSize == 1) {
+        // 64-bit size follows the type
+        if (!file.read(offset + 8, header + 8, 8)) return false;
+        boxSize = (static_cast<uint64_t>(getBigEndian(header + 8, 4)) << 32) | getBigEndian(header + 12, 4);
+        headerSize = 16;
+    } else if (boxSize == 0) {
+        boxSize = end - offset; // Runs to the end of the enclosing box
+    }
+    if (boxSize < headerSize || boxSize > end - offset) return false;
+    std::memcpy(type, header + 4, 4);
+    start = offset;
+    contentStart = offset + headerSize;
+    contentEnd = offset + boxSize;
+    return true;
+}
+
+bool ISOBMFFBox::isType(const char* boxType) const {
+    return std::memcmp(type, boxType, 4) == 0;
+}
+
+bool ISOBMFFBox::find(PositionedFile& file, uint64_t start, uint64_t end, const char* boxType, ISOBMFFBox& box) {
+    uint64_t offset = start;
+    for (unsigned i = 0; i < maxBoxesPerLevel && box.readHeader(file, offset, end); ++i) {
+        if (box.isType(boxType)) {
+            return true;
+        }
+        offset = box.contentEnd;
+    }
+    return false;
+}
+
+bool ISOBMFFBox::readBigEndian(PositionedFile& file, uint64_t& offset, unsigned size, uint64_t& value) {
+    uint8_t bytes[8];
+    if (size == 0) {
+        value = 0;
+        return true;
+    }
+    if (size > sizeof(bytes) || !file.read(offset, bytes, size)) return false;
+    value = 0;
+    for (unsigned i = 0; i < size; ++i) value = (value << 8) | bytes[i];
+    offset += size;
+    return true;
+}
+
+uint32_t ISOBMFFBox::getBigEndian(const uint8_t* data, unsigned size) {
+    uint32_t value = 0;
+    for (unsigned i = 0; i < size; ++i) value = (value << 8) | data[i];
+    return value;
+}
@@ -0,0 +1,42 @@
+#ifndef ISOBMFFBOX_H
+#define ISOBMFFBOX_H
+
+/***********************************************************************
+ * File Name: isobmffbox.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the ISOBMFFBox class, a walker for the box
+ *              (atom) structure shared by HEIF/HEIC, MP4, MOV, 3GP and M4V
+ *              files. Each box starts with its size and a four character
+ *              type, so a box is skipped by reading its header alone -
+ *              media data ('mdat', often gigabytes) is never read.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstdint>
+#include "positionedfile.h"
+
+class ISOBMFFBox
+{
+public:
+    char type[4];
+    uint64_t start;        // Offset of the box header
+    uint64_t contentStart; // Offset of the first byte after the header
+    uint64_t contentEnd;   // Offset of the next box
+
+    // Reads the header of the box at 'offset', which has to end by 'end'
+    bool readHeader(PositionedFile& file, uint64_t offset, uint64_t end);
+    bool isType(const char* boxType) const;
+
+    // Finds the first box of 'boxType' between 'start' and 'end'
+    static bool find(PositionedFile& file, uint64_t start, uint64_t end, const char* boxType, ISOBMFFBox& box);
+    // Reads a 'size' byte (up to 8) big endian number at 'offset' and
+    // advances 'offset' past it. A size of 0 reads 0.
+    static bool readBigEndian(PositionedFile& file, uint64_t& offset, unsigned size, uint64_t& value);
+    static uint32_t getBigEndian(const uint8_t* data, unsigned size);
+
+    // Limits how many boxes are walked at one level of a corrupt file
+    static constexpr unsigned maxBoxesPerLevel = 4096;
+};
+
+#endif // ISOBMFFBOX_H
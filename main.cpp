@@ -5,30 +5,41 @@
  * Description: This file sets up the QApplication for the MetaMover project,
  *              loads language translations, and initializes the main GUI
  *              window and scanner functionality on separate threads to
- *              enhance UI responsiveness.
+ *              enhance UI responsiveness. With --batch a QCoreApplication
+ *              and the BatchRunner are used instead, so no display is needed.
+ *              METAMOVER_TRACE=<file> writes a Chrome trace of the run.
  * License: MIT License
  ***********************************************************************/
 
 #include "metamovermainwindow.h"
+#include "batchrunner.h"
 #include "scanner.h"
 #include "transfermanager.h"
+#include "tracer.h"
 
 #include <QApplication>
 #include <QLocale>
 #include <QTranslator>
 #include <QThread>
+#include <memory>
 
 int main(int argc, char *argv[])
 {
-    QApplication a(argc, argv);
-
+    Tracer::startFromEnvironment();
+    bool batchMode = BatchRunner::isBatchMode(argc, argv);
+    std::unique_ptr<QCoreApplication> a;
     QTranslator translator;
-    const QStringList uiLanguages = QLocale::system().uiLanguages();
-    for (const QString &locale : uiLanguages) {
-        const QString baseName = "MetaMover_" + QLocale(locale).name();
-        if (translator.load(":/i18n/" + baseName)) {
-            a.installTranslator(&translator);
-            break;
+    if (batchMode) {
+        a = std::make_unique<QCoreApplication>(argc, argv);
+    } else {
+        a = std::make_unique<QApplication>(argc, argv);
+        const QStringList uiLanguages = QLocale::system().uiLanguages();
+        for (const QString &locale : uiLanguages) {
+            const QString baseName = "MetaMover_" + QLocale(locale).name();
+            if (translator.load(":/i18n/" + baseName)) {
+                a->installTranslator(&translator);
+                break;
+            }
         }
     }
 
@@ -44,11 +55,21 @@ int main(int argc, char *argv[])
     transferManager->moveToThread(&transferManagerThread);
     transferManagerThread.start();
 
-    // Pass the scanner to the main window
-    MetaMoverMainWindow w(scanner, transferManager);
-    w.show();
-
-    int execResult = a.exec();
+    int execResult;
+    if (batchMode) {
+        BatchRunner runner(scanner, transferManager);
+        if (runner.configure(*a)) {
+            QTimer::singleShot(0, &runner, &BatchRunner::start);
+            execResult = a->exec();
+        } else {
+            execResult = BatchRunner::ExitInvalidArguments;
+        }
+    } else {
+        // Pass the scanner to the main window
+        MetaMoverMainWindow w(scanner, transferManager);
+        w.show();
+        execResult = a->exec();
+    }
 
     // Clean up the threads
     scannerThread.quit();
@@ -57,6 +78,7 @@ int main(int argc, char *argv[])
     transferManagerThread.quit();
     transferManagerThread.wait();
     delete transferManager;
+    Tracer::finish();
 
     return execResult;
 }
@@ -112,6 +112,7 @@ void MetaMoverMainWindow::resetScanResults()
 {
     ui->lineEditFilesFound->setText(QString::number(0));
     ui->lineEditPhotoFilesFound->setText(QString::number(0));
+    ui->lineEditVideoFilesFound->setText(QString::number(0));
     ui->lineEditPhotoHadEXIFData->setText(QString::number(0));
     ui->lineEditPhotoHasEXIFDataNoDate->setText(QString::number(0));
     ui->lineEditPhotoHasEXIFDataWDate->setText(QString::number(0));
@@ -306,11 +307,31 @@ void MetaMoverMainWindow::showScanResults() {
 void MetaMoverMainWindow::updateFileCounts(){
     ui->lineEditFilesFound->setText(QString::number(appScanner->getTotalFilesFound()));
     ui->lineEditPhotoFilesFound->setText(QString::number(appScanner->getTotalPhotoFilesFound()));
+    ui->lineEditVideoFilesFound->setText(QString::number(appScanner->getVideoFilesFound()));
     ui->lineEditPhotoHadEXIFData->setText(QString::number(appScanner->getPhotoFilesFoundContainingEXIFData()));
     ui->lineEditPhotoHasEXIFDataWDate->setText(QString::number(appScanner->getPhotoFilesFoundContainingValidCreationDate()));
     ui->lineEditPhotoHasEXIFDataNoDate->setText(QString::number(appScanner->getPhotoFilesUnsupportedFiles()));
 }
 
+// Shows the throughput and time remaining on the progress bar while a
+// transfer runs, e.g. "42% - 118.3 MB/s - 120 of 310 files - 1m 05s left"
+void MetaMoverMainWindow::updateTransferMetrics(){
+    if(!transferManager->transferRunning){
+        ui->progressBarFileProgress->resetFormat();
+        return;
+    }
+    TransferMetricsSnapshot metrics = transferManager->getTransferMetrics();
+    QString format = QString("%p% - %1 MB/s - %2 of %3 files")
+                         .arg(metrics.bytesPerSecond / (1024.0 * 1024.0), 0, 'f', 1)
+                         .arg(static_cast<qulonglong>(metrics.filesCompleted))
+                         .arg(static_cast<qulonglong>(metrics.totalFiles));
+    if(metrics.etaSeconds >= 0){
+        qint64 secondsLeft = static_cast<qint64>(metrics.etaSeconds);
+        format += QString(" - %1m %2s left").arg(secondsLeft / 60).arg(secondsLeft % 60, 2, 10, QLatin1Char('0'));
+    }
+    ui->progressBarFileProgress->setFormat(format);
+}
+
 // polling timer functions
 void MetaMoverMainWindow::startPollingTimer() {
     softlyStopPollingTimer = false;
@@ -325,6 +346,7 @@ void MetaMoverMainWindow::stopPollingTimer() {
 void MetaMoverMainWindow::pollingTimerTick() {
     updateFileCounts();
     ui->progressBarFileProgress->setValue(transferManager->getTransferProgress());
+    updateTransferMetrics();
     if(softlyStopPollingTimer){
         if(currentTimerSoftStopCycleCount >= timerSoftStopCycleCount){
             pollingTimer->stop();
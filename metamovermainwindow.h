@@ -16,17 +16,11 @@
 #include <QMainWindow>
 #include <QDir>
 #include <QTimer>
-#include <QMetaType>
 #include <vector>
 #include "scanner.h"
 #include "transfermanager.h"
 #include "appconfigmanager.h"
 
-// Type alias
-using PhotoFileHandlerVector = std::vector<std::unique_ptr<PhotoFileHandler>>;
-
-Q_DECLARE_METATYPE(PhotoFileHandlerVector*)
-
 QT_BEGIN_NAMESPACE
 namespace Ui {
 class MetaMoverMainWindow;
@@ -61,6 +55,7 @@ private:
     void loadAppConfig();
     void saveAppConfig();
     void updateFileCounts();
+    void updateTransferMetrics();
     void startPollingTimer();  // Add startTimer function declaration
     void stopPollingTimer();
     std::string launchDirectoryBrowser(std::string dialogTitle,
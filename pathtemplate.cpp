@@ -0,0 +1,291 @@
+/***********************************************************************
+ * File Name: pathtemplate.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the PathTemplate class. Dates are taken
+ *              from the packed EXIF date as written by the camera, so no
+ *              time zone conversion happens per photo.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <algorithm>
+#include <cstring>
+#include <iterator>
+#include "pathtemplate.h"
+#include "exifdatetime.h"
+
+namespace {
+
+const char* const MonthNames[12] = {
+    "January", "February", "March", "April", "May", "June",
+    "July", "August", "September", "October", "November", "December"
+};
+
+// ISO 8601 week: weeks start on Monday and week 1 holds the year's first
+// Thursday, so early January days can belong to the previous year
+void isoWeek(unsigned year, unsigned month, unsigned day, unsigned& isoYear, unsigned& week) {
+    int64_t days = EXIFDateTime::daysFromCivil(year, month, day);
+    int64_t weekday = ((days + 3) % 7 + 7) % 7; // 0 = Monday
+    int64_t thursday = days - weekday + 3;
+    isoYear = year;
+    if (thursday < EXIFDateTime::daysFromCivil(year, 1, 1)) {
+        isoYear = year - 1;
+    } else if (thursday >= EXIFDateTime::daysFromCivil(year + 1, 1, 1)) {
+        isoYear = year + 1;
+    }
+    week = static_cast<unsigned>((thursday - EXIFDateTime::daysFromCivil(isoYear, 1, 1)) / 7 + 1);
+}
+
+void appendNumber(std::string& out, unsigned value, unsigned width) {
+    char digits[16];
+    unsigned count = 0;
+    do {
+        digits[count++] = static_cast<char>('0' + value % 10);
+        value /= 10;
+    } while (value > 0);
+    while (count < width) {
+        digits[count++] = '0';
+    }
+    while (count > 0) {
+        out.push_back(digits[--count]);
+    }
+}
+
+// Camera and lens names are written without whitespace (as the camera
+// model folder always was) and without characters that are not allowed in
+// a folder or file name
+void appendText(std::string& out, std::string_view text) {
+    for (char c : text) {
+        unsigned char u = static_cast<unsigned char>(c);
+        if (u <= ' ' || u == 0x7F || std::strchr("/\\:*?\"<>|", c)) {
+            continue;
+        }
+        out.push_back(c);
+    }
+}
+
+}
+
+const PathTemplate::Token PathTemplate::tokens[] = {
+    {"Year", Op::Year, true},
+    {"Month", Op::Month, true},
+    {"MonthName", Op::MonthName, false},
+    {"Day", Op::Day, true},
+    {"Hour", Op::Hour, true},
+    {"Minute", Op::Minute, true},
+    {"Second", Op::Second, true},
+    {"IsoYear", Op::IsoYear, true},
+    {"IsoWeek", Op::IsoWeek, true},
+    {"Make", Op::Make, false},
+    {"Model", Op::Model, false},
+    {"Lens", Op::Lens, false},
+    {"Name", Op::Name, false}
+};
+
+bool PathTemplate::compile(const std::string& pattern, Kind templateKind, std::string& error, char pathSeparator) {
+    clear();
+    kind = templateKind;
+    separator = pathSeparator;
+    error.clear();
+
+    if (kind == Kind::Folder && pattern.find('{') == std::string::npos) {
+        return compileLegacyFolders(pattern, error);
+    }
+
+    size_t position = 0;
+    while (position < pattern.size()) {
+        char c = pattern[position];
+        if (c == '{') {
+            size_t close = pattern.find('}', position);
+            if (close == std::string::npos) {
+                error = "Missing '}' in \"" + pattern + "\"";
+                return false;
+            }
+            std::string field = pattern.substr(position + 1, close - position - 1);
+            position = close + 1;
+            unsigned width = 0;
+            size_t colon = field.find(':');
+            if (colon != std::string::npos) {
+                std::string digits = field.substr(colon + 1);
+                field.erase(colon);
+                // "2" and "02" both pad to two digits
+                if (digits.empty() || digits.size() > 2 ||
+                    !std::all_of(digits.begin(), digits.end(), [](char d) { return d >= '0' && d <= '9'; })) {
+                    error = "Bad width for {" + field + "}";
+                    return false;
+                }
+                width = static_cast<unsigned>(std::stoi(digits));
+                if (width > 9) {
+                    error = "Width for {" + field + "} is above 9";
+                    return false;
+                }
+            }
+            const Token* token = std::find_if(std::begin(tokens), std::end(tokens),
+                                              [&field](const Token& t) { return field == t.name; });
+            if (token == std::end(tokens)) {
+                error = "Unknown token {" + field + "}";
+                return false;
+            }
+            if (width > 0 && !token->number) {
+                error = "{" + field + "} is not a number";
+                return false;
+            }
+            add(token->op, static_cast<uint8_t>(width));
+        } else if (c == '}') {
+            error = "Unexpected '}' in \"" + pattern + "\"";
+            return false;
+        } else if (c == '/' || c == '\\') {
+            if (kind == Kind::FileName) {
+                error = "File name templates cannot contain folders";
+                return false;
+            }
+            // Empty folders (leading or doubled separators) are dropped
+            if (!instructions.empty() && instructions.back().op != Op::Separator) {
+                add(Op::Separator);
+            }
+            ++position;
+        } else {
+            size_t next = pattern.find_first_of("{}/\\", position);
+            if (next == std::string::npos) {
+                next = pattern.size();
+            }
+            addLiteral(std::string_view(pattern).substr(position, next - position));
+            position = next;
+        }
+    }
+    if (kind == Kind::Folder && !instructions.empty() && instructions.back().op != Op::Separator) {
+        add(Op::Separator);
+    }
+    return true;
+}
+
+// "Year, Month, Camera Model": each entry is one folder. Month is the month
+// name and Day is not zero padded, as these folders have always been named.
+bool PathTemplate::compileLegacyFolders(const std::string& pattern, std::string& error) {
+    size_t start = 0;
+    while (start <= pattern.size()) {
+        size_t comma = pattern.find(',', start);
+        if (comma == std::string::npos) {
+            comma = pattern.size();
+        }
+        std::string component;
+        std::remove_copy(pattern.begin() + start, pattern.begin() + comma, std::back_inserter(component), ' ');
+        start = comma + 1;
+        if (component.empty()) {
+            continue;
+        }
+        if (component == "Year") {
+            add(Op::Year);
+        } else if (component == "Month") {
+            add(Op::MonthName);
+        } else if (component == "Day") {
+            add(Op::Day);
+        } else if (component == "CameraModel") {
+            add(Op::Model);
+        } else {
+            error = "Unknown folder \"" + component + "\"";
+            clear();
+            return false;
+        }
+        add(Op::Separator);
+    }
+    return true;
+}
+
+void PathTemplate::clear() {
+    instructions.clear();
+    literals.clear();
+}
+
+bool PathTemplate::empty() const {
+    return instructions.empty();
+}
+
+void PathTemplate::addLiteral(std::string_view text) {
+    Instruction instruction = {Op::Literal, 0, static_cast<uint32_t>(literals.size()),
+                               static_cast<uint32_t>(text.size())};
+    literals.append(text.data(), text.size());
+    instructions.push_back(instruction);
+}
+
+void PathTemplate::add(Op op, uint8_t width) {
+    instructions.push_back({op, width, 0, 0});
+}
+
+void PathTemplate::render(const PathTemplateFields& fields, std::string& out) const {
+    const uint64_t packed = fields.packedDateTime;
+    const unsigned year = static_cast<unsigned>(packed >> 40);
+    const unsigned month = static_cast<unsigned>((packed >> 32) & 0xFF);
+    const unsigned day = static_cast<unsigned>((packed >> 24) & 0xFF);
+    unsigned isoYear = 0, week = 0;
+    bool isoWeekKnown = false;
+
+    for (const Instruction& instruction : instructions) {
+        switch (instruction.op) {
+        case Op::Literal:
+            out.append(literals, instruction.textOffset, instruction.textLength);
+            break;
+        case Op::Separator:
+            out.push_back(separator);
+            break;
+        case Op::Year:
+            appendNumber(out, year, instruction.width);
+            break;
+        case Op::Month:
+            appendNumber(out, month, instruction.width);
+            break;
+        case Op::MonthName:
+            if (month >= 1 && month <= 12) {
+                out += MonthNames[month - 1];
+            } else {
+                appendNumber(out, month, 0); // Invalid month - just the number
+            }
+            break;
+        case Op::Day:
+            appendNumber(out, day, instruction.width);
+            break;
+        case Op::Hour:
+            appendNumber(out, static_cast<unsigned>((packed >> 16) & 0xFF), instruction.width);
+            break;
+        case Op::Minute:
+            appendNumber(out, static_cast<unsigned>((packed >> 8) & 0xFF), instruction.width);
+            break;
+        case Op::Second:
+            appendNumber(out, static_cast<unsigned>(packed & 0xFF), instruction.width);
+            break;
+        case Op::IsoYear:
+        case Op::IsoWeek:
+            if (!isoWeekKnown) {
+                if (month >= 1 && month <= 12 && day >= 1) {
+                    isoWeek(year, month, day, isoYear, week);
+                }
+                isoWeekKnown = true;
+            }
+            appendNumber(out, instruction.op == Op::IsoYear ? isoYear : week, instruction.width);
+            break;
+        case Op::Make:
+            appendText(out, fields.make);
+            break;
+        case Op::Model:
+            appendText(out, fields.model);
+            break;
+        case Op::Lens:
+            appendText(out, fields.lens);
+            break;
+        case Op::Name: {
+            size_t dot = fields.fileName.rfind('.');
+            out.append(fields.fileName.substr(0, dot == 0 ? std::string_view::npos : dot));
+            break;
+        }
+        }
+    }
+}
+
+std::string PathTemplate::tokenList() {
+    std::string list;
+    for (const Token& token : tokens) {
+        if (!list.empty()) list += ", ";
+        list += std::string("{") + token.name + "}";
+    }
+    return list;
+}
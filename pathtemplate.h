@@ -0,0 +1,87 @@
+#ifndef PATHTEMPLATE_H
+#define PATHTEMPLATE_H
+
+/***********************************************************************
+ * File Name: pathtemplate.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the PathTemplate class, which turns an
+ *              output folder structure (or file name) pattern into a list
+ *              of ops once per transfer, so each photo is rendered by
+ *              running the ops instead of re-parsing the pattern. A pattern
+ *              is literal text with {Token} fields, optionally zero padded
+ *              as {Token:N}; '/' separates folders. The comma separated
+ *              folder structures of the options menu ("Year, Month, Camera
+ *              Model") are compiled to the equivalent pattern. Rendering
+ *              appends to a caller-owned buffer, so once the buffer has
+ *              grown to fit no allocation is made per photo.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// The values a template is rendered from
+struct PathTemplateFields {
+    uint64_t packedDateTime = 0; // As packed by EXIFDateTime::pack
+    std::string_view make;
+    std::string_view model;
+    std::string_view lens;
+    std::string_view fileName;   // Original file name, with its extension
+};
+
+class PathTemplate
+{
+public:
+    enum class Kind {
+        Folder,  // '/' starts a new folder; the output ends with a separator
+        FileName // The file name without its extension ('/' is not allowed)
+    };
+
+    PathTemplate() = default;
+
+    // Returns false, with a message in 'error', if the pattern has an unknown
+    // token or a bad field. 'separator' is written for each '/'.
+    bool compile(const std::string& pattern, Kind kind, std::string& error, char separator = '/');
+    void clear();
+    bool empty() const;
+
+    // Appends the rendering of 'fields' to 'out'
+    void render(const PathTemplateFields& fields, std::string& out) const;
+
+    // Tokens accepted in {Token} fields, for help texts
+    static std::string tokenList();
+
+private:
+    enum class Op : uint8_t {
+        Literal, Separator,
+        Year, Month, MonthName, Day, Hour, Minute, Second, IsoYear, IsoWeek,
+        Make, Model, Lens, Name
+    };
+    struct Token {
+        const char* name;
+        Op op;
+        bool number; // Accepts a width
+    };
+    static const Token tokens[];
+
+    struct Instruction {
+        Op op;
+        uint8_t width;        // Minimum digits of a number (zero padded)
+        uint32_t textOffset;  // Literal text, in 'literals'
+        uint32_t textLength;
+    };
+
+    bool compileLegacyFolders(const std::string& pattern, std::string& error);
+    void addLiteral(std::string_view text);
+    void add(Op op, uint8_t width = 0);
+
+    std::vector<Instruction> instructions;
+    std::string literals;
+    char separator = '/';
+    Kind kind = Kind::Folder;
+};
+
+#endif // PATHTEMPLATE_H
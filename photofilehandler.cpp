@@ -10,16 +10,19 @@
  ***********************************************************************/
 
 
+#include <algorithm>
+#include <cstdio>
 #include <iostream>
 #include <string>
 // #include <cstdio> this includes supports the section below for EXIF output
-#include <sstream>
 #include <fstream>
-#include <iomanip>
 #include <vector>
 #include <filesystem>
 #include "photofilehandler.h"
 #include "exif.h"
+#include "exifsegmentreader.h"
+#include "contenthasher.h"
+#include "tracer.h"
 
 PhotoFileHandler::PhotoFileHandler(const std::string inputFilePath)
     : BasicFileHandler(inputFilePath) {
@@ -27,21 +30,137 @@ PhotoFileHandler::PhotoFileHandler(const std::string inputFilePath)
     containsEXIFData = false;
     validCreationDataInEXIF = false;
     overwriteEnabled = false;
+    exifDataLoaded = false;
+    exifFingerprint = 0;
+    packedDateTimeOriginal = 0;
+    dateTimeOffsetMinutes = EXIFDateTime::NoOffset;
+    fileSize = 0;
+    fileSizeKnown = false;
+    fileModifiedTime = 0;
+    contentHash = 0;
+    contentHashKnown = false;
 }
 
 PhotoFileHandler::~PhotoFileHandler() {
 }
 
-std::chrono::system_clock::time_point PhotoFileHandler::getOriginalDateTime(){
-    return originalDateTime;
+std::chrono::system_clock::time_point PhotoFileHandler::getOriginalDateTime() const {
+    return EXIFDateTime::unpack(packedDateTimeOriginal, dateTimeOffsetMinutes).toTimePoint();
 }
 
 std::string PhotoFileHandler::getCameraModel(){
     return removeWhitespace(cameraModel);
 }
 
-easyexif::EXIFInfo PhotoFileHandler::getExifData(){
-    return exifData;
+const std::string& PhotoFileHandler::getExifCameraModel() const {
+    return cameraModel;
+}
+
+const std::string& PhotoFileHandler::getCameraMake() const {
+    return cameraMake;
+}
+
+const std::string& PhotoFileHandler::getLensModel() const {
+    return lensModel;
+}
+
+uint64_t PhotoFileHandler::getPackedDateTimeOriginal() const {
+    return packedDateTimeOriginal;
+}
+
+int16_t PhotoFileHandler::getDateTimeOffsetMinutes() const {
+    return dateTimeOffsetMinutes;
+}
+
+const easyexif::EXIFInfo& PhotoFileHandler::getExifData(){
+    // The scan keeps only the few fields it needs, so the EXIF block is
+    // read again when the full field comparison needs it
+    if (!exifDataLoaded && containsEXIFData) {
+        extractEXIFData(true);
+    }
+    if (!exifData) {
+        static const easyexif::EXIFInfo noEXIFData;
+        return noEXIFData;
+    }
+    return *exifData;
+}
+
+uint64_t PhotoFileHandler::getExifFingerprint() const {
+    return exifFingerprint;
+}
+
+uint64_t PhotoFileHandler::getFileSize() {
+    if (!fileSizeKnown) {
+        std::error_code ec;
+        auto size = std::filesystem::file_size(filePath, ec);
+        fileSize = ec ? 0 : static_cast<uint64_t>(size);
+        fileSizeKnown = !ec;
+    }
+    return fileSize;
+}
+
+void PhotoFileHandler::setFileStat(uint64_t size, int64_t modifiedTime) {
+    fileSize = size;
+    fileSizeKnown = true;
+    fileModifiedTime = modifiedTime;
+}
+
+void PhotoFileHandler::restoreFromScanCache(const ScanCacheEntry& entry) {
+    setTargetFileName();
+    fileValid = true;
+    containsEXIFData = entry.containsEXIFData;
+    exifFingerprint = entry.exifFingerprint;
+    cameraMake = entry.cameraMake;
+    cameraModel = entry.cameraModel;
+    lensModel = entry.lensModel;
+    setFileStat(entry.fileSize, entry.modifiedTime);
+    if (containsEXIFData) {
+        parseDateTime(entry.dateTimeOriginal, std::string_view());
+        dateTimeOffsetMinutes = validCreationDataInEXIF ? entry.dateTimeOffsetMinutes : EXIFDateTime::NoOffset;
+    }
+}
+
+ScanCacheEntry PhotoFileHandler::toScanCacheEntry() const {
+    ScanCacheEntry entry;
+    entry.filePath = filePath;
+    entry.fileSize = fileSize;
+    entry.modifiedTime = fileModifiedTime;
+    entry.exifFingerprint = exifFingerprint;
+    if (packedDateTimeOriginal) {
+        EXIFDateTime dateTime = EXIFDateTime::unpack(packedDateTimeOriginal);
+        char text[32];
+        std::snprintf(text, sizeof(text), "%04u:%02u:%02u %02u:%02u:%02u", dateTime.year, dateTime.month,
+                      dateTime.day, dateTime.hour, dateTime.minute, dateTime.second);
+        entry.dateTimeOriginal = text;
+    }
+    entry.dateTimeOffsetMinutes = dateTimeOffsetMinutes;
+    entry.cameraMake = cameraMake;
+    entry.cameraModel = cameraModel;
+    entry.lensModel = lensModel;
+    entry.containsEXIFData = containsEXIFData;
+    return entry;
+}
+
+// Hashes the full file contents once; later calls reuse the result
+bool PhotoFileHandler::computeContentHash() {
+    if (!contentHashKnown) {
+        TraceSpan span("PhotoFileHandler::computeContentHash", "hash", filePath);
+        contentHashKnown = ContentHasher::hashFile(filePath, contentHash);
+    }
+    return contentHashKnown;
+}
+
+void PhotoFileHandler::setContentHash(uint64_t hash) {
+    contentHash = hash;
+    contentHashKnown = true;
+}
+
+bool PhotoFileHandler::getContentHash(uint64_t& hash) const {
+    if (!contentHashKnown) {
+        return false;
+    }
+    hash = contentHash;
+    return true;
 }
 
 std::chrono::time_point<std::chrono::system_clock> PhotoFileHandler::getFileCreationTime() const {
@@ -65,41 +184,51 @@ std::string PhotoFileHandler::removeWhitespace(const std::string& input) {
 void PhotoFileHandler::processFile() {
     std::cout << "Processing a photo file: " << filePath << std::endl;
     setTargetFileName();
-    extractEXIFData();
+    extractEXIFData(false);
 }
 
-void PhotoFileHandler::extractEXIFData(){
-    // Open the file with std::ifstream in binary mode
-    std::ifstream file(filePath, std::ios::binary);
-    if (!file) {
+// Unless 'keepEXIFData' is set only the fields used for sorting are kept -
+// the full EXIFInfo is dozens of strings per photo, so it is only allocated
+// for the photos getExifData() is called on
+void PhotoFileHandler::extractEXIFData(bool keepEXIFData){
+    TraceSpan span("PhotoFileHandler::extractEXIFData", "exif", filePath);
+    // Read only the EXIF block (the JPEG APP1 segment or the TIFF IFDs of a
+    // RAW file) - the image data is never loaded
+    std::vector<uint8_t> segment;
+    int code;
+    {
+        TraceSpan readSpan("EXIFSegmentReader::readFromFile", "io");
+        code = EXIFSegmentReader::readFromFile(filePath, segment);
+    }
+    if (code == PARSE_EXIF_ERROR_FILE_ACCESS) {
         std::cerr << "Can't open file.\n";
         fileValid = false;
         return;
     }
+    fileValid = true;
 
-    // Read the data into a std::vector
-    std::vector<uint8_t> buffer(std::istreambuf_iterator<char>(file), {});
-
-    // Ensure the size does not exceed the maximum for unsigned int
-    if (buffer.size() > std::numeric_limits<unsigned int>::max()) {
-        std::cerr << "File size too large for processing.\n";
-        fileValid = false;
+    if (keepEXIFData) {
+        exifData = std::make_unique<easyexif::EXIFInfo>();
+        if (code == PARSE_EXIF_SUCCESS) {
+            code = exifData->parseFromEXIFSegment(segment.data(), static_cast<unsigned int>(segment.size()));
+        }
+        exifDataLoaded = setEXIFFields(code, exifData->fingerprint(), exifData->DateTimeOriginal,
+                                       exifData->OffsetTimeOriginal, exifData->Make, exifData->Model,
+                                       exifData->LensInfo.Model);
         return;
     }
-    fileValid = true;
 
-    // Parse EXIF
-    // Safe cast because we checked the size against unsigned int limits
-    unsigned int size = static_cast<unsigned int>(buffer.size());
-    int code = exifData.parseFrom(buffer.data(), size);
-    if (code) {
-        std::cerr << "Error parsing EXIF: code " << code << "\n";
-        containsEXIFData = false;
-        return;
+    // The scan only needs a few tags - parse just those, in place. The lens
+    // is kept for output path templates and the date's UTC offset for
+    // getOriginalDateTime.
+    easyexif::EXIFView exifView;
+    if (code == PARSE_EXIF_SUCCESS) {
+        code = exifView.parseFromEXIFSegment(segment.data(), static_cast<unsigned int>(segment.size()),
+                                             easyexif::EXIFView::FingerprintTags | easyexif::EXIFView::TagLensModel |
+                                             easyexif::EXIFView::TagOffsetTimeOriginal);
     }
-    containsEXIFData = true;
-    parseDateTime(exifData.DateTimeOriginal.c_str());
-    cameraModel = exifData.Model.c_str();
+    setEXIFFields(code, exifView.fingerprint(), exifView.DateTimeOriginal, exifView.OffsetTimeOriginal,
+                  exifView.Make, exifView.Model, exifView.LensModel);
 
     /* Below is an example of all that can be pulled from exif data
     printf("Camera make          : %s\n", exifData.Make.c_str());
@@ -151,20 +280,33 @@ void PhotoFileHandler::extractEXIFData(){
     */
 }
 
-void PhotoFileHandler::parseDateTime(const std::string& dateTimeStr) {
-    std::istringstream iss(dateTimeStr);
-    std::tm dateTime = {};
+bool PhotoFileHandler::setEXIFFields(int parseCode, uint64_t fingerprint, std::string_view dateTimeOriginal,
+                                     std::string_view offsetTimeOriginal, std::string_view make,
+                                     std::string_view model, std::string_view lens) {
+    if (parseCode) {
+        std::cerr << "Error parsing EXIF: code " << parseCode << "\n";
+        containsEXIFData = false;
+        return false;
+    }
+    containsEXIFData = true;
+    exifFingerprint = fingerprint;
+    // Fields end at the first NUL, as c_str() would end them
+    parseDateTime(dateTimeOriginal.substr(0, dateTimeOriginal.find('\0')),
+                  offsetTimeOriginal.substr(0, offsetTimeOriginal.find('\0')));
+    cameraMake = std::string(make.substr(0, make.find('\0')));
+    cameraModel = std::string(model.substr(0, model.find('\0')));
+    lensModel = std::string(lens.substr(0, lens.find('\0')));
+    return true;
+}
 
-    if (iss >> std::get_time(&dateTime, "%Y:%m:%d %H:%M:%S")) {
-        // Successfully parsed the date and time
-        dateTime.tm_isdst = -1;  // Not setting DST
-        auto time_c = std::mktime(&dateTime);
-        if (time_c != -1) {
-            originalDateTime = std::chrono::system_clock::from_time_t(time_c);
-            validCreationDataInEXIF = true;
-            return;
-        }
+// A fixed-format parse: no stream, locale or time zone lookup per photo, so
+// scan workers never contend on the C library's locks
+void PhotoFileHandler::parseDateTime(std::string_view dateTimeOriginal, std::string_view offsetTimeOriginal) {
+    EXIFDateTime dateTime;
+    validCreationDataInEXIF = EXIFDateTime::parse(dateTimeOriginal, dateTime);
+    packedDateTimeOriginal = validCreationDataInEXIF ? dateTime.pack() : 0;
+    dateTimeOffsetMinutes = EXIFDateTime::NoOffset;
+    if (validCreationDataInEXIF) {
+        EXIFDateTime::parseOffset(offsetTimeOriginal, dateTimeOffsetMinutes);
     }
-    // Parsing failed or conversion to time_point failed
-    validCreationDataInEXIF = false;
 }
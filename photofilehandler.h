@@ -13,13 +13,21 @@
  ***********************************************************************/
 
 
+#include <memory>
 #include <string>
+#include <string_view>
 #include <chrono>
 #include "basicfilehandler.h"
 #include "exif.h"
+#include "exifdatetime.h"
+#include "scancache.h"
 
 class PhotoFileHandler : public BasicFileHandler {
 protected:
+    // Also used by VideoFileHandler for its container metadata
+    bool setEXIFFields(int parseCode, uint64_t fingerprint, std::string_view dateTimeOriginal,
+                       std::string_view offsetTimeOriginal, std::string_view make, std::string_view model, std::string_view lensModel);
+    bool exifDataLoaded;
 
 public:
     PhotoFileHandler(const std::string inputFilePath);
@@ -28,19 +36,49 @@ public:
     bool fileValid;
     bool containsEXIFData;
     bool validCreationDataInEXIF;
-    std::chrono::system_clock::time_point getOriginalDateTime();
+    // UTC when OffsetTimeOriginal is known, otherwise the camera's clock
+    // read as UTC
+    std::chrono::system_clock::time_point getOriginalDateTime() const;
     std::chrono::time_point<std::chrono::system_clock> getFileCreationTime() const;
     std::string getCameraModel();
+    // The model as stored (getCameraModel strips the whitespace)
+    const std::string& getExifCameraModel() const;
+    const std::string& getCameraMake() const;
+    const std::string& getLensModel() const;
+    // "YYYY:MM:DD HH:MM:SS" packed by EXIFDateTime::pack (0 = none)
+    uint64_t getPackedDateTimeOriginal() const;
+    // OffsetTimeOriginal in minutes east of UTC, or EXIFDateTime::NoOffset
+    int16_t getDateTimeOffsetMinutes() const;
     std::string removeWhitespace(const std::string& input);
-    easyexif::EXIFInfo getExifData();
+    // Reads every EXIF field on first use; scans keep only the fields above
+    const easyexif::EXIFInfo& getExifData();
+    uint64_t getExifFingerprint() const;
+    uint64_t getFileSize();
+    void setFileStat(uint64_t size, int64_t modifiedTime);
+    void restoreFromScanCache(const ScanCacheEntry& entry);
+    ScanCacheEntry toScanCacheEntry() const;
+    bool computeContentHash();
+    bool getContentHash(uint64_t& hash) const;
+    // For a hash taken elsewhere (while copying, or from a checksum manifest)
+    void setContentHash(uint64_t hash);
     bool overwriteEnabled;
 
 private:
-    void parseDateTime(const std::string& dateTimeStr);
-    void extractEXIFData();
-    std::chrono::system_clock::time_point originalDateTime;
+    friend struct BenchmarkAccess; // benchmarks/microbenchmarks.cpp
+    void parseDateTime(std::string_view dateTimeOriginal, std::string_view offsetTimeOriginal);
+    void extractEXIFData(bool keepEXIFData);
+    uint64_t packedDateTimeOriginal;
+    int16_t dateTimeOffsetMinutes;
+    std::string cameraMake;
     std::string cameraModel;
-    easyexif::EXIFInfo exifData;
+    std::string lensModel;
+    std::unique_ptr<easyexif::EXIFInfo> exifData; // Only for full field comparisons
+    uint64_t exifFingerprint;
+    uint64_t fileSize;
+    bool fileSizeKnown;
+    int64_t fileModifiedTime;
+    uint64_t contentHash;
+    bool contentHashKnown;
     PhotoFileHandler() = delete;
 };
 #endif // PHOTOFILEHANDLER_H
@@ -0,0 +1,76 @@
+/***********************************************************************
+ * File Name: positionedfile.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the PositionedFile class.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstring>
+#include "positionedfile.h"
+
+#ifdef POSITIONED_FILE_PREAD
+#include <cerrno>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
+PositionedFile::PositionedFile(const std::string& filePath) {
+#ifdef POSITIONED_FILE_PREAD
+    fd = ::open(filePath.c_str(), O_RDONLY);
+#else
+    file.open(filePath, std::ios::binary);
+#endif
+}
+
+PositionedFile::~PositionedFile() {
+#ifdef POSITIONED_FILE_PREAD
+    if (fd >= 0) ::close(fd);
+#endif
+}
+
+bool PositionedFile::isOpen() const {
+#ifdef POSITIONED_FILE_PREAD
+    return fd >= 0;
+#else
+    return file.is_open();
+#endif
+}
+
+bool PositionedFile::read(uint64_t offset, uint8_t* data, size_t count) {
+    if (!inBlock(offset, count)) {
+        if (count > blockSize) {
+            return readAt(offset, data, count) == count;
+        }
+        block.resize(blockSize);
+        block.resize(readAt(offset, block.data(), blockSize));
+        blockOffset = offset;
+        if (!inBlock(offset, count)) return false;
+    }
+    std::memcpy(data, block.data() + (offset - blockOffset), count);
+    return true;
+}
+
+bool PositionedFile::inBlock(uint64_t offset, size_t count) const {
+    // Written so that offsets near the top of the range cannot wrap around
+    return offset >= blockOffset && offset - blockOffset <= block.size() &&
+           count <= block.size() - (offset - blockOffset);
+}
+
+size_t PositionedFile::readAt(uint64_t offset, uint8_t* data, size_t count) {
+    size_t total = 0;
+#ifdef POSITIONED_FILE_PREAD
+    while (total < count) {
+        ssize_t result = ::pread(fd, data + total, count - total, static_cast<off_t>(offset + total));
+        if (result < 0 && errno == EINTR) continue;
+        if (result <= 0) break;
+        total += static_cast<size_t>(result);
+    }
+#else
+    file.clear();
+    file.seekg(static_cast<std::streamoff>(offset));
+    file.read(reinterpret_cast<char*>(data), static_cast<std::streamsize>(count));
+    total = static_cast<size_t>(file.gcount());
+#endif
+    return total;
+}
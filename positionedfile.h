@@ -0,0 +1,56 @@
+#ifndef POSITIONEDFILE_H
+#define POSITIONEDFILE_H
+
+/***********************************************************************
+ * File Name: positionedfile.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the PositionedFile class, random access
+ *              reads from a file at explicit offsets (pread where
+ *              available, a seeking stream otherwise). Small reads go
+ *              through a one block cache, since metadata structures
+ *              (IFDs, box headers) tend to sit next to each other. Used by
+ *              the metadata readers, which jump around a file instead of
+ *              streaming it.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstddef>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#if defined(__unix__) || defined(__APPLE__)
+#define POSITIONED_FILE_PREAD
+#endif
+
+class PositionedFile
+{
+public:
+    explicit PositionedFile(const std::string& filePath);
+    ~PositionedFile();
+    PositionedFile(const PositionedFile&) = delete;
+    PositionedFile& operator=(const PositionedFile&) = delete;
+
+    bool isOpen() const;
+    // Reads exactly 'count' bytes at 'offset'
+    bool read(uint64_t offset, uint8_t* data, size_t count);
+
+private:
+    static constexpr size_t blockSize = 64 * 1024;
+
+    bool inBlock(uint64_t offset, size_t count) const;
+    // Returns the number of bytes read (short at the end of the file)
+    size_t readAt(uint64_t offset, uint8_t* data, size_t count);
+
+#ifdef POSITIONED_FILE_PREAD
+    int fd = -1;
+#else
+    std::ifstream file;
+#endif
+    std::vector<uint8_t> block;
+    uint64_t blockOffset = 0;
+};
+
+#endif // POSITIONEDFILE_H
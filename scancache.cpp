@@ -0,0 +1,260 @@
+/***********************************************************************
+ * File Name: scancache.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the ScanCache class. The cache file holds
+ *              a fixed size header, an array of fixed size records sorted by
+ *              path hash and a blob with the path, date and model strings.
+ *              Lookups binary search the mapped record array directly, so
+ *              nothing is parsed or allocated when the cache is opened.
+ *              Files are written through QSaveFile so an interrupted save
+ *              never leaves a truncated cache behind.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <QSaveFile>
+#include <QString>
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include "scancache.h"
+
+namespace {
+constexpr char CacheMagic[4] = {'M', 'M', 'S', 'C'};
+constexpr uint32_t CacheVersion = 3; // 2: camera make and lens model, 3: date offset
+constexpr uint32_t ByteOrderMark = 0x01020304; // Cache files are host byte order
+constexpr uint32_t FlagContainsEXIFData = 1;
+}
+
+struct ScanCache::Header {
+    char magic[4];
+    uint32_t version;
+    uint32_t byteOrderMark;
+    uint32_t recordCount;
+    uint64_t stringsOffset;
+    uint64_t stringsLength;
+};
+
+struct ScanCache::Record {
+    uint64_t pathHash;
+    uint64_t fileSize;
+    int64_t modifiedTime;
+    uint64_t exifFingerprint;
+    uint32_t pathOffset;
+    uint32_t pathLength;
+    uint32_t dateTimeOffset;
+    uint32_t dateTimeLength;
+    uint32_t modelOffset;
+    uint32_t modelLength;
+    uint32_t makeOffset;
+    uint32_t makeLength;
+    uint32_t lensOffset;
+    uint32_t lensLength;
+    uint32_t flags;
+    int32_t dateTimeOffsetMinutes;
+};
+
+ScanCache::~ScanCache() {
+    close();
+}
+
+bool ScanCache::open(const std::string& cacheFilePath) {
+    close();
+    cacheFile.setFileName(QString::fromStdString(cacheFilePath));
+    if (!cacheFile.open(QIODevice::ReadOnly)) {
+        return false;
+    }
+    qint64 fileSize = cacheFile.size();
+    if (fileSize < static_cast<qint64>(sizeof(Header))) {
+        close();
+        return false;
+    }
+    uchar* data = cacheFile.map(0, fileSize);
+    if (!data) {
+        close();
+        return false;
+    }
+    mappedData = data;
+    mappedSize = static_cast<uint64_t>(fileSize);
+
+    // Validate the header before trusting any offsets in the file
+    Header header;
+    std::memcpy(&header, mappedData, sizeof(header));
+    uint64_t recordsEnd = sizeof(Header) + static_cast<uint64_t>(header.recordCount) * sizeof(Record);
+    if (std::memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) != 0 ||
+        header.version != CacheVersion ||
+        header.byteOrderMark != ByteOrderMark ||
+        recordsEnd > header.stringsOffset ||
+        header.stringsOffset > mappedSize ||
+        header.stringsLength > mappedSize - header.stringsOffset) {
+        std::cerr << "Ignoring invalid scan cache: " << cacheFilePath << std::endl;
+        close();
+        return false;
+    }
+    recordCount = header.recordCount;
+    stringsOffset = header.stringsOffset;
+    return true;
+}
+
+void ScanCache::close() {
+    if (mappedData) {
+        cacheFile.unmap(const_cast<uchar*>(mappedData));
+    }
+    if (cacheFile.isOpen()) {
+        cacheFile.close();
+    }
+    mappedData = nullptr;
+    mappedSize = 0;
+    recordCount = 0;
+    stringsOffset = 0;
+}
+
+bool ScanCache::isOpen() const {
+    return mappedData != nullptr;
+}
+
+size_t ScanCache::size() const {
+    return recordCount;
+}
+
+const ScanCache::Record* ScanCache::records() const {
+    return reinterpret_cast<const Record*>(mappedData + sizeof(Header));
+}
+
+std::string ScanCache::readString(uint32_t offset, uint32_t length) const {
+    uint64_t start = stringsOffset + offset;
+    if (start + length > mappedSize) {
+        return "";
+    }
+    return std::string(reinterpret_cast<const char*>(mappedData + start), length);
+}
+
+void ScanCache::entryFromRecord(const Record& record, ScanCacheEntry& entry) const {
+    entry.filePath = readString(record.pathOffset, record.pathLength);
+    entry.fileSize = record.fileSize;
+    entry.modifiedTime = record.modifiedTime;
+    entry.exifFingerprint = record.exifFingerprint;
+    entry.dateTimeOriginal = readString(record.dateTimeOffset, record.dateTimeLength);
+    entry.dateTimeOffsetMinutes = static_cast<int16_t>(record.dateTimeOffsetMinutes);
+    entry.cameraMake = readString(record.makeOffset, record.makeLength);
+    entry.cameraModel = readString(record.modelOffset, record.modelLength);
+    entry.lensModel = readString(record.lensOffset, record.lensLength);
+    entry.containsEXIFData = (record.flags & FlagContainsEXIFData) != 0;
+}
+
+uint64_t ScanCache::hashPath(const std::string& filePath) {
+    uint64_t hash = 0xcbf29ce484222325ULL; // FNV-1a
+    for (unsigned char c : filePath) {
+        hash ^= c;
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+bool ScanCache::find(const std::string& filePath, uint64_t fileSize, int64_t modifiedTime,
+                     ScanCacheEntry& entry) const {
+    if (!mappedData || recordCount == 0) {
+        return false;
+    }
+    uint64_t pathHash = hashPath(filePath);
+    const Record* begin = records();
+    const Record* end = begin + recordCount;
+    const Record* it = std::lower_bound(begin, end, pathHash, [](const Record& record, uint64_t hash) {
+        return record.pathHash < hash;
+    });
+    for (; it != end && it->pathHash == pathHash; ++it) {
+        if (it->pathLength != filePath.size() ||
+            stringsOffset + it->pathOffset + it->pathLength > mappedSize ||
+            std::memcmp(mappedData + stringsOffset + it->pathOffset, filePath.data(), filePath.size()) != 0) {
+            continue;
+        }
+        // The entry is stale once the file has been modified
+        if (it->fileSize != fileSize || it->modifiedTime != modifiedTime) {
+            return false;
+        }
+        entryFromRecord(*it, entry);
+        return true;
+    }
+    return false;
+}
+
+void ScanCache::collectEntries(std::vector<ScanCacheEntry>& entries, const std::string& excludedDirectory,
+                               bool includeSubdirectories) const {
+    if (!mappedData) {
+        return;
+    }
+    const Record* begin = records();
+    for (const Record* it = begin; it != begin + recordCount; ++it) {
+        ScanCacheEntry entry;
+        entryFromRecord(*it, entry);
+        if (!excludedDirectory.empty() &&
+            entry.filePath.compare(0, excludedDirectory.size(), excludedDirectory) == 0 &&
+            (includeSubdirectories ||
+             entry.filePath.find(excludedDirectory.back(), excludedDirectory.size()) == std::string::npos)) {
+            continue;
+        }
+        entries.push_back(std::move(entry));
+    }
+}
+
+bool ScanCache::save(const std::string& cacheFilePath, std::vector<ScanCacheEntry>& entries) {
+    // Records are sorted by path hash so find() can binary search them
+    std::vector<std::pair<uint64_t, size_t>> order;
+    order.reserve(entries.size());
+    for (size_t i = 0; i < entries.size(); ++i) {
+        order.emplace_back(hashPath(entries[i].filePath), i);
+    }
+    std::sort(order.begin(), order.end());
+
+    std::vector<Record> recordTable;
+    recordTable.reserve(entries.size());
+    std::string strings;
+    auto appendString = [&strings](const std::string& value, uint32_t& offset, uint32_t& length) {
+        offset = static_cast<uint32_t>(strings.size());
+        length = static_cast<uint32_t>(value.size());
+        strings += value;
+    };
+    for (const auto& item : order) {
+        const ScanCacheEntry& entry = entries[item.second];
+        Record record = {};
+        record.pathHash = item.first;
+        record.fileSize = entry.fileSize;
+        record.modifiedTime = entry.modifiedTime;
+        record.exifFingerprint = entry.exifFingerprint;
+        appendString(entry.filePath, record.pathOffset, record.pathLength);
+        appendString(entry.dateTimeOriginal, record.dateTimeOffset, record.dateTimeLength);
+        record.dateTimeOffsetMinutes = entry.dateTimeOffsetMinutes;
+        appendString(entry.cameraModel, record.modelOffset, record.modelLength);
+        appendString(entry.cameraMake, record.makeOffset, record.makeLength);
+        appendString(entry.lensModel, record.lensOffset, record.lensLength);
+        record.flags = entry.containsEXIFData ? FlagContainsEXIFData : 0;
+        recordTable.push_back(record);
+        if (strings.size() > UINT32_MAX) {
+            std::cerr << "Scan cache too large, not saved." << std::endl;
+            return false;
+        }
+    }
+
+    Header header = {};
+    std::memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version = CacheVersion;
+    header.byteOrderMark = ByteOrderMark;
+    header.recordCount = static_cast<uint32_t>(recordTable.size());
+    header.stringsOffset = sizeof(Header) + recordTable.size() * sizeof(Record);
+    header.stringsLength = strings.size();
+
+    QSaveFile outFile(QString::fromStdString(cacheFilePath));
+    if (!outFile.open(QIODevice::WriteOnly)) {
+        std::cerr << "Unable to open scan cache for writing: " << cacheFilePath << std::endl;
+        return false;
+    }
+    outFile.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    outFile.write(reinterpret_cast<const char*>(recordTable.data()),
+                  static_cast<qint64>(recordTable.size() * sizeof(Record)));
+    outFile.write(strings.data(), static_cast<qint64>(strings.size()));
+    if (!outFile.commit()) {
+        std::cerr << "Unable to write scan cache: " << cacheFilePath << std::endl;
+        return false;
+    }
+    return true;
+}
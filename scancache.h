@@ -0,0 +1,86 @@
+#ifndef SCANCACHE_H
+#define SCANCACHE_H
+
+/***********************************************************************
+ * File Name: scancache.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the ScanCache class, a persistent cache of
+ *              the photo metadata gathered by the Scanner. Entries are keyed
+ *              by file path and are only used while the file size and last
+ *              modified time still match, so a rescan of an unchanged tree
+ *              only needs to stat each file. The cache lives in a compact
+ *              binary file (next to config.dat) that is memory-mapped
+ *              read-only and searched in place, so opening it costs nothing
+ *              beyond the mapping itself.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <QFile>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include "exifdatetime.h"
+
+// Metadata cached for a single photo file
+struct ScanCacheEntry {
+    std::string filePath;
+    uint64_t fileSize = 0;
+    int64_t modifiedTime = 0;
+    uint64_t exifFingerprint = 0;
+    std::string dateTimeOriginal;
+    int16_t dateTimeOffsetMinutes = EXIFDateTime::NoOffset;
+    std::string cameraMake;
+    std::string cameraModel;
+    std::string lensModel;
+    bool containsEXIFData = false;
+};
+
+class ScanCache
+{
+public:
+    ScanCache() = default;
+    ~ScanCache();
+    ScanCache(const ScanCache&) = delete;
+    ScanCache& operator=(const ScanCache&) = delete;
+
+    // Maps the cache file. Returns false (leaving the cache empty) if the
+    // file does not exist or is not a valid cache file.
+    bool open(const std::string& cacheFilePath);
+    void close();
+    bool isOpen() const;
+    size_t size() const;
+
+    // Looks up a file. Only succeeds when the cached size and modified time
+    // match, so changed files are never served from the cache. Safe to call
+    // from several threads at once.
+    bool find(const std::string& filePath, uint64_t fileSize, int64_t modifiedTime,
+              ScanCacheEntry& entry) const;
+
+    // Appends every cached entry outside 'excludedDirectory' (a path ending
+    // in a separator) to 'entries', to carry over the entries a rescan of
+    // that directory did not cover. Unless 'includeSubdirectories' is set,
+    // the entries of its subdirectories are carried over too.
+    void collectEntries(std::vector<ScanCacheEntry>& entries, const std::string& excludedDirectory = "",
+                        bool includeSubdirectories = true) const;
+
+    // Writes a new cache file atomically. The cache file must not be mapped
+    // while it is replaced (call close() first).
+    static bool save(const std::string& cacheFilePath, std::vector<ScanCacheEntry>& entries);
+
+private:
+    struct Header;
+    struct Record;
+    const Record* records() const;
+    std::string readString(uint32_t offset, uint32_t length) const;
+    void entryFromRecord(const Record& record, ScanCacheEntry& entry) const;
+    static uint64_t hashPath(const std::string& filePath);
+
+    QFile cacheFile;
+    const unsigned char* mappedData = nullptr;
+    uint64_t mappedSize = 0;
+    uint32_t recordCount = 0;
+    uint64_t stringsOffset = 0;
+};
+
+#endif // SCANCACHE_H
@@ -12,10 +12,13 @@
 
 #include <QDir>
 #include <QString>
-#include <QMessageBox>
+#include <QThread>
 #include <filesystem>
 #include <iostream>
 #include "scanner.h"
+#include "appconfigmanager.h"
+#include "errorreporter.h"
+#include "tracer.h"
 
 Scanner::Scanner(QObject* parent)
     : QObject(parent) {}
@@ -23,59 +26,240 @@ Scanner::Scanner(QObject* parent)
 Scanner::~Scanner() {}
 
 void Scanner::scan(const std::string& dirPath, bool includeSubdirs) {
+    TraceSpan span("Scanner::scan", "scan", dirPath);
     resetScanner();
     cancelScan = false;
     scanRunning = true;
+
+    // Directories are enumerated on this thread while the worker pool
+    // extracts the file metadata batch by batch
+    int workerThreadCount = AppConfig::get().getScanWorkerThreadCount();
+    if (workerThreadCount <= 0) {
+        workerThreadCount = QThread::idealThreadCount();
+    }
+    scanThreadPool.setMaxThreadCount(workerThreadCount);
+    if (scanCacheUsed) {
+        scanCache.open(AppConfigManager::getDefaultScanCachePath());
+    }
+
     scanDirectory(dirPath, includeSubdirs);
+    submitScanBatch();
+    scanThreadPool.waitForDone();
+
+    if (pipelineQueue) {
+        pipelineQueue->close(); // Lets the transfer finish once it has drained the queue
+    }
+
     scanRunning = false;
+    if (cancelScan) {
+        scanCache.close();
+        resetScanner();
+    } else {
+        mergeScanBatches();
+        saveScanCache(dirPath, includeSubdirs);
+    }
     emit scanCompleted();
 }
 
 void Scanner::scanDirectory(const std::string& directoryPath, bool includeSubdirectories) {
+    TraceSpan span("Scanner::scanDirectory", "scan", directoryPath);
     for (const auto& entry : std::filesystem::directory_iterator(directoryPath)) {
         if (cancelScan) {
-            resetScanner();
             return;
         }
         std::string path = QString(QDir::toNativeSeparators(QString::fromStdString(entry.path().string()))).toStdString();
         if (entry.is_directory() && includeSubdirectories) {
             scanDirectory(path, true);
         } else if (!entry.is_directory()) {
-            auto handler = fileFactory.makeFileHandler(path);
-            if (auto* pVideoHandler = dynamic_cast<VideoFileHandler*>(handler.get())) {
-                videoFileHandlers.push_back(std::unique_ptr<VideoFileHandler>(pVideoHandler));
-            } else if (auto* pPhotoHandler = dynamic_cast<PhotoFileHandler*>(handler.get())) {
-                if (!pPhotoHandler->containsEXIFData) {
-                    photoFilesUnsupportedFound++;
-                    invalidPhotoFileHandlers.push_back(std::unique_ptr<PhotoFileHandler>(pPhotoHandler));
-                    handler.release();
-                    filesFound++;
-                    continue;
-                } else {
-                    photoFilesFoundContainingEXIFData++;
-                }
-                if (!pPhotoHandler->validCreationDataInEXIF) {
-                    photoFilesUnsupportedFound++;
-                    invalidPhotoFileHandlers.push_back(std::unique_ptr<PhotoFileHandler>(pPhotoHandler));
-                    handler.release();
-                    filesFound++;
-                    continue;
-                } else {
-                    photoFilesFoundContainingValidCreationDate++;
-                    photoFileHandlers.push_back(std::unique_ptr<PhotoFileHandler>(pPhotoHandler));
-                    filesFound++;
-                }
-            } else if (auto* pBasicHandler = dynamic_cast<BasicFileHandler*>(handler.get())) {
-                basicFileHandlers.push_back(std::unique_ptr<BasicFileHandler>(pBasicHandler));
+            if (!pendingScanBatch) {
+                pendingScanBatch = std::make_unique<ScanBatch>();
+            }
+            pendingScanBatch->filePaths.push_back(path);
+            if (pendingScanBatch->filePaths.size() >= scanBatchSize) {
+                submitScanBatch();
+            }
+        }
+    }
+}
+
+void Scanner::submitScanBatch() {
+    if (!pendingScanBatch) {
+        return;
+    }
+    ScanBatch* batch = pendingScanBatch.get();
+    scanBatches.push_back(std::move(pendingScanBatch));
+    scanThreadPool.start([this, batch]() { processScanBatch(*batch); });
+}
+
+void Scanner::processScanBatch(ScanBatch& batch) {
+    TraceSpan span("Scanner::processScanBatch", "scan");
+    for (const auto& path : batch.filePaths) {
+        if (cancelScan) {
+            return;
+        }
+        bool mediaFile = fileFactory.isPhotoFile(path) || fileFactory.isVideoFile(path);
+        auto handler = mediaFile ? makePhotoFileHandler(path) : fileFactory.makeFileHandler(path);
+        if (auto* pVideoHandler = dynamic_cast<VideoFileHandler*>(handler.get())) {
+            // Videos are sorted by their recording date, the way photos are
+            // sorted by their EXIF creation date
+            videoFilesFound++;
+            filesFound++;
+            bool validMetadata = pVideoHandler->containsEXIFData && pVideoHandler->validCreationDataInEXIF;
+            if (!validMetadata) {
+                // Goes to the invalid metadata folder, like such photos
+                photoFilesUnsupportedFound++;
+            }
+            handler.release();
+            addPhotoFileHandler(batch, std::unique_ptr<PhotoFileHandler>(pVideoHandler), validMetadata);
+            continue;
+        } else if (auto* pPhotoHandler = dynamic_cast<PhotoFileHandler*>(handler.get())) {
+            if (!pPhotoHandler->containsEXIFData) {
                 photoFilesUnsupportedFound++;
                 filesFound++;
+                handler.release();
+                addPhotoFileHandler(batch, std::unique_ptr<PhotoFileHandler>(pPhotoHandler), false);
+                continue;
             } else {
-                std::cout << "Unknown handler type for file: " << path << std::endl;
+                photoFilesFoundContainingEXIFData++;
+            }
+            if (!pPhotoHandler->validCreationDataInEXIF) {
                 photoFilesUnsupportedFound++;
+                filesFound++;
+                handler.release();
+                addPhotoFileHandler(batch, std::unique_ptr<PhotoFileHandler>(pPhotoHandler), false);
+                continue;
+            } else {
+                photoFilesFoundContainingValidCreationDate++;
+                validPhotoFilesFound++;
+                filesFound++;
+                handler.release();
+                addPhotoFileHandler(batch, std::unique_ptr<PhotoFileHandler>(pPhotoHandler), true);
+                continue;
             }
-            handler.release();
+        } else if (auto* pBasicHandler = dynamic_cast<BasicFileHandler*>(handler.get())) {
+            batch.basicFileHandlers.push_back(std::unique_ptr<BasicFileHandler>(pBasicHandler));
+            basicFilesFound++;
+            photoFilesUnsupportedFound++;
+            filesFound++;
+        } else {
+            std::cout << "Unknown handler type for file: " << path << std::endl;
+            photoFilesUnsupportedFound++;
         }
+        handler.release();
+    }
+}
+
+void Scanner::addPhotoFileHandler(ScanBatch& batch, std::unique_ptr<PhotoFileHandler> handler, bool validMetadata) {
+    if (!pipelineQueue) {
+        auto& handlers = validMetadata ? batch.photoFileHandlers : batch.invalidPhotoFileHandlers;
+        handlers.push_back(std::move(handler));
+        return;
+    }
+    // Kept for the scan cache - a pipelined handler is gone once it is queued
+    if (handler->fileValid) {
+        batch.pipelinedCacheEntries.push_back(handler->toScanCacheEntry());
     }
+    PipelinedPhoto pipelinedPhoto;
+    pipelinedPhoto.photoFileHandler = std::move(handler);
+    pipelinedPhoto.validMetadata = validMetadata;
+    // Blocks while the transfer is behind; refused once it has been canceled
+    pipelineQueue->push(std::move(pipelinedPhoto));
+}
+
+void Scanner::setPipelineQueue(PhotoPipelineQueue* queue) {
+    pipelineQueue = queue;
+}
+
+void Scanner::setScanCacheUsed(bool used) {
+    scanCacheUsed = used;
+}
+
+std::unique_ptr<BasicFileHandler> Scanner::makePhotoFileHandler(const std::string& path) {
+    TraceSpan span("Scanner::makePhotoFileHandler", "scan", path);
+    // The size and modified time (a stat, no read) decide whether the cached
+    // metadata for the file can still be used
+    std::error_code ec;
+    uint64_t size = static_cast<uint64_t>(std::filesystem::file_size(path, ec));
+    int64_t modifiedTime = 0;
+    if (!ec) {
+        modifiedTime = static_cast<int64_t>(std::filesystem::last_write_time(path, ec).time_since_epoch().count());
+    }
+    ScanCacheEntry cachedEntry;
+    if (!ec && scanCache.find(path, size, modifiedTime, cachedEntry)) {
+        scanCacheHits++;
+        std::unique_ptr<PhotoFileHandler> handler;
+        if (fileFactory.isVideoFile(path)) {
+            handler = std::make_unique<VideoFileHandler>(path);
+        } else {
+            handler = std::make_unique<PhotoFileHandler>(path);
+        }
+        handler->restoreFromScanCache(cachedEntry);
+        return handler;
+    }
+    scanCacheMisses++;
+    auto handler = fileFactory.makeFileHandler(path);
+    if (auto* pPhotoHandler = dynamic_cast<PhotoFileHandler*>(handler.get()); pPhotoHandler && !ec) {
+        pPhotoHandler->setFileStat(size, modifiedTime);
+    }
+    return handler;
+}
+
+void Scanner::mergeScanBatches() {
+    TraceSpan span("Scanner::mergeScanBatches", "scan");
+    // Batches are merged in submission order so results keep the directory
+    // enumeration order regardless of which worker finished first
+    for (auto& batch : scanBatches) {
+        for (auto& handler : batch->basicFileHandlers) {
+            basicFileHandlers.push_back(std::move(handler));
+        }
+        for (auto& handler : batch->photoFileHandlers) {
+            photoFileHandlers.push_back(std::move(handler));
+        }
+        for (auto& handler : batch->invalidPhotoFileHandlers) {
+            invalidPhotoFileHandlers.push_back(std::move(handler));
+        }
+        for (auto& entry : batch->pipelinedCacheEntries) {
+            pipelinedCacheEntries.push_back(std::move(entry));
+        }
+    }
+    scanBatches.clear();
+}
+
+void Scanner::saveScanCache(const std::string& directoryPath, bool includeSubdirectories) {
+    TraceSpan span("Scanner::saveScanCache", "scan");
+    if (!scanCacheUsed) {
+        pipelinedCacheEntries.clear();
+        return;
+    }
+    std::string scannedPrefix = QString(QDir::toNativeSeparators(QString::fromStdString(directoryPath))).toStdString();
+    const char separator = QDir::separator().toLatin1();
+    if (scannedPrefix.empty() || scannedPrefix.back() != separator) {
+        scannedPrefix += separator;
+    }
+
+    // Entries outside the scanned directory are carried over unchanged; the
+    // ones this scan covered are replaced by its results, which also drops
+    // files that no longer exist
+    std::vector<ScanCacheEntry> entries;
+    scanCache.collectEntries(entries, scannedPrefix, includeSubdirectories);
+    size_t previousEntriesInScan = scanCache.size() - entries.size();
+    scanCache.close();
+    if (scanCacheMisses == 0 && static_cast<size_t>(scanCacheHits.load()) == previousEntriesInScan) {
+        return; // Nothing changed - keep the existing file
+    }
+
+    for (const auto* handlers : {&photoFileHandlers, &invalidPhotoFileHandlers}) {
+        for (const auto& handler : *handlers) {
+            if (handler && handler->fileValid) {
+                entries.push_back(handler->toScanCacheEntry());
+            }
+        }
+    }
+    for (auto& entry : pipelinedCacheEntries) {
+        entries.push_back(std::move(entry));
+    }
+    pipelinedCacheEntries.clear();
+    ScanCache::save(AppConfigManager::getDefaultScanCachePath(), entries);
 }
 
 void Scanner::resetScanner() {
@@ -83,16 +267,28 @@ void Scanner::resetScanner() {
     photoFilesFoundContainingEXIFData = 0;
     photoFilesFoundContainingValidCreationDate = 0;
     photoFilesUnsupportedFound = 0;
+    basicFilesFound = 0;
+    validPhotoFilesFound = 0;
+    videoFilesFound = 0;
+    scanCacheHits = 0;
+    scanCacheMisses = 0;
+    if (scanRunning) {
+        // Workers still own their batches - the scan thread clears the
+        // results itself once the cancelled scan has wound down
+        return;
+    }
+    scanBatches.clear();
+    pendingScanBatch.reset();
+    pipelinedCacheEntries.clear();
     basicFileHandlers.clear();
     photoFileHandlers.clear();
-    videoFileHandlers.clear();
     invalidPhotoFileHandlers.clear();
 }
 
 bool Scanner::checkScanResults(bool showMessage) {
     if (getTotalFilesFound() <= 0) {
         if (showMessage) {
-            QMessageBox::critical(nullptr, "Error", "No Files Found in Scan.", QMessageBox::Ok);
+            ErrorReporter::showError("No Files Found in Scan.");
         }
         return false;
     }
@@ -108,15 +304,20 @@ std::vector<std::unique_ptr<PhotoFileHandler>>& Scanner::getInvalidPhotoFileHand
 }
 
 int const Scanner::getTotalFilesFound() {
+    // Counted by the scan workers so the total updates live while scanning
     int total = 0;
-    total += static_cast<int>(basicFileHandlers.size());
-    total += static_cast<int>(photoFileHandlers.size());
-    total += static_cast<int>(videoFileHandlers.size());
+    total += basicFilesFound.load();
+    total += validPhotoFilesFound.load();
+    total += videoFilesFound.load();
     return total;
 }
 
 int const Scanner::getTotalPhotoFilesFound() {
-    return static_cast<int>(photoFileHandlers.size());
+    return validPhotoFilesFound.load();
+}
+
+int const Scanner::getVideoFilesFound() {
+    return videoFilesFound.load();
 }
 
 int const Scanner::getPhotoFilesFoundContainingEXIFData() {
@@ -16,12 +16,22 @@
 
 #include <QObject>
 #include <QTimer>
+#include <QThreadPool>
 #include <vector>
 #include <memory>
 #include <string>
 #include <atomic>
 #include "basicfilehandler.h"
 #include "filehandlerfactory.h"
+#include "scancache.h"
+#include "boundedqueue.h"
+
+// A scanned photo on its way from the Scanner to a pipelined transfer
+struct PipelinedPhoto {
+    std::unique_ptr<PhotoFileHandler> photoFileHandler;
+    bool validMetadata = false; // EXIF data with a usable creation date
+};
+using PhotoPipelineQueue = BoundedQueue<PipelinedPhoto>;
 
 class Scanner : public QObject {
     Q_OBJECT
@@ -34,9 +44,19 @@ public:
     std::vector<std::unique_ptr<PhotoFileHandler>>& getInvalidPhotoFileHandlers();
     int const getTotalFilesFound();
     int const getTotalPhotoFilesFound();
+    // Videos are transferred with the photos but counted on their own
+    int const getVideoFilesFound();
     int const getPhotoFilesFoundContainingEXIFData();
     int const getPhotoFilesFoundContainingValidCreationDate();
     int const getPhotoFilesUnsupportedFiles();
+    // While set, scanned photos are pushed to 'queue' as soon as they are
+    // processed instead of being collected (the queue is closed when the
+    // scan ends). Only change this while no scan is running.
+    void setPipelineQueue(PhotoPipelineQueue* queue);
+    // Scans of a transfer's target directories neither read nor write the
+    // scan cache: the main scan may still be using the file (with --pipeline)
+    // and replaces it when it ends
+    void setScanCacheUsed(bool used);
     std::atomic<bool> cancelScan{false};
     std::atomic<bool> scanRunning{false};
     ~Scanner();    
@@ -48,16 +68,44 @@ signals:
     void scanCompleted();
 
 private:
+    // A batch of files handed to one scan worker. Each worker only writes to
+    // its own batch, so no lock is needed; batches are merged once the pool
+    // has finished.
+    struct ScanBatch {
+        std::vector<std::string> filePaths;
+        std::vector<std::unique_ptr<BasicFileHandler>> basicFileHandlers;
+        std::vector<std::unique_ptr<PhotoFileHandler>> photoFileHandlers;
+        std::vector<std::unique_ptr<PhotoFileHandler>> invalidPhotoFileHandlers;
+        std::vector<ScanCacheEntry> pipelinedCacheEntries; // Of handlers already queued
+    };
+    static constexpr size_t scanBatchSize = 32;
+
     void scanDirectory(const std::string& directoryPath, bool includeSubdirectories);
-    void processScan();
+    void submitScanBatch();
+    void processScanBatch(ScanBatch& batch);
+    void addPhotoFileHandler(ScanBatch& batch, std::unique_ptr<PhotoFileHandler> handler, bool validMetadata);
+    std::unique_ptr<BasicFileHandler> makePhotoFileHandler(const std::string& path);
+    void mergeScanBatches();
+    void saveScanCache(const std::string& directoryPath, bool includeSubdirectories);
     std::atomic<int> filesFound{0};
+    std::atomic<int> basicFilesFound{0};
+    std::atomic<int> validPhotoFilesFound{0};
+    std::atomic<int> videoFilesFound{0};
+    std::atomic<int> scanCacheHits{0};
+    std::atomic<int> scanCacheMisses{0};
     std::atomic<int> photoFilesFoundContainingEXIFData{0};
     std::atomic<int> photoFilesFoundContainingValidCreationDate{0};
     std::atomic<int> photoFilesUnsupportedFound{0};
     std::vector<std::unique_ptr<BasicFileHandler>> basicFileHandlers;
     std::vector<std::unique_ptr<PhotoFileHandler>> photoFileHandlers;
     std::vector<std::unique_ptr<PhotoFileHandler>> invalidPhotoFileHandlers;
-    std::vector<std::unique_ptr<VideoFileHandler>> videoFileHandlers;
+    std::vector<std::unique_ptr<ScanBatch>> scanBatches;
+    std::unique_ptr<ScanBatch> pendingScanBatch;
+    PhotoPipelineQueue* pipelineQueue = nullptr;
+    bool scanCacheUsed = true;
+    std::vector<ScanCacheEntry> pipelinedCacheEntries;
+    QThreadPool scanThreadPool;
+    ScanCache scanCache;
     FileFactory fileFactory;
 };
 
@@ -0,0 +1,103 @@
+/***********************************************************************
+ * File Name: sourceremover.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the SourceRemover class.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <filesystem>
+#include <iostream>
+#include <unordered_set>
+#include "sourceremover.h"
+#include "filecopier.h"
+
+SourceRemover::SourceRemover()
+    : queue(queueCapacity) {
+    queue.close(); // Refuses files until started
+}
+
+SourceRemover::~SourceRemover() {
+    finish();
+}
+
+void SourceRemover::start() {
+    if (worker.joinable()) {
+        return;
+    }
+    queue.reset();
+    worker = std::thread([this]() { run(); });
+}
+
+bool SourceRemover::add(const std::string& sourcePath, const std::string& targetPath) {
+    Removal removal;
+    removal.sourcePath = sourcePath;
+    removal.targetDirectory = std::filesystem::path(targetPath).parent_path().string();
+    return queue.push(std::move(removal));
+}
+
+void SourceRemover::finish() {
+    queue.close();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+uint64_t SourceRemover::getFilesRemoved() const {
+    return filesRemoved.load();
+}
+
+uint64_t SourceRemover::getFilesFailed() const {
+    return filesFailed.load();
+}
+
+void SourceRemover::run() {
+    std::vector<Removal> batch;
+    batch.reserve(batchSize);
+    Removal removal;
+    // Waits for the first file of a batch, then takes whatever else is
+    // already queued
+    while (queue.pop(removal)) {
+        batch.push_back(std::move(removal));
+        while (batch.size() < batchSize && queue.tryPop(removal)) {
+            batch.push_back(std::move(removal));
+        }
+        removeBatch(batch);
+        batch.clear();
+    }
+}
+
+void SourceRemover::removeBatch(std::vector<Removal>& batch) {
+    // A batch usually lands in one or two directories
+    std::unordered_set<std::string> syncedDirectories;
+    std::unordered_set<std::string> failedDirectories;
+    for (const Removal& removal : batch) {
+        if (syncedDirectories.count(removal.targetDirectory) || failedDirectories.count(removal.targetDirectory)) {
+            continue;
+        }
+        std::error_code ec;
+        if (FileCopier::syncDirectory(removal.targetDirectory, ec)) {
+            syncedDirectories.insert(removal.targetDirectory);
+        } else {
+            std::cerr << "Unable to sync directory " << removal.targetDirectory << ": " << ec.message() << std::endl;
+            failedDirectories.insert(removal.targetDirectory);
+        }
+    }
+
+    for (const Removal& removal : batch) {
+        // Without a durable target entry the source is the only safe copy
+        if (failedDirectories.count(removal.targetDirectory)) {
+            std::cerr << "Source kept: " << removal.sourcePath << std::endl;
+            filesFailed++;
+            continue;
+        }
+        std::error_code ec;
+        std::filesystem::remove(removal.sourcePath, ec);
+        if (!ec) {
+            filesRemoved++;
+        } else {
+            std::cerr << "Unable to remove moved file " << removal.sourcePath << ": " << ec.message() << std::endl;
+            filesFailed++;
+        }
+    }
+}
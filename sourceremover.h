@@ -0,0 +1,64 @@
+#ifndef SOURCEREMOVER_H
+#define SOURCEREMOVER_H
+
+/***********************************************************************
+ * File Name: sourceremover.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the SourceRemover class, which deletes the
+ *              source files of moves between devices (a copy that cannot be
+ *              a rename). The transfer threads queue each source once its
+ *              copy is complete and synced; a worker thread takes them in
+ *              batches, syncs each target directory of the batch once so the
+ *              new entries are durable, and only then unlinks the sources.
+ *              Removal runs behind the copies instead of between them, so a
+ *              move goes as fast as a copy.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+#include "boundedqueue.h"
+
+class SourceRemover
+{
+public:
+    SourceRemover();
+    ~SourceRemover();
+    SourceRemover(const SourceRemover&) = delete;
+    SourceRemover& operator=(const SourceRemover&) = delete;
+
+    void start();
+    // Queues 'sourcePath' for removal once the directory of 'targetPath' (its
+    // complete, synced copy) has been synced. Blocks while the worker is
+    // 'queueCapacity' files behind. Returns false if the remover is not
+    // running.
+    bool add(const std::string& sourcePath, const std::string& targetPath);
+    // Removes everything queued so far and stops the worker
+    void finish();
+
+    uint64_t getFilesRemoved() const;
+    uint64_t getFilesFailed() const;
+
+    static constexpr size_t batchSize = 64;
+    static constexpr size_t queueCapacity = 1024;
+
+private:
+    struct Removal {
+        std::string sourcePath;
+        std::string targetDirectory;
+    };
+
+    void run();
+    void removeBatch(std::vector<Removal>& batch);
+
+    BoundedQueue<Removal> queue;
+    std::thread worker;
+    std::atomic<uint64_t> filesRemoved{0};
+    std::atomic<uint64_t> filesFailed{0};
+};
+
+#endif // SOURCEREMOVER_H
@@ -0,0 +1,121 @@
+/***********************************************************************
+ * File Name: targetdirectoryindex.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the TargetDirectoryIndex class. Copy
+ *              numbers are parsed from the '_CopyNN' suffix of each file
+ *              stem by hand rather than with a regex per entry.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cctype>
+#include <filesystem>
+#include <iomanip>
+#include <sstream>
+#include "targetdirectoryindex.h"
+
+namespace {
+const std::string CopySuffix = "_Copy";
+}
+
+void TargetDirectoryIndex::build(const std::string& directoryPath) {
+    std::lock_guard<std::mutex> lock(mutex);
+    fileNames.clear();
+    highestCopyNumbers.clear();
+    built = true;
+    std::error_code ec;
+    if (!std::filesystem::is_directory(directoryPath, ec)) {
+        return; // Directory does not exist yet - nothing can conflict
+    }
+    for (const auto& entry : std::filesystem::directory_iterator(directoryPath, ec)) {
+        addFileLocked(entry.path().filename().string());
+    }
+}
+
+void TargetDirectoryIndex::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    fileNames.clear();
+    highestCopyNumbers.clear();
+    built = false;
+}
+
+bool TargetDirectoryIndex::isBuilt() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return built;
+}
+
+bool TargetDirectoryIndex::contains(const std::string& fileName) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return fileNames.count(fileName) > 0;
+}
+
+void TargetDirectoryIndex::addFile(const std::string& fileName) {
+    std::lock_guard<std::mutex> lock(mutex);
+    addFileLocked(fileName);
+}
+
+bool TargetDirectoryIndex::reserveFileName(const std::string& fileName) {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (fileNames.count(fileName) > 0) {
+        return false;
+    }
+    addFileLocked(fileName);
+    return true;
+}
+
+void TargetDirectoryIndex::addFileLocked(const std::string& fileName) {
+    fileNames.insert(fileName);
+    std::string copyKey;
+    int copyNumber;
+    if (splitCopyNumber(fileName, copyKey, copyNumber)) {
+        auto it = highestCopyNumbers.find(copyKey);
+        if (it == highestCopyNumbers.end() || it->second < copyNumber) {
+            highestCopyNumbers[copyKey] = copyNumber;
+        }
+    }
+}
+
+std::string TargetDirectoryIndex::reserveCopyFileName(const std::string& fileName) {
+    std::lock_guard<std::mutex> lock(mutex);
+    // An existing copy suffix is stripped so copies of copies are numbered
+    // against the original name
+    std::string copyKey;
+    int copyNumber;
+    if (!splitCopyNumber(fileName, copyKey, copyNumber)) {
+        copyKey = std::filesystem::path(fileName).filename().string();
+    }
+    std::filesystem::path copyKeyPath(copyKey);
+    std::string baseFilename = copyKeyPath.stem().string();
+    std::string extension = copyKeyPath.extension().string();
+
+    auto it = highestCopyNumbers.find(copyKey);
+    int newNumber = (it == highestCopyNumbers.end()) ? 0 : it->second + 1;
+
+    std::ostringstream oss;
+    oss << baseFilename << CopySuffix << std::setw(2) << std::setfill('0') << newNumber << extension;
+    std::string copyFileName = oss.str();
+    addFileLocked(copyFileName);
+    return copyFileName;
+}
+
+// Splits 'base_CopyNN.ext' into the key 'base.ext' and NN
+bool TargetDirectoryIndex::splitCopyNumber(const std::string& fileName, std::string& copyKey, int& copyNumber) {
+    std::filesystem::path filePath(fileName);
+    std::string stem = filePath.stem().string();
+
+    size_t digitsStart = stem.size();
+    while (digitsStart > 0 && std::isdigit(static_cast<unsigned char>(stem[digitsStart - 1]))) {
+        --digitsStart;
+    }
+    if (digitsStart == stem.size() || digitsStart < CopySuffix.size() ||
+        stem.compare(digitsStart - CopySuffix.size(), CopySuffix.size(), CopySuffix) != 0) {
+        return false;
+    }
+    std::string digits = stem.substr(digitsStart);
+    if (digits.size() > 9) {
+        return false; // Not a copy number we would have generated
+    }
+    copyNumber = std::stoi(digits);
+    copyKey = stem.substr(0, digitsStart - CopySuffix.size()) + filePath.extension().string();
+    return true;
+}
@@ -0,0 +1,51 @@
+#ifndef TARGETDIRECTORYINDEX_H
+#define TARGETDIRECTORYINDEX_H
+
+/***********************************************************************
+ * File Name: targetdirectoryindex.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the TargetDirectoryIndex class, an in-memory
+ *              index of the file names in a transfer target directory. It is
+ *              built with a single directory listing and then kept up to date
+ *              as files land, so filename conflict checks and '_CopyNN'
+ *              number assignment no longer walk the directory per file.
+ *              All methods are safe to call from several threads at once.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+
+class TargetDirectoryIndex
+{
+public:
+    TargetDirectoryIndex() = default;
+    void build(const std::string& directoryPath);
+    void clear();
+    bool isBuilt() const;
+
+    bool contains(const std::string& fileName) const;
+    // Registers a file that landed in (or is reserved for) the directory
+    void addFile(const std::string& fileName);
+    // Registers 'fileName' unless it is already in use. Returns false if it
+    // was taken.
+    bool reserveFileName(const std::string& fileName);
+    // Returns 'base_CopyNN.ext' with NN one above the highest copy number in
+    // use for 'base.ext' (any existing _CopyNN suffix of 'fileName' is
+    // ignored) and reserves the name in the index
+    std::string reserveCopyFileName(const std::string& fileName);
+
+private:
+    void addFileLocked(const std::string& fileName);
+    static bool splitCopyNumber(const std::string& fileName, std::string& copyKey, int& copyNumber);
+    std::unordered_set<std::string> fileNames;
+    // Highest '_CopyNN' number per 'base.ext'
+    std::unordered_map<std::string, int> highestCopyNumbers;
+    bool built = false;
+    mutable std::mutex mutex;
+};
+
+#endif // TARGETDIRECTORYINDEX_H
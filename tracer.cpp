@@ -0,0 +1,210 @@
+/***********************************************************************
+ * File Name: tracer.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the Tracer class. A thread gets its ring
+ *              buffer on its first span; the registry lock is taken only
+ *              then, so recording a span never waits on another thread.
+ *              When a thread exits its buffer goes back to the registry and
+ *              the next new thread carries on writing after the finished
+ *              thread's spans, so they stay in the trace and buffers only
+ *              ever cover the threads alive at once (thread pools come and
+ *              go with every scan and transfer).
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <vector>
+#include "tracer.h"
+
+std::atomic<bool> Tracer::enabled{false};
+
+namespace {
+
+struct TraceEvent {
+    const char* name;
+    const char* category;
+    uint64_t startNs;
+    uint64_t durationNs;
+    uint8_t detailLength;
+    char detail[Tracer::maxDetailLength];
+};
+
+struct ThreadTraceBuffer {
+    explicit ThreadTraceBuffer(uint32_t threadId) : events(Tracer::eventsPerThread), threadId(threadId) {}
+
+    std::vector<TraceEvent> events;
+    // Events ever written; only the thread holding the buffer writes it
+    std::atomic<uint64_t> written{0};
+    uint32_t threadId;
+};
+
+struct TraceRegistry {
+    std::mutex mutex;
+    std::vector<std::unique_ptr<ThreadTraceBuffer>> buffers;
+    std::vector<ThreadTraceBuffer*> freeBuffers; // Of exited threads
+    std::string outputPath;
+    uint64_t startNs = 0;
+};
+
+// Never destroyed: threads not joined before exit() may still hand their
+// buffers back
+TraceRegistry& registry() {
+    static TraceRegistry* instance = new TraceRegistry;
+    return *instance;
+}
+
+// Returns the thread's buffer to the registry when the thread exits
+struct ThreadBufferLease {
+    ~ThreadBufferLease() {
+        if (buffer) {
+            TraceRegistry& traceRegistry = registry();
+            std::lock_guard<std::mutex> lock(traceRegistry.mutex);
+            traceRegistry.freeBuffers.push_back(buffer);
+        }
+    }
+
+    ThreadTraceBuffer* buffer = nullptr;
+};
+
+thread_local ThreadBufferLease threadBuffer;
+
+ThreadTraceBuffer& getThreadBuffer() {
+    if (!threadBuffer.buffer) {
+        TraceRegistry& traceRegistry = registry();
+        std::lock_guard<std::mutex> lock(traceRegistry.mutex);
+        if (!traceRegistry.freeBuffers.empty()) {
+            threadBuffer.buffer = traceRegistry.freeBuffers.back();
+            traceRegistry.freeBuffers.pop_back();
+        } else {
+            uint32_t threadId = static_cast<uint32_t>(traceRegistry.buffers.size()) + 1;
+            traceRegistry.buffers.push_back(std::make_unique<ThreadTraceBuffer>(threadId));
+            threadBuffer.buffer = traceRegistry.buffers.back().get();
+        }
+    }
+    return *threadBuffer.buffer;
+}
+
+void writeJsonString(std::ostream& out, const char* text, size_t length) {
+    out << '"';
+    for (size_t i = 0; i < length; ++i) {
+        char c = text[i];
+        if (c == '"' || c == '\\') {
+            out << '\\' << c;
+        } else if (static_cast<unsigned char>(c) < 0x20) {
+            char escaped[8];
+            std::snprintf(escaped, sizeof(escaped), "\\u%04x", static_cast<unsigned>(c));
+            out << escaped;
+        } else {
+            out << c;
+        }
+    }
+    out << '"';
+}
+
+// Chrome trace times are in microseconds
+void writeMicroseconds(std::ostream& out, uint64_t nanoseconds) {
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%llu.%03u", static_cast<unsigned long long>(nanoseconds / 1000),
+                  static_cast<unsigned>(nanoseconds % 1000));
+    out << buffer;
+}
+
+}
+
+void Tracer::start(const std::string& outputPath) {
+    TraceRegistry& traceRegistry = registry();
+    std::lock_guard<std::mutex> lock(traceRegistry.mutex);
+    for (auto& buffer : traceRegistry.buffers) {
+        buffer->written.store(0, std::memory_order_relaxed);
+    }
+    traceRegistry.outputPath = outputPath;
+    traceRegistry.startNs = now();
+    enabled.store(true, std::memory_order_release);
+}
+
+void Tracer::startFromEnvironment() {
+    const char* outputPath = std::getenv("METAMOVER_TRACE");
+    if (outputPath && *outputPath) {
+        start(outputPath);
+    }
+}
+
+bool Tracer::finish() {
+    if (!enabled.exchange(false)) {
+        return false;
+    }
+    return writeChromeTrace(registry().outputPath);
+}
+
+void Tracer::record(const char* name, const char* category, uint64_t startNs, uint64_t endNs,
+                    const char* detail, size_t detailLength) {
+    // Spans still open when the trace stops are dropped
+    if (!isEnabled()) {
+        return;
+    }
+    ThreadTraceBuffer& buffer = getThreadBuffer();
+    uint64_t index = buffer.written.load(std::memory_order_relaxed);
+    TraceEvent& event = buffer.events[index % eventsPerThread];
+    event.name = name;
+    event.category = category;
+    event.startNs = startNs;
+    event.durationNs = endNs - startNs;
+    event.detailLength = static_cast<uint8_t>(detailLength);
+    std::memcpy(event.detail, detail, detailLength);
+    buffer.written.store(index + 1, std::memory_order_release);
+}
+
+bool Tracer::writeChromeTrace(const std::string& path) {
+    std::ofstream out(path, std::ios::trunc);
+    if (!out) {
+        std::cerr << "Unable to write trace file: " << path << std::endl;
+        return false;
+    }
+
+    TraceRegistry& traceRegistry = registry();
+    std::lock_guard<std::mutex> lock(traceRegistry.mutex);
+    uint64_t eventCount = 0;
+    uint64_t droppedEvents = 0;
+    out << "{\"traceEvents\":[\n";
+    out << "{\"name\":\"process_name\",\"ph\":\"M\",\"pid\":1,\"tid\":0,\"args\":{\"name\":\"MetaMover\"}}";
+    for (const auto& buffer : traceRegistry.buffers) {
+        uint64_t written = buffer->written.load(std::memory_order_acquire);
+        uint64_t first = written > eventsPerThread ? written - eventsPerThread : 0;
+        droppedEvents += first;
+        for (uint64_t index = first; index < written; ++index) {
+            const TraceEvent& event = buffer->events[index % eventsPerThread];
+            if (event.startNs < traceRegistry.startNs) {
+                continue; // Started before the trace did
+            }
+            out << ",\n{\"name\":\"" << event.name << "\",\"cat\":\"" << event.category
+                << "\",\"ph\":\"X\",\"ts\":";
+            writeMicroseconds(out, event.startNs - traceRegistry.startNs);
+            out << ",\"dur\":";
+            writeMicroseconds(out, event.durationNs);
+            out << ",\"pid\":1,\"tid\":" << buffer->threadId;
+            if (event.detailLength) {
+                out << ",\"args\":{\"detail\":";
+                writeJsonString(out, event.detail, event.detailLength);
+                out << '}';
+            }
+            out << '}';
+            ++eventCount;
+        }
+    }
+    out << "\n],\"displayTimeUnit\":\"ms\",\"otherData\":{\"droppedEvents\":" << droppedEvents << "}}\n";
+    out.close();
+    if (!out) {
+        std::cerr << "Unable to write trace file: " << path << std::endl;
+        return false;
+    }
+    std::cerr << "Trace written to " << path << " (" << eventCount << " spans, "
+              << droppedEvents << " overwritten)" << std::endl;
+    return true;
+}
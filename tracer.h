@@ -0,0 +1,103 @@
+#ifndef TRACER_H
+#define TRACER_H
+
+/***********************************************************************
+ * File Name: tracer.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the Tracer class and the TraceSpan scope
+ *              guard, which time the stages of a scan and transfer
+ *              (directory enumeration, EXIF reads, duplicate checks, path
+ *              generation, copies). Each thread records its spans in its
+ *              own ring buffer, and the trace is written as Chrome trace
+ *              JSON that chrome://tracing and ui.perfetto.dev open.
+ *              Tracing is off unless started (METAMOVER_TRACE=<file>, or
+ *              --trace <file> in batch mode); a span then costs one relaxed
+ *              atomic load.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+class Tracer
+{
+public:
+    static bool isEnabled() {
+        return enabled.load(std::memory_order_relaxed);
+    }
+    static uint64_t now() {
+        return static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+    }
+
+    // Clears the ring buffers and starts recording; finish() writes the
+    // trace to 'outputPath'. Call before the traced work starts.
+    static void start(const std::string& outputPath);
+    // Starts if the METAMOVER_TRACE environment variable names a file
+    static void startFromEnvironment();
+    // Stops recording and writes the trace, if it was started. Call once the
+    // traced work is done - the ring buffers are read without locks.
+    static bool finish();
+
+    // Called by TraceSpan. 'detail' (e.g. the file path) is cut to its last
+    // maxDetailLength characters.
+    static void record(const char* name, const char* category, uint64_t startNs, uint64_t endNs,
+                       const char* detail, size_t detailLength);
+
+    // Events kept per thread; the oldest are overwritten once it is full
+    static constexpr size_t eventsPerThread = 1 << 16;
+    static constexpr size_t maxDetailLength = 39;
+
+private:
+    static bool writeChromeTrace(const std::string& path);
+
+    static std::atomic<bool> enabled;
+};
+
+// Records the time from its construction to its destruction on the current
+// thread. 'name' and 'category' must be string literals.
+class TraceSpan
+{
+public:
+    TraceSpan(const char* name, const char* category)
+        : name(name), category(category), startNs(Tracer::isEnabled() ? Tracer::now() : 0) {}
+    TraceSpan(const char* name, const char* category, const std::string& detail)
+        : TraceSpan(name, category) {
+        setDetail(detail);
+    }
+    ~TraceSpan() {
+        if (startNs) {
+            Tracer::record(name, category, startNs, Tracer::now(), detail, detailLength);
+        }
+    }
+    TraceSpan(const TraceSpan&) = delete;
+    TraceSpan& operator=(const TraceSpan&) = delete;
+
+    // False while tracing is off - lets callers skip building a detail
+    bool isRecording() const {
+        return startNs != 0;
+    }
+    void setDetail(const std::string& text) {
+        if (!startNs) {
+            return;
+        }
+        size_t skipped = text.size() > Tracer::maxDetailLength ? text.size() - Tracer::maxDetailLength : 0;
+        while (skipped && skipped < text.size() && (static_cast<unsigned char>(text[skipped]) & 0xC0) == 0x80) {
+            ++skipped; // Not in the middle of a UTF-8 character
+        }
+        detailLength = text.size() - skipped;
+        text.copy(detail, detailLength, skipped);
+    }
+
+private:
+    const char* name;
+    const char* category;
+    uint64_t startNs;
+    size_t detailLength = 0;
+    char detail[Tracer::maxDetailLength];
+};
+
+#endif // TRACER_H
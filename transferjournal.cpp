@@ -0,0 +1,276 @@
+/***********************************************************************
+ * File Name: transferjournal.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the TransferJournal class. The journal is
+ *              a sequence of records - length, type, payload and a hash of
+ *              the type and payload - in host byte order, like the scan
+ *              cache. Completion records refer to planned records by their
+ *              position.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include "transferjournal.h"
+#include "contenthasher.h"
+#include "filecopier.h"
+
+namespace {
+
+constexpr char JournalMagic[4] = {'M', 'M', 'T', 'J'};
+constexpr uint32_t JournalVersion = 1;
+constexpr uint32_t MaxRecordSize = 1 << 20;
+
+template <typename T>
+void appendValue(std::string& out, T value) {
+    out.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+void appendString(std::string& out, const std::string& value) {
+    appendValue(out, static_cast<uint32_t>(value.size()));
+    out += value;
+}
+
+// Reads from a record payload, failing (rather than reading past the end) on
+// a malformed record
+class PayloadReader
+{
+public:
+    PayloadReader(const char* data, size_t size) : data(data), size(size) {}
+    template <typename T>
+    bool read(T& value) {
+        if (size - position < sizeof(value)) return false;
+        std::memcpy(&value, data + position, sizeof(value));
+        position += sizeof(value);
+        return true;
+    }
+    bool readString(std::string& value) {
+        uint32_t length;
+        if (!read(length) || size - position < length) return false;
+        value.assign(data + position, length);
+        position += length;
+        return true;
+    }
+private:
+    const char* data;
+    size_t size;
+    size_t position = 0;
+};
+
+uint64_t recordHash(uint8_t type, const char* payload, size_t length) {
+    ContentHasher hasher;
+    hasher.update(&type, sizeof(type));
+    hasher.update(payload, length);
+    return hasher.digest();
+}
+
+}
+
+TransferJournal::~TransferJournal() {
+    finish();
+}
+
+void TransferJournal::begin(const std::string& path, bool move) {
+    finish();
+    journalPath = path;
+    moveFiles = move;
+    failed = false;
+    plannedCount = 0;
+    completedCount = 0;
+}
+
+uint32_t TransferJournal::plan(const std::vector<JournalEntry>& entries) {
+    std::unique_lock<std::mutex> lock(mutex);
+    if (journalPath.empty() || failed || entries.empty()) {
+        return NoId;
+    }
+    bool written;
+    std::FILE* unsyncedFile = nullptr;
+    if (!journalFile) {
+        written = create(entries);
+    } else {
+        std::string records;
+        for (const JournalEntry& entry : entries) {
+            appendRecord(records, RecordPlanned, plannedPayload(entry));
+        }
+        written = std::fwrite(records.data(), 1, records.size(), journalFile) == records.size() &&
+                  std::fflush(journalFile) == 0;
+        unsyncedFile = journalFile;
+    }
+    uint32_t firstId = plannedCount;
+    if (written) {
+        plannedCount += static_cast<uint32_t>(entries.size());
+        // markCompleted() only appends, so workers finishing files need not
+        // wait for the sync
+        lock.unlock();
+        std::error_code ec;
+        written = !unsyncedFile || FileCopier::syncFile(unsyncedFile, ec);
+        lock.lock();
+    }
+    if (!written) {
+        std::cerr << "Unable to write the transfer journal " << journalPath
+                  << ", continuing without it." << std::endl;
+        failed = true;
+        return NoId;
+    }
+    return firstId;
+}
+
+// The first records go to a temporary file that is renamed over the old
+// journal, so an interrupted transfer's journal is only replaced by one
+// that already holds the new plan
+bool TransferJournal::create(const std::vector<JournalEntry>& entries) {
+    std::string records;
+    std::string header(JournalMagic, sizeof(JournalMagic));
+    appendValue(header, JournalVersion);
+    appendValue(header, static_cast<uint8_t>(moveFiles));
+    appendRecord(records, RecordHeader, header);
+    for (const JournalEntry& entry : entries) {
+        appendRecord(records, RecordPlanned, plannedPayload(entry));
+    }
+
+    std::string temporaryPath = journalPath + ".tmp";
+    std::error_code ec;
+    {
+        std::ofstream out(temporaryPath, std::ios::binary | std::ios::trunc);
+        if (!out.write(records.data(), static_cast<std::streamsize>(records.size())) || !out.flush()) {
+            std::filesystem::remove(temporaryPath, ec);
+            return false;
+        }
+    }
+    if (!FileCopier::syncFile(temporaryPath, ec)) {
+        std::filesystem::remove(temporaryPath, ec);
+        return false;
+    }
+    std::filesystem::rename(temporaryPath, journalPath, ec);
+    if (ec) {
+        std::filesystem::remove(temporaryPath, ec);
+        return false;
+    }
+    FileCopier::syncDirectory(std::filesystem::path(journalPath).parent_path(), ec);
+    journalFile = std::fopen(journalPath.c_str(), "ab");
+    return journalFile != nullptr;
+}
+
+void TransferJournal::markCompleted(uint32_t id, bool skipped) {
+    if (id == NoId) {
+        return;
+    }
+    std::string payload;
+    appendValue(payload, id);
+    std::string record;
+    appendRecord(record, skipped ? RecordSkipped : RecordTransferred, payload);
+    std::lock_guard<std::mutex> lock(mutex);
+    if (!journalFile || failed) {
+        return;
+    }
+    if (std::fwrite(record.data(), 1, record.size(), journalFile) != record.size() || std::fflush(journalFile) != 0) {
+        std::cerr << "Unable to write the transfer journal " << journalPath << std::endl;
+        failed = true;
+        return;
+    }
+    completedCount++;
+}
+
+void TransferJournal::finish() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (journalFile) {
+        std::fclose(journalFile);
+        journalFile = nullptr;
+        std::error_code ec;
+        if (!failed && completedCount == plannedCount) {
+            std::filesystem::remove(journalPath, ec);
+        } else {
+            std::cerr << "Transfer incomplete (" << completedCount << " of " << plannedCount
+                      << " files), journal kept for resume: " << journalPath << std::endl;
+        }
+    }
+    journalPath.clear();
+}
+
+bool TransferJournal::isOpen() const {
+    return journalFile != nullptr;
+}
+
+void TransferJournal::appendRecord(std::string& out, RecordType type, const std::string& payload) {
+    appendValue(out, static_cast<uint32_t>(payload.size()));
+    appendValue(out, static_cast<uint8_t>(type));
+    out += payload;
+    appendValue(out, recordHash(type, payload.data(), payload.size()));
+}
+
+std::string TransferJournal::plannedPayload(const JournalEntry& entry) {
+    std::string payload;
+    appendValue(payload, entry.fileSize);
+    appendValue(payload, static_cast<uint8_t>(entry.overwrite));
+    appendString(payload, entry.sourcePath);
+    appendString(payload, entry.targetPath);
+    return payload;
+}
+
+bool TransferJournal::load(const std::string& journalPath, bool& moveFiles, std::vector<JournalEntry>& entries) {
+    entries.clear();
+    std::ifstream in(journalPath, std::ios::binary);
+    if (!in) {
+        return false;
+    }
+    std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+
+    size_t position = 0;
+    bool headerRead = false;
+    const size_t framing = sizeof(uint32_t) + sizeof(uint8_t) + sizeof(uint64_t);
+    while (data.size() - position >= framing) {
+        uint32_t length;
+        uint8_t type;
+        uint64_t hash;
+        std::memcpy(&length, data.data() + position, sizeof(length));
+        std::memcpy(&type, data.data() + position + sizeof(length), sizeof(type));
+        if (length > MaxRecordSize || data.size() - position - framing < length) {
+            break; // Torn by the interruption
+        }
+        const char* payload = data.data() + position + sizeof(length) + sizeof(type);
+        std::memcpy(&hash, payload + length, sizeof(hash));
+        if (hash != recordHash(type, payload, length)) {
+            break;
+        }
+        position += framing + length;
+
+        PayloadReader reader(payload, length);
+        if (!headerRead) {
+            char magic[4];
+            uint32_t version;
+            uint8_t move;
+            if (type != RecordHeader || !reader.read(magic) || std::memcmp(magic, JournalMagic, sizeof(magic)) != 0 ||
+                !reader.read(version) || version != JournalVersion || !reader.read(move)) {
+                return false;
+            }
+            moveFiles = move != 0;
+            headerRead = true;
+        } else if (type == RecordPlanned) {
+            JournalEntry entry;
+            uint8_t overwrite;
+            if (!reader.read(entry.fileSize) || !reader.read(overwrite) ||
+                !reader.readString(entry.sourcePath) || !reader.readString(entry.targetPath)) {
+                break;
+            }
+            entry.overwrite = overwrite != 0;
+            entries.push_back(std::move(entry));
+        } else if (type == RecordTransferred || type == RecordSkipped) {
+            uint32_t id;
+            if (reader.read(id) && id < entries.size()) {
+                entries[id].state = type == RecordSkipped ? JournalEntry::State::Skipped
+                                                          : JournalEntry::State::Transferred;
+            }
+        }
+    }
+    return headerRead;
+}
+
+bool TransferJournal::exists(const std::string& journalPath) {
+    std::error_code ec;
+    return std::filesystem::exists(journalPath, ec);
+}
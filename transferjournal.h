@@ -0,0 +1,101 @@
+#ifndef TRANSFERJOURNAL_H
+#define TRANSFERJOURNAL_H
+
+/***********************************************************************
+ * File Name: transferjournal.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the TransferJournal class, a write-ahead log
+ *              of a running transfer kept next to config.dat. Every file is
+ *              planned (source, target, size) and synced to disk before it
+ *              is transferred, and a completion record is appended once it
+ *              has landed. Files are copied to a temporary name and renamed
+ *              into place, so a target under its real name is always
+ *              complete. If the process dies or a drive drops mid-transfer,
+ *              the journal is left behind and a resume transfers only the
+ *              files without a completion record, without rescanning the
+ *              source or hashing the targets. The journal is deleted once
+ *              every planned file has completed.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <vector>
+
+// One planned file of a journaled transfer
+struct JournalEntry {
+    enum class State : uint8_t {
+        Planned,
+        Transferred,
+        Skipped     // The target existed and overwrite was disabled
+    };
+
+    std::string sourcePath;
+    std::string targetPath;
+    uint64_t fileSize = 0;
+    bool overwrite = false;
+    State state = State::Planned;
+};
+
+class TransferJournal
+{
+public:
+    TransferJournal() = default;
+    ~TransferJournal();
+    TransferJournal(const TransferJournal&) = delete;
+    TransferJournal& operator=(const TransferJournal&) = delete;
+
+    // Prepares a journal for a transfer that moves or copies its files. The
+    // file is only written (replacing the journal of an earlier transfer) by
+    // the first plan() call.
+    void begin(const std::string& journalPath, bool moveFiles);
+    // Records 'entries' and syncs them to disk. Returns the id of the first
+    // entry (the others follow in order), or NoId if the journal could not
+    // be written - the transfer then goes ahead without one. Plan files in
+    // batches where possible: each call costs a sync. Call begin(), plan()
+    // and finish() from the same thread.
+    uint32_t plan(const std::vector<JournalEntry>& entries);
+    // Appends a completion record. Not synced: a lost record only means the
+    // file is checked again on resume, where a moved file whose target
+    // matches its source has just its source removed. Safe to call from
+    // several threads.
+    void markCompleted(uint32_t id, bool skipped);
+    // Closes the journal. It is deleted if every planned file completed and
+    // kept for a resume otherwise.
+    void finish();
+    bool isOpen() const;
+
+    // Reads the journal of an interrupted transfer. A record torn by the
+    // interruption ends the journal. Returns false if there is no readable
+    // journal.
+    static bool load(const std::string& journalPath, bool& moveFiles, std::vector<JournalEntry>& entries);
+    static bool exists(const std::string& journalPath);
+
+    static constexpr uint32_t NoId = UINT32_MAX;
+
+private:
+    enum RecordType : uint8_t {
+        RecordHeader = 'H',
+        RecordPlanned = 'P',
+        RecordTransferred = 'T',
+        RecordSkipped = 'S'
+    };
+
+    bool create(const std::vector<JournalEntry>& entries);
+    static void appendRecord(std::string& out, RecordType type, const std::string& payload);
+    static std::string plannedPayload(const JournalEntry& entry);
+
+    std::mutex mutex;
+    std::string journalPath;
+    std::FILE* journalFile = nullptr;
+    bool moveFiles = false;
+    bool failed = false;
+    uint32_t plannedCount = 0;
+    std::atomic<uint32_t> completedCount{0};
+};
+
+#endif // TRANSFERJOURNAL_H
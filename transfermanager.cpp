@@ -9,17 +9,16 @@
  *              consistent transfer process. The class is meticulously designed
  *              to handle multithreading with atomic operations and integrates
  *              error handling to provide reliability. Additionally, it uses
- *              standard filesystem operations and regex for file management.
+ *              standard filesystem operations for file management.
  * License: MIT License
  ***********************************************************************/
 
-#include <ctime>
-#include <sstream>
 #include <iostream>
-#include <regex>
-#include <set>
 #include <filesystem>
 #include "transfermanager.h"
+#include "contenthasher.h"
+#include "transferscheduler.h"
+#include "tracer.h"
 
 TransferManager::TransferManager(QObject* parent)
     : QObject(parent), progressCounter(0), configManager(AppConfig::get()) {
@@ -30,38 +29,212 @@ TransferManager::~TransferManager() {}
 void TransferManager::processPhotoFiles(std::vector<std::unique_ptr<PhotoFileHandler>> *photoFileHandlers,
                                         std::vector<std::unique_ptr<PhotoFileHandler>> *invalidPhotoFileHandlers,
                                         bool moveFiles){
+    TraceSpan span("TransferManager::processPhotoFiles", "transfer");
     transferRunning = true;
     cancelTransfer = false;
     progressCounter = 0; // Reset progress
+    compilePathTemplates();
     addDirectoryTransfers(*photoFileHandlers);
     processDuplicatePhotoFiles();
     if(configManager.config.getMoveInvalidFileMeta()){
         addDirectoryTransfers(*invalidPhotoFileHandlers, configManager.config.getInvalidFileMetaDirectory());
     }
-    processFileTransfers(moveFiles);
+    processFileTransfers(moveFiles, configManager.config.getPhotosReplaceDashesWithUnderscores());
     transferRunning = false;
     resetTransferManager();
     emit transferComplete(); // Notify that processing is finished
 }
 
-void TransferManager::processFileTransfers(bool moveFiles) {
-    size_t total = directoryTransferMap.size();
-    size_t current = 0;
+void TransferManager::processPipelinedPhotoFiles(PhotoPipelineQueue* pipelineQueue, bool moveFiles) {
+    TraceSpan span("TransferManager::processPipelinedPhotoFiles", "transfer");
+    transferRunning = true;
+    cancelTransfer = false;
+    progressCounter = 0; // Reset progress
+    compilePathTemplates();
+    TransferScheduler transferScheduler(cancelTransfer, progressCounter, transferMetrics);
+    transferScheduler.setVerifyMoves(configManager.config.getVerifyMovedFiles());
+    transferScheduler.setVerifyCopies(configManager.config.getVerifyCopiedFiles());
+    if (configManager.config.getWriteChecksumManifests()) {
+        transferScheduler.setChecksumManifest(&checksumManifest);
+    }
+    transferJournal.begin(AppConfigManager::getDefaultTransferJournalPath(), moveFiles);
+    transferScheduler.setJournal(&transferJournal);
+    transferScheduler.beginStreaming(moveFiles, configManager.config.getPhotosReplaceDashesWithUnderscores(),
+                                     configManager.config.getTransfersPerDevice());
+    PipelinedPhoto pipelinedPhoto;
+    while (pipelineQueue->pop(pipelinedPhoto)) {
+        if (cancelTransfer) {
+            pipelineQueue->close(); // Stops the Scanner feeding us; the rest is dropped
+            continue;
+        }
+        try {
+            DirectoryTransfer* directoryTransfer = addPipelinedPhotoFile(pipelinedPhoto);
+            if (directoryTransfer) {
+                transferScheduler.submitFile(*directoryTransfer, *directoryTransfer->getPhotoFileToTransfer().back());
+            }
+        } catch (const std::exception& e) {
+            std::cerr << "Exception caught in processPipelinedPhotoFiles: " << e.what() << std::endl;
+        }
+        // Start the journaled files now rather than wait for the scanner
+        if (pipelineQueue->size() == 0) {
+            transferScheduler.flushSubmittedFiles();
+        }
+    }
+    transferScheduler.finishStreaming();
+    checksumManifest.save();
+    transferJournal.finish();
+    if(cancelTransfer){
+        progressCounter = 0;
+    }
+    transferRunning = false;
+    resetTransferManager();
+    emit transferComplete(); // Notify that processing is finished
+}
+
+// Routes one photo to its DirectoryTransfer, the way addDirectoryTransfers
+// and processDuplicatePhotoFiles do for a whole scan. Files already
+// transferred cannot be taken back, so the first of two duplicates to
+// arrive is the one kept. Returns nullptr if the photo is not transferred.
+DirectoryTransfer* TransferManager::addPipelinedPhotoFile(PipelinedPhoto& pipelinedPhoto) {
+    TraceSpan span("TransferManager::addPipelinedPhotoFile", "transfer");
+    std::unique_ptr<PhotoFileHandler>& handler = pipelinedPhoto.photoFileHandler;
+    std::string outputDirectory;
+    if (!pipelinedPhoto.validMetadata) {
+        if (!configManager.config.getMoveInvalidFileMeta()) {
+            return nullptr;
+        }
+        outputDirectory = configManager.config.getInvalidFileMetaDirectory();
+    } else {
+        applyFileNameTemplate(handler.get());
+        outputDirectory = generateDirectoryPath(handler.get());
+    }
+    DirectoryTransfer& directoryTransfer = directoryTransferMap[outputDirectory];
+    directoryTransfer.setTargetDirectory(outputDirectory);
 
+    if (pipelinedPhoto.validMetadata) {
+        bool duplicate = false;
+        std::string identity = configManager.config.getPhotosDuplicateIdentitySetting();
+        if (identity == "File Names Match") {
+            duplicate = !directoryTransfer.getTargetDirectoryIndex().reserveFileName(handler->getTargetFileName());
+        } else if (identity == "All EXIF and Exact File Contents Match") {
+            duplicate = directoryTransfer.checkEXIFDuplicate(*handler,
+                configManager.config.getPhotosReplaceDashesWithUnderscores());
+        }
+        if (duplicate) {
+            DirectoryTransfer* duplicateTransfer = addDuplicateTransfer(handler,
+                configManager.config.getDuplicatesFoundSelection());
+            if (duplicateTransfer) {
+                // Built before any file lands, so the listing is not raced
+                duplicateTransfer->getTargetDirectoryIndex();
+            }
+            return duplicateTransfer;
+        }
+    }
+    directoryTransfer.getTargetDirectoryIndex();
+    directoryTransfer.addPhotoFileToTransfer(handler);
+    return &directoryTransfer;
+}
+
+void TransferManager::processFileTransfers(bool moveFiles, bool replaceDashesWithUnderscores) {
+    TraceSpan span("TransferManager::processFileTransfers", "transfer");
+    TransferScheduler transferScheduler(cancelTransfer, progressCounter, transferMetrics);
+    transferScheduler.setVerifyMoves(configManager.config.getVerifyMovedFiles());
+    transferScheduler.setVerifyCopies(configManager.config.getVerifyCopiedFiles());
+    if (configManager.config.getWriteChecksumManifests()) {
+        transferScheduler.setChecksumManifest(&checksumManifest);
+    }
+    transferJournal.begin(AppConfigManager::getDefaultTransferJournalPath(), moveFiles);
+    transferScheduler.setJournal(&transferJournal);
     for(auto dt = directoryTransferMap.begin(); dt != directoryTransferMap.end(); ++dt){
-        if(cancelTransfer){
-            progressCounter = 0;
-            break;
+        transferScheduler.addDirectoryTransfer(dt->second);
+    }
+    transferScheduler.run(moveFiles, replaceDashesWithUnderscores, configManager.config.getTransfersPerDevice());
+    checksumManifest.save();
+    transferJournal.finish();
+    if(cancelTransfer){
+        progressCounter = 0;
+    }
+}
+
+void TransferManager::resumeInterruptedTransfer() {
+    transferRunning = true;
+    cancelTransfer = false;
+    progressCounter = 0; // Reset progress
+    bool moveFiles = false;
+    std::vector<JournalEntry> entries;
+    std::string journalPath = AppConfigManager::getDefaultTransferJournalPath();
+    if (TransferJournal::load(journalPath, moveFiles, entries)) {
+        addJournalTransfers(entries, moveFiles);
+        if (directoryTransferMap.empty()) {
+            std::error_code ec;
+            std::filesystem::remove(journalPath, ec); // Nothing was left to do
+        } else {
+            // The target names in the journal are final
+            processFileTransfers(moveFiles, false);
         }
-        dt->second.transferFiles(moveFiles, configManager.config.getPhotosReplaceDashesWithUnderscores());
-        current++;
-        // Calculate progress as a percentage
-        progressCounter = static_cast<int>((static_cast<double>(current) / total) * 100);
+    } else {
+        std::cerr << "No interrupted transfer to resume." << std::endl;
+    }
+    transferRunning = false;
+    resetTransferManager();
+    emit transferComplete(); // Notify that processing is finished
+}
+
+// Queues the unfinished files of a journal. Only file sizes and existence
+// are checked - a target under its real name is always complete, since
+// copies are renamed into place.
+void TransferManager::addJournalTransfers(const std::vector<JournalEntry>& entries, bool moveFiles) {
+    size_t movesFinished = 0;
+    for (const JournalEntry& entry : entries) {
+        std::filesystem::path targetPath(entry.targetPath);
+        std::error_code ec;
+        std::filesystem::remove(DirectoryTransfer::getTemporaryPath(targetPath), ec);
+        if (entry.state == JournalEntry::State::Skipped) {
+            continue;
+        }
+        if (entry.state == JournalEntry::State::Transferred) {
+            // A source moved across devices is removed after its completion
+            // record is written, so the interruption may have kept it
+            if (moveFiles && std::filesystem::exists(entry.sourcePath, ec) &&
+                std::filesystem::file_size(targetPath, ec) == entry.fileSize && !ec &&
+                FileCopier::syncDirectory(targetPath.parent_path(), ec)) {
+                std::filesystem::remove(entry.sourcePath, ec);
+            }
+            continue;
+        }
+        if (!std::filesystem::exists(entry.sourcePath, ec)) {
+            std::cerr << "Source no longer exists, skipped: " << entry.sourcePath << std::endl;
+            continue;
+        }
+        // Completion records are not synced, so a move may have landed
+        // without one. Only identical contents finish it here: a target that
+        // was there before may have the same size.
+        uint64_t sourceHash, targetHash;
+        if (moveFiles && std::filesystem::exists(targetPath, ec) &&
+            ContentHasher::hashFile(entry.sourcePath, sourceHash) &&
+            ContentHasher::hashFile(targetPath.string(), targetHash) && sourceHash == targetHash &&
+            FileCopier::syncDirectory(targetPath.parent_path(), ec) &&
+            std::filesystem::remove(entry.sourcePath, ec)) {
+            ++movesFinished;
+            continue;
+        }
+        auto handler = std::make_unique<PhotoFileHandler>(entry.sourcePath);
+        handler->setTargetFileName(targetPath.filename().string());
+        handler->setFileStat(entry.fileSize, 0);
+        handler->overwriteEnabled = entry.overwrite;
+        std::string targetDirectory = targetPath.parent_path().string();
+        DirectoryTransfer& directoryTransfer = directoryTransferMap[targetDirectory];
+        directoryTransfer.setTargetDirectory(targetDirectory);
+        directoryTransfer.addPhotoFileToTransfer(handler);
+    }
+    if (movesFinished > 0) {
+        std::cerr << movesFinished << " file(s) were already moved; their sources were removed." << std::endl;
     }
 }
 
 void TransferManager::resetTransferManager(){
-    // Cleanup
+    // Cleanup - transferMetrics are kept so the finished transfer can
+    // still be reported
     progressCounter = 0;
     directoryTransferMap.clear();
     duplicatesTransferMap.clear();
@@ -71,6 +244,7 @@ void TransferManager::resetTransferManager(){
 }
 
 void TransferManager::processDuplicatePhotoFiles(){
+    TraceSpan span("TransferManager::processDuplicatePhotoFiles", "dedupe");
     try {
         std::vector<std::unique_ptr<PhotoFileHandler>> duplicatesList;
         if(configManager.config.getPhotosDuplicateIdentitySetting() == "File Names Match") {
@@ -108,12 +282,14 @@ void TransferManager::processDuplicatePhotoFiles(){
 
 void TransferManager::addDirectoryTransfers(std::vector<std::unique_ptr<PhotoFileHandler>> &photoFileHandlers,
                                             std::string outputDirectory) {
+    TraceSpan span("TransferManager::addDirectoryTransfers", "transfer");
     if(outputDirectory != ""){
         directoryTransferMap[outputDirectory].setPhotoFilesToTransfer(photoFileHandlers);
         directoryTransferMap[outputDirectory].setTargetDirectory(outputDirectory);
         return;
     }
     for (auto& handler : photoFileHandlers) {
+        applyFileNameTemplate(handler.get());
         outputDirectory = generateDirectoryPath(handler.get());
         directoryTransferMap[outputDirectory].addPhotoFileToTransfer(handler);
         directoryTransferMap[outputDirectory].setTargetDirectory(outputDirectory);
@@ -123,29 +299,8 @@ void TransferManager::addDirectoryTransfers(std::vector<std::unique_ptr<PhotoFil
 void TransferManager::addDuplicateTransfers(std::vector<std::unique_ptr<PhotoFileHandler>> &photoFileHandlers) {
     try {
         std::string selection = configManager.config.getDuplicatesFoundSelection();
-        if(selection == "Add 'Copy##' and Move/Copy") {
-            for(auto& handler : photoFileHandlers){
-                std::string outputDirectory = generateDirectoryPath(handler.get());
-                handler->setTargetFileName(createNumericalFileName(handler->getTargetFileName(), outputDirectory));
-                directoryTransferMap[outputDirectory].addPhotoFileToTransfer(handler);
-                directoryTransferMap[outputDirectory].setTargetDirectory(outputDirectory);
-            }
-        } else if(selection == "Do Not Move or Copy") {
-            photoFileHandlers.clear();
-        } else if(selection == "Overwrite") {
-            for(auto& handler : photoFileHandlers){
-                handler->overwriteEnabled = true;
-                std::string outputDirectory = generateDirectoryPath(handler.get());
-                directoryTransferMap[outputDirectory].addPhotoFileToTransfer(handler);
-                directoryTransferMap[outputDirectory].setTargetDirectory(outputDirectory);
-            }
-        } else if(selection == "Move To Folder") {
-            for(auto& handler : photoFileHandlers){
-                std::string outputDirectory = configManager.config.getDuplicatesDirectory();
-                handler->setTargetFileName(createNumericalFileName(handler->getTargetFileName(), outputDirectory));
-                directoryTransferMap[outputDirectory].addPhotoFileToTransfer(handler);
-                directoryTransferMap[outputDirectory].setTargetDirectory(outputDirectory);
-            }
+        for(auto& handler : photoFileHandlers){
+            addDuplicateTransfer(handler, selection);
         }
     } catch (const std::exception& e) {
         std::cerr << "Exception caught in addDuplicateTransfers: " << e.what() << std::endl;
@@ -156,122 +311,108 @@ void TransferManager::addDuplicateTransfers(std::vector<std::unique_ptr<PhotoFil
     }
 }
 
+// Returns the DirectoryTransfer 'handler' was added to, or nullptr if the
+// duplicate is not transferred
+DirectoryTransfer* TransferManager::addDuplicateTransfer(std::unique_ptr<PhotoFileHandler> &handler,
+                                                         const std::string& selection) {
+    std::string outputDirectory;
+    if(selection == "Add 'Copy##' and Move/Copy") {
+        outputDirectory = generateDirectoryPath(handler.get());
+        handler->setTargetFileName(createNumericalFileName(handler->getTargetFileName(), outputDirectory));
+    } else if(selection == "Overwrite") {
+        handler->overwriteEnabled = true;
+        outputDirectory = generateDirectoryPath(handler.get());
+    } else if(selection == "Move To Folder") {
+        outputDirectory = configManager.config.getDuplicatesDirectory();
+        handler->setTargetFileName(createNumericalFileName(handler->getTargetFileName(), outputDirectory));
+    } else {
+        // "Do Not Move or Copy"
+        handler.reset();
+        return nullptr;
+    }
+    DirectoryTransfer& directoryTransfer = directoryTransferMap[outputDirectory];
+    directoryTransfer.addPhotoFileToTransfer(handler);
+    directoryTransfer.setTargetDirectory(outputDirectory);
+    return &directoryTransfer;
+}
+
 std::string TransferManager::createNumericalFileName(const std::string& fileName,
                                                      const std::string& targetDirectory,
                                                      bool forceCopySuffix) {
-    std::filesystem::path dirPath(targetDirectory);
-    std::filesystem::path filePath(fileName);
-
-    std::string baseFilename = filePath.stem().string();
-    std::string extension = filePath.extension().string();
+    TraceSpan span("TransferManager::createNumericalFileName", "dedupe", fileName);
+    // The index knows both the files already in the directory and the copy
+    // names handed out for files queued to it
+    DirectoryTransfer& directoryTransfer = directoryTransferMap[targetDirectory];
+    directoryTransfer.setTargetDirectory(targetDirectory);
+    TargetDirectoryIndex& targetDirectoryIndex = directoryTransfer.getTargetDirectoryIndex();
 
-    std::filesystem::path baseFilePath = dirPath / (baseFilename + extension);
-    if (!std::filesystem::exists(baseFilePath) && !forceCopySuffix) {
+    if (!targetDirectoryIndex.contains(fileName) && !forceCopySuffix) {
         return fileName;
     }
+    return targetDirectoryIndex.reserveCopyFileName(fileName);
+}
 
-    std::regex pattern("(_Copy\\d+)$");
-    std::smatch matches;
-
-    if (std::regex_search(baseFilename, matches, pattern)) {
-        baseFilename = baseFilename.substr(0, matches.position(0));
-    }
-
-    std::set<int> existingNumbers;
-    std::regex fullPattern(baseFilename + "_Copy(\\d+)" + std::regex_replace(extension, std::regex("\\."), "\\."));
-
-    for (const auto& entry : std::filesystem::directory_iterator(dirPath)) {
-        std::string filename = entry.path().filename().string();
-        if (std::regex_match(filename, matches, fullPattern) && matches.size() == 2) {
-            existingNumbers.insert(std::stoi(matches[1].str()));
-        }
-    }
-
-    std::vector<std::unique_ptr<PhotoFileHandler>> &photoFilesToTransfer = directoryTransferMap[targetDirectory].getPhotoFileToTransfer();
-    for(const auto& dt : photoFilesToTransfer){
-        std::string queuedFileName = dt->getTargetFileName();
-        std::filesystem::path queuedFilePath(queuedFileName);
-
-        std::string queuedBaseFilename = queuedFilePath.stem().string();
-        std::string queuedExtension = queuedFilePath.extension().string();
-
-        if (queuedExtension == extension && std::regex_match(queuedBaseFilename, matches, fullPattern) && matches.size() == 2) {
-            existingNumbers.insert(std::stoi(matches[1].str()));
-        }
+// The folder structure and file name patterns are compiled once per
+// transfer; generateDirectoryPath and applyFileNameTemplate only run the ops
+void TransferManager::compilePathTemplates() {
+    const char separator = QDir::separator().toLatin1();
+    std::string error;
+    if (!folderTemplate.compile(configManager.config.getPhotosOutputFolderStructureSelection(),
+                                PathTemplate::Kind::Folder, error, separator)) {
+        std::cerr << "Invalid folder structure (" << error << "), using Year, Month" << std::endl;
+        folderTemplate.compile("Year, Month", PathTemplate::Kind::Folder, error, separator);
     }
-
-    int newNumber = 0;
-    while (existingNumbers.count(newNumber)) {
-        ++newNumber;
+    if (!fileNameTemplate.compile(configManager.config.getPhotosFileNameTemplate(),
+                                  PathTemplate::Kind::FileName, error)) {
+        std::cerr << "Invalid file name template (" << error << "), keeping the file names" << std::endl;
+        fileNameTemplate.clear();
     }
-
-    std::ostringstream oss;
-    oss << baseFilename << "_Copy" << std::setw(2) << std::setfill('0') << newNumber << extension;
-    return oss.str();
+    outputDirectoryRoot = configManager.config.getOutputDirectory() + separator;
 }
 
-std::string TransferManager::generateDirectoryPath(PhotoFileHandler* handler) {
-    auto timePoint = handler->getOriginalDateTime();
-    std::time_t time = std::chrono::system_clock::to_time_t(timePoint);
-    std::tm dateTime;
-
-#if defined(_WIN32) || defined(_WIN64)
-    localtime_s(&dateTime, &time);
-#else
-    localtime_r(&time, &dateTime);
-#endif
-
-    std::vector<std::string> tokens;
-    std::istringstream iss(configManager.config.getPhotosOutputFolderStructureSelection());
-    std::string token;
-    std::string path = configManager.config.getOutputDirectory() + "/";
+// Returns a buffer that is overwritten by the next call
+const std::string& TransferManager::generateDirectoryPath(PhotoFileHandler* handler) {
+    TraceSpan span("TransferManager::generateDirectoryPath", "path");
+    PathTemplateFields fields;
+    fields.packedDateTime = handler->getPackedDateTimeOriginal();
+    fields.make = handler->getCameraMake();
+    fields.model = handler->getExifCameraModel();
+    fields.lens = handler->getLensModel();
+    directoryPathBuffer.assign(outputDirectoryRoot);
+    folderTemplate.render(fields, directoryPathBuffer);
+    return directoryPathBuffer;
+}
 
-    while (getline(iss, token, ',')) {
-        std::string trimmed;
-        std::remove_copy(token.begin(), token.end(), std::back_inserter(trimmed), ' ');
-        tokens.push_back(trimmed);
+// Renames a photo by the file name template, keeping its extension
+void TransferManager::applyFileNameTemplate(PhotoFileHandler* handler) {
+    if (fileNameTemplate.empty()) {
+        return;
     }
-
-    for (const auto& component : tokens) {
-        if (component == "CameraModel") {
-            path += handler->getCameraModel() + "/";
-        } else if (component == "Year") {
-            path += std::to_string(dateTime.tm_year + 1900) + "/";
-        } else if (component == "Month") {
-            path += getMonthName(dateTime.tm_mon + 1) + "/";
-        } else if (component == "Day") {
-            path += std::to_string(dateTime.tm_mday) + "/";
-        }
+    TraceSpan span("TransferManager::applyFileNameTemplate", "path");
+    std::string fileName = handler->getTargetFileName();
+    PathTemplateFields fields;
+    fields.packedDateTime = handler->getPackedDateTimeOriginal();
+    fields.make = handler->getCameraMake();
+    fields.model = handler->getExifCameraModel();
+    fields.lens = handler->getLensModel();
+    fields.fileName = fileName;
+    fileNameBuffer.clear();
+    fileNameTemplate.render(fields, fileNameBuffer);
+    if (fileNameBuffer.empty()) {
+        return; // Nothing to name it by - keep the name
     }
-    return QString(QDir::toNativeSeparators(QString::fromStdString(path))).toStdString();
-}
-
-std::string TransferManager::getMonthName(int monthNumber) {
-    // Map of month numbers to their corresponding month names
-    std::map<int, std::string> monthMap = {
-        {1, "January"},
-        {2, "February"},
-        {3, "March"},
-        {4, "April"},
-        {5, "May"},
-        {6, "June"},
-        {7, "July"},
-        {8, "August"},
-        {9, "September"},
-        {10, "October"},
-        {11, "November"},
-        {12, "December"}
-    };
-
-    // Check if the month number is valid
-    if (monthMap.find(monthNumber) != monthMap.end()) {
-        return monthMap[monthNumber];
-    } else {
-        //  Invalid specification - just return int as string
-        return std::to_string(monthNumber);
+    size_t extension = fileName.rfind('.');
+    if (extension != std::string::npos && extension > 0) {
+        fileNameBuffer.append(fileName, extension, std::string::npos);
     }
+    handler->setTargetFileName(fileNameBuffer);
 }
 
 int const TransferManager::getTransferProgress() {
     return progressCounter.load();
 }
+
+// Meant to be polled from the GUI thread while a transfer runs
+TransferMetricsSnapshot TransferManager::getTransferMetrics() {
+    return transferMetrics.getSnapshot();
+}
@@ -21,11 +21,23 @@
 #include <QThread>
 #include <QDir>
 #include <QString>
+#include <QMetaType>
 #include <vector>
 #include <memory>
 #include "photofilehandler.h"
 #include "directorytransfer.h"
 #include "appconfigmanager.h"
+#include "transfermetrics.h"
+#include "checksummanifest.h"
+#include "transferjournal.h"
+#include "scanner.h"
+#include "pathtemplate.h"
+
+// Type alias for the file lists passed to processPhotoFiles across threads
+using PhotoFileHandlerVector = std::vector<std::unique_ptr<PhotoFileHandler>>;
+
+Q_DECLARE_METATYPE(PhotoFileHandlerVector*)
+Q_DECLARE_METATYPE(PhotoPipelineQueue*)
 
 class TransferManager : public QObject {
     Q_OBJECT
@@ -35,6 +47,7 @@ public:
     ~TransferManager();
 
     int const getTransferProgress();
+    TransferMetricsSnapshot getTransferMetrics();
     void resetTransferManager();
     std::atomic<bool> transferRunning{false};
     std::atomic<bool> cancelTransfer{false};
@@ -46,21 +59,41 @@ public slots:
     void processPhotoFiles(std::vector<std::unique_ptr<PhotoFileHandler>> *photoFileHandlers,
                            std::vector<std::unique_ptr<PhotoFileHandler>> *invalidPhotoFileHandlers,
                            bool moveFiles = false);
+    // Transfers photos as the Scanner hands them over, until the Scanner
+    // closes the queue. Duplicates are decided per photo on arrival.
+    void processPipelinedPhotoFiles(PhotoPipelineQueue* pipelineQueue, bool moveFiles = false);
+    // Finishes the transfer recorded in the journal of an interrupted run:
+    // only files without a completion record are transferred, and neither
+    // the source nor the targets are scanned
+    void resumeInterruptedTransfer();
 
 private:
+    friend struct BenchmarkAccess; // benchmarks/microbenchmarks.cpp
     void processDuplicatePhotoFiles();
-    void processFileTransfers(bool moveFiles = false);
+    void processFileTransfers(bool moveFiles, bool replaceDashesWithUnderscores);
+    void addJournalTransfers(const std::vector<JournalEntry>& entries, bool moveFiles);
     void addDuplicateTransfers(std::vector<std::unique_ptr<PhotoFileHandler>> &photoFileHandlers);
+    DirectoryTransfer* addDuplicateTransfer(std::unique_ptr<PhotoFileHandler> &handler, const std::string& selection);
+    DirectoryTransfer* addPipelinedPhotoFile(PipelinedPhoto& pipelinedPhoto);
     void createDirectoryIfNotExists(const std::string& path);
     void addDirectoryTransfers(std::vector<std::unique_ptr<PhotoFileHandler>> &photoFileHandlers,
                                std::string outputDirectory = "");
     std::string createNumericalFileName(const std::string& fileName,
                                         const std::string &targetDirectory,
                                         bool forceCopySuffix = false);
-    std::string generateDirectoryPath(PhotoFileHandler* handler);
-    std::string getMonthName(int monthNumber);
+    void compilePathTemplates();
+    const std::string& generateDirectoryPath(PhotoFileHandler* handler);
+    void applyFileNameTemplate(PhotoFileHandler* handler);
+    PathTemplate folderTemplate;
+    PathTemplate fileNameTemplate;
+    std::string outputDirectoryRoot;
+    std::string directoryPathBuffer; // Reused by generateDirectoryPath
+    std::string fileNameBuffer;
     QTimer* progressTimer;
     std::atomic<int> progressCounter{0};
+    TransferMetrics transferMetrics;
+    TransferJournal transferJournal;
+    ChecksumManifest checksumManifest; // Filled while copying, saved after each transfer
     std::map<std::string, DirectoryTransfer> directoryTransferMap;
     std::map<std::string, DirectoryTransfer> duplicatesTransferMap;
     std::vector<DirectoryTransfer> photoTransfers;
@@ -0,0 +1,101 @@
+/***********************************************************************
+ * File Name: transfermetrics.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the TransferMetrics class. Progress counts
+ *              the full size of completed files plus the bytes already
+ *              written for files still in flight, so a single large file
+ *              advances the progress as it is copied.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <algorithm>
+#include "transfermetrics.h"
+
+void TransferMetrics::start(uint64_t totalBytes, uint64_t totalFiles) {
+    reset();
+    this->totalBytes = totalBytes;
+    this->totalFiles = totalFiles;
+    std::lock_guard<std::mutex> lock(rateMutex);
+    elapsedTimer.start();
+}
+
+void TransferMetrics::reset() {
+    totalBytes = 0;
+    totalFiles = 0;
+    bytesCopied = 0;
+    bytesCompleted = 0;
+    completedFilesBytesCopied = 0;
+    filesCompleted = 0;
+    filesFailed = 0;
+    std::lock_guard<std::mutex> lock(rateMutex);
+    rateSampleTime = 0;
+    rateSampleBytes = 0;
+    bytesPerSecond = 0;
+}
+
+void TransferMetrics::addToTotals(uint64_t bytes, uint64_t files) {
+    totalBytes += bytes;
+    totalFiles += files;
+}
+
+void TransferMetrics::addBytesCopied(uint64_t bytes) {
+    bytesCopied += bytes;
+}
+
+void TransferMetrics::fileCompleted(uint64_t fileSize, uint64_t fileBytesCopied) {
+    // Completed bytes are raised before the in-flight bytes are dropped, so
+    // a concurrent reader never sees the progress go backwards
+    bytesCompleted += fileSize;
+    completedFilesBytesCopied += fileBytesCopied;
+    ++filesCompleted;
+}
+
+void TransferMetrics::fileFailed() {
+    ++filesFailed;
+}
+
+uint64_t TransferMetrics::getBytesCompleted() const {
+    // Read in the reverse order of fileCompleted()'s updates
+    uint64_t copiedOfCompleted = completedFilesBytesCopied;
+    uint64_t completed = bytesCompleted;
+    uint64_t copied = bytesCopied;
+    uint64_t inFlight = copied > copiedOfCompleted ? copied - copiedOfCompleted : 0;
+    return std::min<uint64_t>(completed + inFlight, totalBytes);
+}
+
+int TransferMetrics::getProgressPercent() const {
+    uint64_t total = totalBytes;
+    if (total == 0) {
+        uint64_t files = totalFiles;
+        return files == 0 ? 0 : static_cast<int>((static_cast<double>(filesCompleted) / files) * 100);
+    }
+    return static_cast<int>((static_cast<double>(getBytesCompleted()) / total) * 100);
+}
+
+TransferMetricsSnapshot TransferMetrics::getSnapshot() {
+    TransferMetricsSnapshot snapshot;
+    snapshot.totalBytes = totalBytes;
+    snapshot.bytesCompleted = getBytesCompleted();
+    snapshot.totalFiles = totalFiles;
+    snapshot.filesCompleted = filesCompleted;
+    snapshot.filesFailed = filesFailed;
+
+    std::lock_guard<std::mutex> lock(rateMutex);
+    if (elapsedTimer.isValid()) {
+        // Rate over the last window, so it follows the current disk speed
+        // rather than the average since the start
+        qint64 now = elapsedTimer.elapsed();
+        uint64_t copied = bytesCopied;
+        if (now - rateSampleTime >= rateWindowMs) {
+            bytesPerSecond = static_cast<double>(copied - rateSampleBytes) * 1000.0 / (now - rateSampleTime);
+            rateSampleTime = now;
+            rateSampleBytes = copied;
+        }
+    }
+    snapshot.bytesPerSecond = bytesPerSecond;
+    if (bytesPerSecond > 0) {
+        snapshot.etaSeconds = static_cast<double>(snapshot.totalBytes - snapshot.bytesCompleted) / bytesPerSecond;
+    }
+    return snapshot;
+}
@@ -0,0 +1,77 @@
+#ifndef TRANSFERMETRICS_H
+#define TRANSFERMETRICS_H
+
+/***********************************************************************
+ * File Name: transfermetrics.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the TransferMetrics class, which tracks the
+ *              progress of a running transfer. The transfer threads update
+ *              atomic byte and file counters from inside the copy loop, and
+ *              the GUI polls a snapshot with the current throughput and an
+ *              estimated time remaining, so a slow disk can be told apart
+ *              from a stalled transfer.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <QElapsedTimer>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+
+// Values of the metrics at one point in time
+struct TransferMetricsSnapshot {
+    uint64_t totalBytes = 0;
+    uint64_t bytesCompleted = 0;   // Copied, moved or skipped
+    uint64_t totalFiles = 0;
+    uint64_t filesCompleted = 0;
+    uint64_t filesFailed = 0;      // Included in filesCompleted
+    double bytesPerSecond = 0;
+    double etaSeconds = -1;        // Negative while unknown
+};
+
+class TransferMetrics
+{
+public:
+    TransferMetrics() = default;
+
+    // Called before the transfer threads start
+    void start(uint64_t totalBytes, uint64_t totalFiles);
+    void reset();
+    // Grows the totals of a transfer whose files are not all known up front
+    void addToTotals(uint64_t bytes, uint64_t files);
+
+    // Called by the transfer threads. 'addBytesCopied' is called as data is
+    // written; 'fileCompleted' once per file with its full size (whether or
+    // not it was actually copied) and the bytes reported for it so far.
+    void addBytesCopied(uint64_t bytes);
+    void fileCompleted(uint64_t fileSize, uint64_t fileBytesCopied);
+    // Called (before fileCompleted) for files that could not be transferred
+    void fileFailed();
+
+    // Percentage of the bytes (or files, for empty files) completed
+    int getProgressPercent() const;
+    uint64_t getBytesCompleted() const;
+    // Throughput is averaged over at least 'rateWindowMs', so call this
+    // from a single polling thread
+    TransferMetricsSnapshot getSnapshot();
+
+    static constexpr qint64 rateWindowMs = 1000;
+
+private:
+    std::atomic<uint64_t> totalBytes{0};
+    std::atomic<uint64_t> totalFiles{0};
+    std::atomic<uint64_t> bytesCopied{0};     // Bytes actually written
+    std::atomic<uint64_t> bytesCompleted{0};  // Bytes of completed files
+    std::atomic<uint64_t> completedFilesBytesCopied{0}; // Part of bytesCopied from completed files
+    std::atomic<uint64_t> filesCompleted{0};
+    std::atomic<uint64_t> filesFailed{0};
+
+    std::mutex rateMutex;
+    QElapsedTimer elapsedTimer;
+    qint64 rateSampleTime = 0;
+    uint64_t rateSampleBytes = 0;
+    double bytesPerSecond = 0;
+};
+
+#endif // TRANSFERMETRICS_H
@@ -0,0 +1,340 @@
+/***********************************************************************
+ * File Name: transferscheduler.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the TransferScheduler class. Target
+ *              directories are created up front on the calling thread, then
+ *              every device pair queue is handed to its own QThreadPool and
+ *              all pools are drained concurrently.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <QStorageInfo>
+#include <QString>
+#include <iostream>
+#include "transferscheduler.h"
+
+TransferScheduler::TransferScheduler(std::atomic<bool>& cancelTransfer, std::atomic<int>& progressCounter,
+                                     TransferMetrics& transferMetrics)
+    : cancelTransfer(cancelTransfer), progressCounter(progressCounter), transferMetrics(transferMetrics) {
+}
+
+void TransferScheduler::setVerifyMoves(bool verify) {
+    verifyMoves = verify;
+}
+
+void TransferScheduler::setVerifyCopies(bool verify) {
+    verifyCopies = verify;
+}
+
+void TransferScheduler::setChecksumManifest(ChecksumManifest* manifest) {
+    checksumManifest = manifest;
+}
+
+void TransferScheduler::setJournal(TransferJournal* transferJournal) {
+    journal = transferJournal;
+}
+
+void TransferScheduler::addDirectoryTransfer(DirectoryTransfer& directoryTransfer) {
+    directoryStates.emplace_back();
+    directoryStates.back().directoryTransfer = &directoryTransfer;
+}
+
+void TransferScheduler::run(bool moveFiles, bool replaceDashesWithUnderscores, int transfersPerDevice) {
+    if (transfersPerDevice <= 0) {
+        transfersPerDevice = 1;
+    }
+
+    // Build one queue per source/target device pair
+    std::map<std::string, std::vector<TransferJob>> deviceQueues;
+    uint64_t totalBytes = 0;
+    uint64_t totalFiles = 0;
+    if (moveFiles) {
+        sourceRemover.start();
+    }
+    for (auto& directoryState : directoryStates) {
+        DirectoryTransfer& directoryTransfer = *directoryState.directoryTransfer;
+        applyTransferOptions(directoryTransfer, moveFiles);
+        try {
+            directoryTransfer.createDirectoryIfNotExists(directoryTransfer.getTargetDirectory());
+        } catch (const std::filesystem::filesystem_error& e) {
+            std::cerr << "Filesystem error: " << e.what() << std::endl; // Log error
+            directoryState.failed = true;
+        }
+        std::string targetDevice = getDeviceName(directoryTransfer.getTargetDirectory());
+
+        // Target path -> queue and index of the job transferring to it
+        std::unordered_map<std::string, std::pair<std::vector<TransferJob>*, size_t>> jobsByTargetPath;
+        for (auto& photoFile : directoryTransfer.getPhotoFileToTransfer()) {
+            std::string targetPath = directoryTransfer.getTargetPath(*photoFile, replaceDashesWithUnderscores).string();
+            auto job = jobsByTargetPath.find(targetPath);
+            if (job == jobsByTargetPath.end()) {
+                std::filesystem::path sourcePath(photoFile->getSourceFilePath());
+                std::vector<TransferJob>& queue = deviceQueues[getDeviceName(sourcePath.parent_path()) + " -> " + targetDevice];
+                queue.emplace_back();
+                queue.back().directoryState = &directoryState;
+                job = jobsByTargetPath.emplace(targetPath, std::make_pair(&queue, queue.size() - 1)).first;
+            }
+            (*job->second.first)[job->second.second].photoFiles.push_back(photoFile.get());
+            totalBytes += photoFile->getFileSize();
+            ++totalFiles;
+        }
+    }
+    transferMetrics.start(totalBytes, totalFiles);
+
+    // Every file is on disk in the journal before the first one starts
+    if (journal) {
+        std::vector<JournalEntry> entries;
+        entries.reserve(totalFiles);
+        for (auto& deviceQueue : deviceQueues) {
+            for (TransferJob& job : deviceQueue.second) {
+                for (PhotoFileHandler* photoFile : job.photoFiles) {
+                    entries.push_back(makeJournalEntry(*job.directoryState->directoryTransfer, *photoFile,
+                                                       replaceDashesWithUnderscores));
+                }
+            }
+        }
+        uint32_t journalId = journal->plan(entries);
+        for (auto& deviceQueue : deviceQueues) {
+            for (TransferJob& job : deviceQueue.second) {
+                for (size_t i = 0; i < job.photoFiles.size(); ++i) {
+                    job.journalIds.push_back(journalId == TransferJournal::NoId ? journalId : journalId++);
+                }
+            }
+        }
+    }
+
+    // The queues are not modified any more, so jobs can be referenced
+    std::vector<std::unique_ptr<QThreadPool>> devicePools;
+    for (auto& deviceQueue : deviceQueues) {
+        devicePools.push_back(std::make_unique<QThreadPool>());
+        QThreadPool& devicePool = *devicePools.back();
+        devicePool.setMaxThreadCount(transfersPerDevice);
+        for (TransferJob& job : deviceQueue.second) {
+            devicePool.start([this, &job, moveFiles, replaceDashesWithUnderscores]() {
+                runJob(job, moveFiles, replaceDashesWithUnderscores);
+            });
+        }
+    }
+    for (auto& devicePool : devicePools) {
+        devicePool->waitForDone();
+    }
+    if (moveFiles) {
+        finishMoves();
+    }
+}
+
+void TransferScheduler::runJob(TransferJob& job, bool moveFiles, bool replaceDashesWithUnderscores) {
+    DirectoryTransfer& directoryTransfer = *job.directoryState->directoryTransfer;
+    for (size_t i = 0; i < job.photoFiles.size(); ++i) {
+        PhotoFileHandler* photoFile = job.photoFiles[i];
+        uint64_t fileBytesCopied = 0;
+        // Like a serial transfer, a directory is abandoned after its first
+        // failed file
+        if (job.directoryState->failed) {
+            transferMetrics.fileFailed();
+        } else if (!cancelTransfer) {
+            auto onBytesCopied = [this, &fileBytesCopied](uint64_t bytesCopied) {
+                fileBytesCopied += bytesCopied;
+                transferMetrics.addBytesCopied(bytesCopied);
+                updateProgress();
+            };
+            bool skipped = false;
+            if (!directoryTransfer.transferFile(*photoFile, moveFiles, replaceDashesWithUnderscores, onBytesCopied,
+                                                &skipped)) {
+                job.directoryState->failed = true;
+                transferMetrics.fileFailed();
+            } else if (journal && i < job.journalIds.size()) {
+                journal->markCompleted(job.journalIds[i], skipped);
+            }
+        }
+        transferMetrics.fileCompleted(photoFile->getFileSize(), fileBytesCopied);
+        updateProgress();
+    }
+}
+
+JournalEntry TransferScheduler::makeJournalEntry(DirectoryTransfer& directoryTransfer, PhotoFileHandler& photoFile,
+                                                bool replaceDashesWithUnderscores) {
+    JournalEntry entry;
+    entry.sourcePath = photoFile.getSourceFilePath();
+    entry.targetPath = directoryTransfer.getTargetPath(photoFile, replaceDashesWithUnderscores).string();
+    entry.fileSize = photoFile.getFileSize();
+    entry.overwrite = photoFile.overwriteEnabled;
+    return entry;
+}
+
+void TransferScheduler::updateProgress() {
+    if (cancelTransfer) {
+        return;
+    }
+    int progress = transferMetrics.getProgressPercent();
+    if (streaming) {
+        // The total grows as files are submitted, so the percentage may drop
+        progressCounter = progress;
+        return;
+    }
+    // Files finish out of order, so only ever move the percentage forward
+    int current = progressCounter.load();
+    while (current < progress && !progressCounter.compare_exchange_weak(current, progress)) {
+    }
+}
+
+void TransferScheduler::beginStreaming(bool moveFiles, bool replaceDashesWithUnderscores, int transfersPerDevice) {
+    streaming = true;
+    streamMoveFiles = moveFiles;
+    streamReplaceDashesWithUnderscores = replaceDashesWithUnderscores;
+    streamTransfersPerDevice = transfersPerDevice > 0 ? transfersPerDevice : 1;
+    transferMetrics.start(0, 0);
+    if (moveFiles) {
+        sourceRemover.start();
+    }
+}
+
+void TransferScheduler::submitFile(DirectoryTransfer& directoryTransfer, PhotoFileHandler& photoFile) {
+    DirectoryState& directoryState = getStreamingDirectoryState(directoryTransfer);
+    std::filesystem::path sourcePath(photoFile.getSourceFilePath());
+    std::string deviceKey = getDeviceName(sourcePath.parent_path()) + " -> " +
+                            getDeviceName(directoryTransfer.getTargetDirectory());
+    std::unique_ptr<QThreadPool>& devicePool = devicePools[deviceKey];
+    if (!devicePool) {
+        devicePool = std::make_unique<QThreadPool>();
+        devicePool->setMaxThreadCount(streamTransfersPerDevice);
+    }
+
+    transferMetrics.addToTotals(photoFile.getFileSize(), 1);
+    auto job = std::make_shared<TransferJob>();
+    job->directoryState = &directoryState;
+    job->photoFiles.push_back(&photoFile);
+    std::string targetPath = directoryTransfer.getTargetPath(photoFile, streamReplaceDashesWithUnderscores).string();
+    if (journal) {
+        pendingSubmissions.push_back({devicePool.get(), job, targetPath,
+                                      makeJournalEntry(directoryTransfer, photoFile,
+                                                       streamReplaceDashesWithUnderscores)});
+        if (pendingSubmissions.size() >= journalBatchSize) {
+            flushSubmittedFiles();
+        }
+        return;
+    }
+    startStreamingJob(*devicePool, job, targetPath);
+}
+
+// The held files are planned with a single sync, before any of them starts
+void TransferScheduler::flushSubmittedFiles() {
+    if (pendingSubmissions.empty()) {
+        return;
+    }
+    std::vector<JournalEntry> entries;
+    entries.reserve(pendingSubmissions.size());
+    for (PendingSubmission& pending : pendingSubmissions) {
+        entries.push_back(std::move(pending.journalEntry));
+    }
+    uint32_t journalId = journal->plan(entries);
+    for (PendingSubmission& pending : pendingSubmissions) {
+        pending.job->journalIds.push_back(journalId == TransferJournal::NoId ? journalId : journalId++);
+        startStreamingJob(*pending.devicePool, std::move(pending.job), pending.targetPath);
+    }
+    pendingSubmissions.clear();
+}
+
+void TransferScheduler::startStreamingJob(QThreadPool& devicePool, std::shared_ptr<TransferJob> job,
+                                          const std::string& targetPath) {
+    devicePool.start([this, job, targetPath]() {
+        lockTargetPath(targetPath);
+        runJob(*job, streamMoveFiles, streamReplaceDashesWithUnderscores);
+        unlockTargetPath(targetPath);
+    });
+}
+
+void TransferScheduler::finishStreaming() {
+    flushSubmittedFiles();
+    for (auto& devicePool : devicePools) {
+        devicePool.second->waitForDone();
+    }
+    devicePools.clear();
+    if (streamMoveFiles) {
+        finishMoves();
+    }
+    streamingDirectoryStates.clear();
+    streaming = false;
+}
+
+TransferScheduler::DirectoryState& TransferScheduler::getStreamingDirectoryState(DirectoryTransfer& directoryTransfer) {
+    auto found = streamingDirectoryStates.find(&directoryTransfer);
+    if (found != streamingDirectoryStates.end()) {
+        return *found->second;
+    }
+    directoryStates.emplace_back();
+    DirectoryState& directoryState = directoryStates.back();
+    directoryState.directoryTransfer = &directoryTransfer;
+    applyTransferOptions(directoryTransfer, streamMoveFiles);
+    try {
+        directoryTransfer.createDirectoryIfNotExists(directoryTransfer.getTargetDirectory());
+    } catch (const std::filesystem::filesystem_error& e) {
+        std::cerr << "Filesystem error: " << e.what() << std::endl; // Log error
+        directoryState.failed = true;
+    }
+    streamingDirectoryStates.emplace(&directoryTransfer, &directoryState);
+    return directoryState;
+}
+
+void TransferScheduler::applyTransferOptions(DirectoryTransfer& directoryTransfer, bool moveFiles) {
+    TransferOptions options;
+    options.verifyMoves = verifyMoves;
+    options.verifyCopies = verifyCopies;
+    options.checksumManifest = checksumManifest;
+    if (moveFiles) {
+        options.sourceRemover = &sourceRemover;
+    }
+    directoryTransfer.setTransferOptions(options);
+}
+
+// Called once no transfer is running any more
+void TransferScheduler::finishMoves() {
+    sourceRemover.finish();
+    for (auto& directoryState : directoryStates) {
+        applyTransferOptions(*directoryState.directoryTransfer, false);
+    }
+    if (sourceRemover.getFilesFailed() > 0) {
+        std::cerr << sourceRemover.getFilesFailed() << " moved file(s) could not be removed from the source."
+                  << std::endl;
+    }
+}
+
+void TransferScheduler::lockTargetPath(const std::string& targetPath) {
+    std::unique_lock<std::mutex> lock(targetPathMutex);
+    targetPathReleased.wait(lock, [this, &targetPath]() { return targetPathsInFlight.count(targetPath) == 0; });
+    targetPathsInFlight.insert(targetPath);
+}
+
+void TransferScheduler::unlockTargetPath(const std::string& targetPath) {
+    {
+        std::lock_guard<std::mutex> lock(targetPathMutex);
+        targetPathsInFlight.erase(targetPath);
+    }
+    targetPathReleased.notify_all();
+}
+
+// Target directories and the source directories of a scan are few, so the
+// device of each is only looked up once
+std::string TransferScheduler::getDeviceName(const std::filesystem::path& directoryPath) {
+    std::string directory = directoryPath.string();
+    auto cached = deviceNames.find(directory);
+    if (cached != deviceNames.end()) {
+        return cached->second;
+    }
+
+    // Target directories may not exist yet - use the nearest existing parent
+    std::filesystem::path existingPath = directoryPath;
+    std::error_code ec;
+    while (!existingPath.empty() && !std::filesystem::exists(existingPath, ec) &&
+           existingPath != existingPath.parent_path()) {
+        existingPath = existingPath.parent_path();
+    }
+    QStorageInfo storageInfo(QString::fromStdString(existingPath.string()));
+    std::string deviceName = storageInfo.device().toStdString();
+    if (deviceName.empty()) {
+        deviceName = storageInfo.rootPath().toStdString();
+    }
+    deviceNames.emplace(directory, deviceName);
+    return deviceName;
+}
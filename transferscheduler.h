@@ -0,0 +1,137 @@
+#ifndef TRANSFERSCHEDULER_H
+#define TRANSFERSCHEDULER_H
+
+/***********************************************************************
+ * File Name: transferscheduler.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the TransferScheduler class, which runs the
+ *              file transfers of a set of DirectoryTransfers in parallel.
+ *              Files are queued by the storage device pair they are copied
+ *              between, and each queue has its own thread pool limited to a
+ *              configurable number of in-flight transfers, so two card
+ *              readers feeding one array are read concurrently without
+ *              thrashing any single device with too many streams. Files can
+ *              also be streamed in one at a time (for pipelined transfers),
+ *              in which case each starts as soon as it is submitted.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <QThreadPool>
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+#include "checksummanifest.h"
+#include "directorytransfer.h"
+#include "sourceremover.h"
+#include "transferjournal.h"
+#include "transfermetrics.h"
+
+class TransferScheduler
+{
+public:
+    // 'cancelTransfer' is polled before each file is started, 'progressCounter'
+    // receives the completed percentage and 'transferMetrics' the byte counts
+    TransferScheduler(std::atomic<bool>& cancelTransfer, std::atomic<int>& progressCounter,
+                      TransferMetrics& transferMetrics);
+
+    // Whether files moved between devices are compared with their source
+    // before the source is removed (default on). Set before run() or
+    // beginStreaming().
+    void setVerifyMoves(bool verify);
+    // Whether plain copies are compared with their source too (default off)
+    void setVerifyCopies(bool verify);
+    // Records the hash of every file copied in 'manifest', which must
+    // outlive the transfer. Saving it is left to the caller.
+    void setChecksumManifest(ChecksumManifest* manifest);
+    // Plans every file in 'journal' before transferring it and records its
+    // completion. The journal must be begun and outlive the transfer.
+    void setJournal(TransferJournal* journal);
+
+    // Queues every file of 'directoryTransfer'. The DirectoryTransfer must
+    // outlive run().
+    void addDirectoryTransfer(DirectoryTransfer& directoryTransfer);
+    // Transfers all queued files and blocks until they are done or canceled
+    void run(bool moveFiles, bool replaceDashesWithUnderscores, int transfersPerDevice);
+
+    // Streaming use: files handed to submitFile() between beginStreaming()
+    // and finishStreaming() start transferring right away. Both the
+    // DirectoryTransfer and the photo must outlive finishStreaming().
+    void beginStreaming(bool moveFiles, bool replaceDashesWithUnderscores, int transfersPerDevice);
+    void submitFile(DirectoryTransfer& directoryTransfer, PhotoFileHandler& photoFile);
+    // With a journal, submitted files are held back until they are planned,
+    // which is done journalBatchSize files at a time to save syncs. Call this
+    // when no more files are ready to submit, so the held files start.
+    void flushSubmittedFiles();
+    // Blocks until every submitted file is done or canceled
+    void finishStreaming();
+
+    static constexpr size_t journalBatchSize = 64;
+
+private:
+    struct DirectoryState {
+        DirectoryTransfer* directoryTransfer = nullptr;
+        std::atomic<bool> failed{false};
+    };
+    // Files with the same target path are transferred in order by a single
+    // job, so skip/overwrite behaves as it does for a serial transfer
+    struct TransferJob {
+        DirectoryState* directoryState = nullptr;
+        std::vector<PhotoFileHandler*> photoFiles;
+        std::vector<uint32_t> journalIds; // Parallel to photoFiles, if journaled
+    };
+    // A streamed file waiting for its plan record
+    struct PendingSubmission {
+        QThreadPool* devicePool = nullptr;
+        std::shared_ptr<TransferJob> job;
+        std::string targetPath;
+        JournalEntry journalEntry;
+    };
+
+    void runJob(TransferJob& job, bool moveFiles, bool replaceDashesWithUnderscores);
+    JournalEntry makeJournalEntry(DirectoryTransfer& directoryTransfer, PhotoFileHandler& photoFile,
+                                  bool replaceDashesWithUnderscores);
+    // Hands the verification and manifest settings to 'directoryTransfer'.
+    // Moves between devices leave removing their sources to 'sourceRemover'.
+    void applyTransferOptions(DirectoryTransfer& directoryTransfer, bool moveFiles);
+    void finishMoves();
+    void updateProgress();
+    DirectoryState& getStreamingDirectoryState(DirectoryTransfer& directoryTransfer);
+    void startStreamingJob(QThreadPool& devicePool, std::shared_ptr<TransferJob> job, const std::string& targetPath);
+    // Streamed files sharing a target path must not be transferred at once
+    void lockTargetPath(const std::string& targetPath);
+    void unlockTargetPath(const std::string& targetPath);
+    std::string getDeviceName(const std::filesystem::path& directoryPath);
+
+    std::atomic<bool>& cancelTransfer;
+    std::atomic<int>& progressCounter;
+    TransferMetrics& transferMetrics;
+    std::deque<DirectoryState> directoryStates;
+    std::unordered_map<std::string, std::string> deviceNames; // Directory -> device
+    bool verifyMoves = true;
+    bool verifyCopies = false;
+    ChecksumManifest* checksumManifest = nullptr;
+    TransferJournal* journal = nullptr;
+    SourceRemover sourceRemover;
+
+    // Streaming state
+    bool streaming = false;
+    bool streamMoveFiles = false;
+    bool streamReplaceDashesWithUnderscores = false;
+    int streamTransfersPerDevice = 1;
+    std::map<std::string, std::unique_ptr<QThreadPool>> devicePools;
+    std::unordered_map<DirectoryTransfer*, DirectoryState*> streamingDirectoryStates;
+    std::mutex targetPathMutex;
+    std::condition_variable targetPathReleased;
+    std::unordered_set<std::string> targetPathsInFlight;
+    std::vector<PendingSubmission> pendingSubmissions;
+};
+
+#endif // TRANSFERSCHEDULER_H
@@ -2,19 +2,22 @@
  * File Name: videofilehandler.cpp
  * Author(s): Blake Azuela
  * Date Created: 2024-05-06
- * Description: Implementation of the VideoFileHandler class, which might
- *              handle video files by processing specific metadata related
- *              to videos. Currently serves as a stub with potential for
- *              future development.
+ * Description: Implementation of the VideoFileHandler class. Reads the
+ *              recording date and camera model from the container metadata
+ *              and stores them in the fields a photo keeps its EXIF
+ *              creation date and camera model in.
  * License: MIT License
  ***********************************************************************/
 
 
 #include <iostream>
 #include "videofilehandler.h"
+#include "exifsegmentreader.h"
+#include "videometadatareader.h"
 
 VideoFileHandler::VideoFileHandler(const std::string inputFilePath)
-    : BasicFileHandler(inputFilePath) {
+    : PhotoFileHandler(inputFilePath) {
+    exifDataLoaded = true; // Videos have no EXIF block to load
 }
 
 VideoFileHandler::~VideoFileHandler() {
@@ -22,4 +25,16 @@ VideoFileHandler::~VideoFileHandler() {
 
 void VideoFileHandler::processFile(){
     std::cout << "Processing a video file: " << this->filePath << std::endl;
+    setTargetFileName();
+
+    VideoMetadata metadata;
+    int code = VideoMetadataReader::readFromFile(filePath, metadata);
+    if (code == PARSE_EXIF_ERROR_FILE_ACCESS) {
+        std::cerr << "Can't open file.\n";
+        fileValid = false;
+        return;
+    }
+    fileValid = true;
+    setEXIFFields(code, metadata.fingerprint(), metadata.dateTimeOriginal, metadata.offsetTimeOriginal,
+                  metadata.make, metadata.model, std::string_view());
 }
@@ -6,16 +6,17 @@
  * Author(s): Blake Azuela
  * Date Created: 2024-05-06
  * Description: Header file for the VideoFileHandler class, which extends
- *              BasicFileHandler. Intended for processing video files if
- *              developed, following similar processing patterns to other
- *              file handlers.
+ *              PhotoFileHandler. Videos carry a recording date and camera
+ *              model in their container metadata instead of EXIF; once
+ *              read, they are sorted, de-duplicated and transferred exactly
+ *              like photos.
  * License: MIT License
  ***********************************************************************/
 
 #include <string>
-#include "basicfilehandler.h"
+#include "photofilehandler.h"
 
-class VideoFileHandler : public BasicFileHandler {
+class VideoFileHandler : public PhotoFileHandler {
 protected:
 
 public:
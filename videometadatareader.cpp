@@ -0,0 +1,254 @@
+/***********************************************************************
+ * File Name: videometadatareader.cpp
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Implementation of the VideoMetadataReader class. The date
+ *              comes from, in order of preference, the QuickTime
+ *              'com.apple.quicktime.creationdate' key or the '(c)day' user
+ *              data atom (both local time), or the 'mvhd' creation time
+ *              (UTC, converted to local time). Make and model come from the
+ *              QuickTime metadata keys or the '(c)mak'/'(c)mod' user data
+ *              atoms.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <algorithm>
+#include <cctype>
+#include <climits>
+#include <cstring>
+#include <ctime>
+#include <vector>
+#include "videometadatareader.h"
+#include "contenthasher.h"
+#include "exif.h"
+#include "exifsegmentreader.h"
+#include "isobmffbox.h"
+#include "positionedfile.h"
+
+namespace {
+
+constexpr uint64_t SecondsFrom1904To1970 = 2082844800ULL;
+constexpr uint32_t MaxStringSize = 1024;
+constexpr uint32_t MaxKeyCount = 1024;
+
+// QuickTime user data atom types start with the (c) sign
+const char AtomDay[4] = {'\xA9', 'd', 'a', 'y'};
+const char AtomMake[4] = {'\xA9', 'm', 'a', 'k'};
+const char AtomModel[4] = {'\xA9', 'm', 'o', 'd'};
+
+bool readString(PositionedFile& file, uint64_t offset, uint64_t size, std::string& value) {
+    if (size > MaxStringSize) return false;
+    value.resize(static_cast<size_t>(size));
+    if (size > 0 && !file.read(offset, reinterpret_cast<uint8_t*>(&value[0]), value.size())) {
+        value.clear();
+        return false;
+    }
+    // Some writers pad with NULs
+    value.resize(std::strlen(value.c_str()));
+    return true;
+}
+
+// "YYYY-MM-DDTHH:MM:SS[.fff][zone]" (ISO 8601, as used by QuickTime) to the
+// EXIF form. The local time is kept as the date and the zone, if any, as its
+// offset.
+void setISODate(const std::string& isoDate, VideoMetadata& metadata) {
+    if (!metadata.dateTimeOriginal.empty() || isoDate.size() < 19 || isoDate[4] != '-' || isoDate[7] != '-' ||
+        (isoDate[10] != 'T' && isoDate[10] != ' ') || isoDate[13] != ':' || isoDate[16] != ':') {
+        return;
+    }
+    std::string exifDate = isoDate.substr(0, 19);
+    exifDate[4] = ':';
+    exifDate[7] = ':';
+    exifDate[10] = ' ';
+    size_t zone = 19;
+    if (zone < isoDate.size() && isoDate[zone] == '.') {
+        zone = isoDate.find_first_not_of("0123456789", zone + 1);
+    }
+    metadata.dateTimeOriginal = exifDate;
+    metadata.offsetTimeOriginal = zone < isoDate.size() ? isoDate.substr(zone) : std::string();
+}
+
+std::string mvhdTimeToEXIF(uint64_t creationTime) {
+    if (creationTime <= SecondsFrom1904To1970) {
+        return std::string(); // Unset (0) or before 1970
+    }
+    std::time_t time = static_cast<std::time_t>(creationTime - SecondsFrom1904To1970);
+    std::tm dateTime = {};
+#if defined(_WIN32) || defined(_WIN64)
+    if (localtime_s(&dateTime, &time) != 0) return std::string();
+#else
+    if (!localtime_r(&time, &dateTime)) return std::string();
+#endif
+    char text[32];
+    if (std::strftime(text, sizeof(text), "%Y:%m:%d %H:%M:%S", &dateTime) == 0) return std::string();
+    return std::string(text);
+}
+
+// 'mvhd': version/flags, then the creation and modification times,
+// timescale and duration (64-bit times in version 1)
+bool readMovieHeader(PositionedFile& file, const ISOBMFFBox& mvhd, VideoMetadata& metadata) {
+    uint8_t version;
+    if (!file.read(mvhd.contentStart, &version, 1)) return false;
+    unsigned timeSize = version == 1 ? 8 : 4;
+    uint64_t offset = mvhd.contentStart + 4;
+    uint64_t modificationTime, timescale;
+    if (offset + 3 * timeSize + 4 > mvhd.contentEnd ||
+        !ISOBMFFBox::readBigEndian(file, offset, timeSize, metadata.creationTime) ||
+        !ISOBMFFBox::readBigEndian(file, offset, timeSize, modificationTime) ||
+        !ISOBMFFBox::readBigEndian(file, offset, 4, timescale) ||
+        !ISOBMFFBox::readBigEndian(file, offset, timeSize, metadata.duration)) {
+        return false;
+    }
+    metadata.timescale = static_cast<uint32_t>(timescale);
+    return true;
+}
+
+// QuickTime user data text: a 16-bit length and language, then the text
+bool readUserDataText(PositionedFile& file, const ISOBMFFBox& atom, std::string& value) {
+    uint64_t offset = atom.contentStart;
+    uint64_t length, language;
+    if (!ISOBMFFBox::readBigEndian(file, offset, 2, length) ||
+        !ISOBMFFBox::readBigEndian(file, offset, 2, language) ||
+        length > atom.contentEnd - offset) {
+        return false;
+    }
+    return readString(file, offset, length, value);
+}
+
+// The value of a metadata item is in its 'data' atom, after the type and
+// locale. Only text values (UTF-8, type 1) are of interest.
+bool readItemText(PositionedFile& file, const ISOBMFFBox& item, std::string& value) {
+    ISOBMFFBox data;
+    uint8_t typeAndLocale[8];
+    if (!ISOBMFFBox::find(file, item.contentStart, item.contentEnd, "data", data) ||
+        data.contentEnd - data.contentStart < sizeof(typeAndLocale) ||
+        !file.read(data.contentStart, typeAndLocale, sizeof(typeAndLocale)) ||
+        ISOBMFFBox::getBigEndian(typeAndLocale, 4) != 1) {
+        return false;
+    }
+    uint64_t textStart = data.contentStart + sizeof(typeAndLocale);
+    return readString(file, textStart, data.contentEnd - textStart, value);
+}
+
+void setField(const std::string& value, std::string& field) {
+    if (field.empty() && !value.empty()) {
+        field = value;
+    }
+}
+
+// 'udta': the (c)day/(c)mak/(c)mod text atoms
+void readUserData(PositionedFile& file, const ISOBMFFBox& udta, VideoMetadata& metadata) {
+    ISOBMFFBox atom;
+    uint64_t offset = udta.contentStart;
+    for (unsigned i = 0; i < ISOBMFFBox::maxBoxesPerLevel && atom.readHeader(file, offset, udta.contentEnd); ++i) {
+        offset = atom.contentEnd;
+        std::string value;
+        if (atom.isType(AtomDay) && readUserDataText(file, atom, value)) {
+            setISODate(value, metadata);
+        } else if (atom.isType(AtomMake) && readUserDataText(file, atom, value)) {
+            setField(value, metadata.make);
+        } else if (atom.isType(AtomModel) && readUserDataText(file, atom, value)) {
+            setField(value, metadata.model);
+        }
+    }
+}
+
+// 'meta' (QuickTime metadata): 'keys' names the entries, and each 'ilst'
+// item is typed by its 1-based key index
+void readMetadata(PositionedFile& file, const ISOBMFFBox& meta, VideoMetadata& metadata) {
+    // QuickTime writes 'meta' as a plain atom, MP4 as a full box
+    uint64_t start = meta.contentStart;
+    uint8_t firstChild[8];
+    if (file.read(start, firstChild, sizeof(firstChild)) && std::memcmp(firstChild + 4, "hdlr", 4) != 0) {
+        start += 4;
+    }
+    ISOBMFFBox keys, ilst;
+    if (!ISOBMFFBox::find(file, start, meta.contentEnd, "keys", keys) ||
+        !ISOBMFFBox::find(file, start, meta.contentEnd, "ilst", ilst)) {
+        return;
+    }
+    std::vector<std::string> keyNames;
+    uint64_t offset = keys.contentStart + 4, keyCount;
+    if (!ISOBMFFBox::readBigEndian(file, offset, 4, keyCount) || keyCount > MaxKeyCount) {
+        return;
+    }
+    for (uint64_t i = 0; i < keyCount; ++i) {
+        uint64_t keySize, keyNamespace;
+        std::string keyName;
+        if (!ISOBMFFBox::readBigEndian(file, offset, 4, keySize) || keySize < 8 ||
+            keySize - 4 > keys.contentEnd - offset ||
+            !ISOBMFFBox::readBigEndian(file, offset, 4, keyNamespace)) {
+            return;
+        }
+        readString(file, offset, keySize - 8, keyName);
+        keyNames.push_back(keyName);
+        offset += keySize - 8;
+    }
+
+    ISOBMFFBox item;
+    offset = ilst.contentStart;
+    for (unsigned i = 0; i < ISOBMFFBox::maxBoxesPerLevel && item.readHeader(file, offset, ilst.contentEnd); ++i) {
+        offset = item.contentEnd;
+        uint32_t keyIndex = ISOBMFFBox::getBigEndian(reinterpret_cast<const uint8_t*>(item.type), 4);
+        std::string value;
+        if (keyIndex == 0 || keyIndex > keyNames.size() || !readItemText(file, item, value)) {
+            continue;
+        }
+        const std::string& keyName = keyNames[keyIndex - 1];
+        if (keyName == "com.apple.quicktime.creationdate") {
+            setISODate(value, metadata);
+        } else if (keyName == "com.apple.quicktime.make") {
+            setField(value, metadata.make);
+        } else if (keyName == "com.apple.quicktime.model") {
+            setField(value, metadata.model);
+        }
+    }
+}
+
+}
+
+uint64_t VideoMetadata::fingerprint() const {
+    ContentHasher hasher;
+    hasher.update(dateTimeOriginal.data(), dateTimeOriginal.size() + 1);
+    hasher.update(make.data(), make.size() + 1);
+    hasher.update(model.data(), model.size() + 1);
+    hasher.update(&creationTime, sizeof(creationTime));
+    hasher.update(&duration, sizeof(duration));
+    hasher.update(&timescale, sizeof(timescale));
+    return hasher.digest();
+}
+
+int VideoMetadataReader::readFromFile(const std::string& filePath, VideoMetadata& metadata) {
+    metadata = VideoMetadata();
+    PositionedFile file(filePath);
+    if (!file.isOpen()) {
+        return PARSE_EXIF_ERROR_FILE_ACCESS;
+    }
+
+    // Top level: ftyp, (wide, free, ...) mdat and moov in either order. The
+    // first atom type has to be printable, which rules out other formats.
+    ISOBMFFBox atom, moov;
+    if (!atom.readHeader(file, 0, UINT64_MAX) ||
+        !std::all_of(atom.type, atom.type + 4, [](char c) { return std::isprint(static_cast<unsigned char>(c)); })) {
+        return PARSE_EXIF_ERROR_NO_EXIF;
+    }
+    if (!ISOBMFFBox::find(file, 0, UINT64_MAX, "moov", moov)) {
+        return PARSE_EXIF_ERROR_NO_EXIF;
+    }
+
+    ISOBMFFBox mvhd, udta, meta;
+    if (ISOBMFFBox::find(file, moov.contentStart, moov.contentEnd, "mvhd", mvhd)) {
+        readMovieHeader(file, mvhd, metadata);
+    }
+    if (ISOBMFFBox::find(file, moov.contentStart, moov.contentEnd, "meta", meta)) {
+        readMetadata(file, meta, metadata);
+    }
+    if (ISOBMFFBox::find(file, moov.contentStart, moov.contentEnd, "udta", udta)) {
+        readUserData(file, udta, metadata);
+        if (ISOBMFFBox::find(file, udta.contentStart, udta.contentEnd, "meta", meta)) {
+            readMetadata(file, meta, metadata);
+        }
+    }
+    setField(mvhdTimeToEXIF(metadata.creationTime), metadata.dateTimeOriginal);
+    return PARSE_EXIF_SUCCESS;
+}
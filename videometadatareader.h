@@ -0,0 +1,52 @@
+#ifndef VIDEOMETADATAREADER_H
+#define VIDEOMETADATAREADER_H
+
+/***********************************************************************
+ * File Name: videometadatareader.h
+ * Author(s): Blake Azuela
+ * Date Created: 2026-10-16
+ * Description: Header file for the VideoMetadataReader class, which reads
+ *              the recording date and camera make/model of MP4, MOV, 3GP and
+ *              M4V files. These are all ISOBMFF/QuickTime files: the
+ *              metadata lives in the 'moov' atom, which cameras often write
+ *              after the media data, at the end of a multi-gigabyte file.
+ *              The reader walks the top level atom headers and seeks over
+ *              'mdat', so only the 'moov' metadata atoms are read.
+ * License: MIT License
+ ***********************************************************************/
+
+#include <cstdint>
+#include <string>
+
+struct VideoMetadata {
+    // Local recording time as "YYYY:MM:DD HH:MM:SS" (the EXIF format), empty
+    // if the file has none
+    std::string dateTimeOriginal;
+    // Zone offset written with the date ("+02:00", "+0200" or "Z"), empty
+    // if unknown
+    std::string offsetTimeOriginal;
+    std::string make;
+    std::string model;
+    uint64_t creationTime = 0; // 'mvhd' creation time, seconds since 1904 (UTC)
+    uint64_t duration = 0;     // In 'timescale' units
+    uint32_t timescale = 0;
+
+    // Hash of the fields above (except the offset, which only restates the
+    // date) - recordings can only be duplicates when
+    // their fingerprints match
+    uint64_t fingerprint() const;
+};
+
+class VideoMetadataReader
+{
+public:
+    // Returns PARSE_EXIF_SUCCESS when a 'moov' atom was read,
+    // PARSE_EXIF_ERROR_NO_EXIF when the file has none (or is not an ISOBMFF
+    // file) and PARSE_EXIF_ERROR_FILE_ACCESS when it cannot be opened
+    static int readFromFile(const std::string& filePath, VideoMetadata& metadata);
+
+private:
+    VideoMetadataReader() = delete;
+};
+
+#endif // VIDEOMETADATAREADER_H